@@ -0,0 +1,591 @@
+/**
+ * @file sort.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{sort}
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../memory/arena.h"
+
+namespace moon {
+	template<class T>
+	struct less;
+	template<class T>
+	struct greater;
+}
+
+namespace Somn {
+
+	namespace detail {
+		/**
+		 * @brief Comparators known to be a plain < or > on the element type,
+		 *        for which the branchless partition and sorting networks are used.
+		 */
+		template<class Compare>
+		struct is_plain_compare : std::false_type {};
+
+		template<class T>
+		struct is_plain_compare<std::less<T>> : std::true_type {};
+
+		template<class T>
+		struct is_plain_compare<std::greater<T>> : std::true_type {};
+
+		template<class T>
+		struct is_plain_compare<moon::less<T>> : std::true_type {};
+
+		template<class T>
+		struct is_plain_compare<moon::greater<T>> : std::true_type {};
+
+		template<class Iter, class Compare>
+		struct use_branchless : std::integral_constant<bool,
+			std::is_arithmetic<typename std::iterator_traits<Iter>::value_type>::value && is_plain_compare<Compare>::value> {};
+
+		namespace sorting {
+			constexpr ptrdiff_t insertion_sort_threshold = 24;
+			constexpr ptrdiff_t ninther_threshold = 128;
+			constexpr ptrdiff_t partial_insertion_sort_limit = 8;
+			constexpr size_t block_size = 64;
+			constexpr size_t cacheline_size = 64;
+			constexpr size_t network_max = 16;
+
+			/**
+			 * @brief Comparators of Batcher's odd-even merge sort for 16 inputs, with those
+			 *        touching an index >= n dropped, which leaves a network for n inputs.
+			 */
+			struct network {
+				unsigned char _pairs[64][2];
+				size_t _count;
+			};
+
+			constexpr network make_network(size_t n) {
+				network result{};
+				for (size_t p = 1; p < network_max; p <<= 1) {
+					for (size_t k = p; k >= 1; k >>= 1) {
+						for (size_t j = k % p; j + k < network_max; j += 2 * k) {
+							for (size_t i = 0; i < k && i + j + k < network_max; i++) {
+								if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && i + j + k < n) {
+									result._pairs[result._count][0] = static_cast<unsigned char>(i + j);
+									result._pairs[result._count][1] = static_cast<unsigned char>(i + j + k);
+									result._count++;
+								}
+							}
+						}
+					}
+				}
+				return result;
+			}
+
+			template<size_t... N>
+			struct network_table {
+				static constexpr network networks[] = {make_network(N)...};
+			};
+
+			typedef network_table<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16> networks;
+
+			// Put the smaller of a and b first without a branch; compiles to cmov for arithmetic types
+			template<class T, class Compare>
+			inline void compare_exchange(T& a, T& b, Compare& comp) {
+				T x = a, y = b;
+				bool swap = comp(y, x);
+				a = swap ? y : x;
+				b = swap ? x : y;
+			}
+
+			template<class Iter, class Compare>
+			void network_sort(Iter begin, size_t n, Compare& comp) {
+				const network& net = networks::networks[n];
+				for (size_t index = 0; index < net._count; index++) {
+					compare_exchange(begin[net._pairs[index][0]], begin[net._pairs[index][1]], comp);
+				}
+			}
+
+			template<class Iter, class Compare>
+			void insertion_sort(Iter begin, Iter end, Compare& comp) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				if (begin == end) {
+					return;
+				}
+				for (Iter cur = begin + 1; cur != end; ++cur) {
+					Iter sift = cur;
+					Iter sift_1 = cur - 1;
+					if (comp(*sift, *sift_1)) {
+						T tmp = std::move(*sift);
+						do {
+							*sift-- = std::move(*sift_1);
+						} while (sift != begin && comp(tmp, *--sift_1));
+						*sift = std::move(tmp);
+					}
+				}
+			}
+
+			// Insertion sort for a range with an element before begin that is not greater than any in it
+			template<class Iter, class Compare>
+			void unguarded_insertion_sort(Iter begin, Iter end, Compare& comp) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				if (begin == end) {
+					return;
+				}
+				for (Iter cur = begin + 1; cur != end; ++cur) {
+					Iter sift = cur;
+					Iter sift_1 = cur - 1;
+					if (comp(*sift, *sift_1)) {
+						T tmp = std::move(*sift);
+						do {
+							*sift-- = std::move(*sift_1);
+						} while (comp(tmp, *--sift_1));
+						*sift = std::move(tmp);
+					}
+				}
+			}
+
+			// Insertion sort that gives up after moving partial_insertion_sort_limit elements
+			template<class Iter, class Compare>
+			bool partial_insertion_sort(Iter begin, Iter end, Compare& comp) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				if (begin == end) {
+					return true;
+				}
+				ptrdiff_t moved = 0;
+				for (Iter cur = begin + 1; cur != end; ++cur) {
+					Iter sift = cur;
+					Iter sift_1 = cur - 1;
+					if (comp(*sift, *sift_1)) {
+						T tmp = std::move(*sift);
+						do {
+							*sift-- = std::move(*sift_1);
+						} while (sift != begin && comp(tmp, *--sift_1));
+						*sift = std::move(tmp);
+						moved += cur - sift;
+					}
+					if (moved > partial_insertion_sort_limit) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			template<class Iter, class Compare>
+			inline void sort2(Iter a, Iter b, Compare& comp) {
+				if (comp(*b, *a)) {
+					std::iter_swap(a, b);
+				}
+			}
+
+			template<class Iter, class Compare>
+			inline void sort3(Iter a, Iter b, Iter c, Compare& comp) {
+				sort2(a, b, comp);
+				sort2(b, c, comp);
+				sort2(a, b, comp);
+			}
+
+			template<class T>
+			inline T* align_cacheline(T* p) {
+				uintptr_t value = reinterpret_cast<uintptr_t>(p);
+				return reinterpret_cast<T*>((value + cacheline_size - 1) & ~uintptr_t(cacheline_size - 1));
+			}
+
+			template<class Iter>
+			inline void swap_offsets(Iter first, Iter last, unsigned char* offsets_l, unsigned char* offsets_r,
+			                         size_t num, bool use_swaps) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				if (use_swaps) {
+					// Needed when the two blocks hold equally many elements, or the cycle below would break
+					for (size_t index = 0; index < num; index++) {
+						std::iter_swap(first + offsets_l[index], last - offsets_r[index]);
+					}
+				}
+				else if (num > 0) {
+					// One cyclic permutation instead of num swaps
+					Iter l = first + offsets_l[0];
+					Iter r = last - offsets_r[0];
+					T tmp(std::move(*l));
+					*l = std::move(*r);
+					for (size_t index = 1; index < num; index++) {
+						l = first + offsets_l[index];
+						*r = std::move(*l);
+						r = last - offsets_r[index];
+						*l = std::move(*r);
+					}
+					*r = std::move(tmp);
+				}
+			}
+
+			/**
+			 * @brief Partition around *begin with elements equal to the pivot going right.
+			 *
+			 * Comparisons are done for a whole block first, recording the
+			 * offsets of misplaced elements without branching on the results,
+			 * then the misplaced elements are swapped pairwise. This removes the
+			 * branch mispredictions that dominate partitioning random numbers.
+			 * @return The pivot's final position and whether the range was already partitioned.
+			 */
+			template<class Iter, class Compare>
+			std::pair<Iter, bool> partition_right_branchless(Iter begin, Iter end, Compare& comp) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				T pivot(std::move(*begin));
+				Iter first = begin;
+				Iter last = end;
+
+				// Find the first element not less than the pivot, and the last one less than it
+				while (comp(*++first, pivot)) {}
+				if (first - 1 == begin) {
+					while (first < last && !comp(*--last, pivot)) {}
+				}
+				else {
+					while (!comp(*--last, pivot)) {}
+				}
+
+				bool already_partitioned = first >= last;
+				if (!already_partitioned) {
+					std::iter_swap(first, last);
+					++first;
+
+					unsigned char offsets_l_storage[block_size + cacheline_size];
+					unsigned char offsets_r_storage[block_size + cacheline_size];
+					unsigned char* offsets_l = align_cacheline(offsets_l_storage);
+					unsigned char* offsets_r = align_cacheline(offsets_r_storage);
+					Iter offsets_l_base = first;
+					Iter offsets_r_base = last;
+					size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+					while (first < last) {
+						// Fill the offset blocks that are empty; split the rest of the range when both are
+						size_t num_unknown = last - first;
+						size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+						size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+						if (left_split >= block_size) {
+							for (size_t index = 0; index < block_size;) {
+								offsets_l[num_l] = static_cast<unsigned char>(index++); num_l += !comp(*first, pivot); ++first;
+								offsets_l[num_l] = static_cast<unsigned char>(index++); num_l += !comp(*first, pivot); ++first;
+								offsets_l[num_l] = static_cast<unsigned char>(index++); num_l += !comp(*first, pivot); ++first;
+								offsets_l[num_l] = static_cast<unsigned char>(index++); num_l += !comp(*first, pivot); ++first;
+							}
+						}
+						else {
+							for (size_t index = 0; index < left_split;) {
+								offsets_l[num_l] = static_cast<unsigned char>(index++); num_l += !comp(*first, pivot); ++first;
+							}
+						}
+
+						if (right_split >= block_size) {
+							for (size_t index = 0; index < block_size;) {
+								offsets_r[num_r] = static_cast<unsigned char>(++index); num_r += comp(*--last, pivot);
+								offsets_r[num_r] = static_cast<unsigned char>(++index); num_r += comp(*--last, pivot);
+								offsets_r[num_r] = static_cast<unsigned char>(++index); num_r += comp(*--last, pivot);
+								offsets_r[num_r] = static_cast<unsigned char>(++index); num_r += comp(*--last, pivot);
+							}
+						}
+						else {
+							for (size_t index = 0; index < right_split;) {
+								offsets_r[num_r] = static_cast<unsigned char>(++index); num_r += comp(*--last, pivot);
+							}
+						}
+
+						size_t num = num_l < num_r ? num_l : num_r;
+						swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+						num_l -= num;
+						num_r -= num;
+						start_l += num;
+						start_r += num;
+						if (num_l == 0) {
+							start_l = 0;
+							offsets_l_base = first;
+						}
+						if (num_r == 0) {
+							start_r = 0;
+							offsets_r_base = last;
+						}
+					}
+
+					// One block may still hold misplaced elements; move them to the boundary
+					if (num_l) {
+						offsets_l += start_l;
+						while (num_l--) {
+							std::iter_swap(offsets_l_base + offsets_l[num_l], --last);
+						}
+						first = last;
+					}
+					if (num_r) {
+						offsets_r += start_r;
+						while (num_r--) {
+							std::iter_swap(offsets_r_base - offsets_r[num_r], first);
+							++first;
+						}
+						last = first;
+					}
+				}
+
+				Iter pivot_pos = first - 1;
+				*begin = std::move(*pivot_pos);
+				*pivot_pos = std::move(pivot);
+				return {pivot_pos, already_partitioned};
+			}
+
+			/**
+			 * @brief Partition around *begin with elements equal to the pivot going right (branching version).
+			 */
+			template<class Iter, class Compare>
+			std::pair<Iter, bool> partition_right(Iter begin, Iter end, Compare& comp) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				T pivot(std::move(*begin));
+				Iter first = begin;
+				Iter last = end;
+
+				while (comp(*++first, pivot)) {}
+				if (first - 1 == begin) {
+					while (first < last && !comp(*--last, pivot)) {}
+				}
+				else {
+					while (!comp(*--last, pivot)) {}
+				}
+
+				bool already_partitioned = first >= last;
+				while (first < last) {
+					std::iter_swap(first, last);
+					while (comp(*++first, pivot)) {}
+					while (!comp(*--last, pivot)) {}
+				}
+
+				Iter pivot_pos = first - 1;
+				*begin = std::move(*pivot_pos);
+				*pivot_pos = std::move(pivot);
+				return {pivot_pos, already_partitioned};
+			}
+
+			/**
+			 * @brief Partition around *begin with elements equal to the pivot going left.
+			 *
+			 * Used when the pivot equals the element before the range: everything
+			 * equal to it then ends up in place in one step, which makes inputs
+			 * with many duplicates linear.
+			 */
+			template<class Iter, class Compare>
+			Iter partition_left(Iter begin, Iter end, Compare& comp) {
+				typedef typename std::iterator_traits<Iter>::value_type T;
+				T pivot(std::move(*begin));
+				Iter first = begin;
+				Iter last = end;
+
+				while (comp(pivot, *--last)) {}
+				if (last + 1 == end) {
+					while (first < last && !comp(pivot, *++first)) {}
+				}
+				else {
+					while (!comp(pivot, *++first)) {}
+				}
+
+				while (first < last) {
+					std::iter_swap(first, last);
+					while (comp(pivot, *--last)) {}
+					while (!comp(pivot, *++first)) {}
+				}
+
+				Iter pivot_pos = last;
+				*begin = std::move(*pivot_pos);
+				*pivot_pos = std::move(pivot);
+				return pivot_pos;
+			}
+
+			template<bool Branchless, class Iter, class Compare>
+			void pdqsort_loop(Iter begin, Iter end, Compare& comp, int bad_allowed, bool leftmost = true) {
+				while (true) {
+					ptrdiff_t size = end - begin;
+
+					if (Branchless && size <= static_cast<ptrdiff_t>(network_max)) {
+						network_sort(begin, size, comp);
+						return;
+					}
+					if (size < insertion_sort_threshold) {
+						if (leftmost) {
+							insertion_sort(begin, end, comp);
+						}
+						else {
+							unguarded_insertion_sort(begin, end, comp);
+						}
+						return;
+					}
+
+					// Pivot: median of 3, or pseudo-median of 9 for large ranges, moved to *begin
+					ptrdiff_t s2 = size / 2;
+					if (size > ninther_threshold) {
+						sort3(begin, begin + s2, end - 1, comp);
+						sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+						sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+						sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+						std::iter_swap(begin, begin + s2);
+					}
+					else {
+						sort3(begin + s2, begin, end - 1, comp);
+					}
+
+					// The pivot equals the element before the range: all equal elements go left at once
+					if (!leftmost && !comp(*(begin - 1), *begin)) {
+						begin = partition_left(begin, end, comp) + 1;
+						continue;
+					}
+
+					std::pair<Iter, bool> part = Branchless ? partition_right_branchless(begin, end, comp)
+					                                        : partition_right(begin, end, comp);
+					Iter pivot_pos = part.first;
+					bool already_partitioned = part.second;
+
+					ptrdiff_t l_size = pivot_pos - begin;
+					ptrdiff_t r_size = end - (pivot_pos + 1);
+					bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+					if (highly_unbalanced) {
+						// Too many bad pivots: fall back to heapsort for an O(n log n) bound
+						if (--bad_allowed == 0) {
+							std::make_heap(begin, end, comp);
+							std::sort_heap(begin, end, comp);
+							return;
+						}
+						// Otherwise shuffle a few elements to break the pattern
+						if (l_size >= insertion_sort_threshold) {
+							std::iter_swap(begin, begin + l_size / 4);
+							std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+							if (l_size > ninther_threshold) {
+								std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+								std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+								std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+								std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+							}
+						}
+						if (r_size >= insertion_sort_threshold) {
+							std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+							std::iter_swap(end - 1, end - r_size / 4);
+							if (r_size > ninther_threshold) {
+								std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+								std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+								std::iter_swap(end - 2, end - (1 + r_size / 4));
+								std::iter_swap(end - 3, end - (2 + r_size / 4));
+							}
+						}
+					}
+					else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp)
+					         && partial_insertion_sort(pivot_pos + 1, end, comp)) {
+						// A partitioned range that insertion sort finished cheaply: (nearly) sorted input
+						return;
+					}
+
+					// Recurse into the left part, loop on the right
+					pdqsort_loop<Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+					begin = pivot_pos + 1;
+					leftmost = false;
+				}
+			}
+
+			inline int log2(size_t n) {
+				int log = 0;
+				while (n >>= 1) {
+					log++;
+				}
+				return log;
+			}
+
+			// Merge [first, mid) held in buffer with [mid, last) back into [first, last)
+			template<class Iter, class T, class Compare>
+			void merge_back(T* buffer, T* buffer_end, Iter mid, Iter last, Iter out, Compare& comp) {
+				while (buffer != buffer_end) {
+					if (mid == last) {
+						std::move(buffer, buffer_end, out);
+						return;
+					}
+					// Take from the right only when strictly smaller, which keeps equal elements in order
+					if (comp(*mid, *buffer)) {
+						*out = std::move(*mid);
+						++mid;
+					}
+					else {
+						*out = std::move(*buffer);
+						++buffer;
+					}
+					++out;
+				}
+			}
+
+			template<class Iter, class T, class Compare>
+			void merge_sort(Iter first, Iter last, T* buffer, Compare& comp) {
+				ptrdiff_t size = last - first;
+				if (size <= insertion_sort_threshold) {
+					insertion_sort(first, last, comp);
+					return;
+				}
+				Iter mid = first + size / 2;
+				merge_sort(first, mid, buffer, comp);
+				merge_sort(mid, last, buffer, comp);
+				// Already in order across the halves: nothing to merge
+				if (!comp(*mid, *(mid - 1))) {
+					return;
+				}
+				T* buffer_end = std::move(first, mid, buffer);
+				merge_back(buffer, buffer_end, mid, last, first, comp);
+			}
+		}
+	}
+
+	/**
+	 * @brief Sort [first, last) with pattern-defeating quicksort; not stable.
+	 *
+	 * O(n log n) worst case and O(n) on sorted, reverse-sorted and
+	 * all-equal inputs. For arithmetic elements under a plain less/greater
+	 * (std or moon), partitioning is branchless and ranges of up to 16
+	 * elements are finished by a sorting network.
+	 * @param comp A strict weak ordering, e.g. moon::less or moon::greater.
+	 */
+	template<class Iter, class Compare>
+	void sort(Iter first, Iter last, Compare comp) {
+		if (last - first < 2) {
+			return;
+		}
+		detail::sorting::pdqsort_loop<detail::use_branchless<Iter, Compare>::value>(
+			first, last, comp, detail::sorting::log2(last - first));
+	}
+
+	template<class Iter>
+	void sort(Iter first, Iter last) {
+		Somn::sort(first, last, std::less<typename std::iterator_traits<Iter>::value_type>());
+	}
+
+	/**
+	 * @brief Stable merge sort of [first, last); equal elements keep their order.
+	 *
+	 * Needs a buffer of n/2 elements, taken from resource. Runs of up to 24
+	 * elements are insertion sorted, and merging is skipped when two halves
+	 * are already in order, so sorted input costs O(n).
+	 */
+	template<class Iter, class Compare>
+	void stable_sort(Iter first, Iter last, Compare comp, memory_resource* resource = default_resource()) {
+		typedef typename std::iterator_traits<Iter>::value_type T;
+		ptrdiff_t size = last - first;
+		if (size < 2) {
+			return;
+		}
+		// The buffer only ever holds moved-from values of the left halves; it starts default-constructed
+		size_t half = static_cast<size_t>(size / 2 + 1);
+		T* buffer = new_array<T>(resource, half);
+		try {
+			detail::sorting::merge_sort(first, last, buffer, comp);
+		}
+		catch (...) {
+			delete_array(resource, buffer, half);
+			throw;
+		}
+		delete_array(resource, buffer, half);
+	}
+
+	template<class Iter>
+	void stable_sort(Iter first, Iter last) {
+		Somn::stable_sort(first, last, std::less<typename std::iterator_traits<Iter>::value_type>());
+	}
+
+}
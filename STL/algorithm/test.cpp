@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <utility>
+#include "sort.h"
+#include "../vector/myVector.h"
+#include "../priority_queue/priority_queue.h"
+#include "../string/myString.h"
+
+// Every network must sort every 0/1 input of its size (0-1 principle)
+void test_networks() {
+    size_t failures = 0;
+    for (size_t n = 0; n <= 16; ++n) {
+        for (uint32_t bits = 0; bits < (1u << n); ++bits) {
+            int values[16];
+            for (size_t i = 0; i < n; ++i) {
+                values[i] = (bits >> i) & 1;
+            }
+            Somn::sort(values, values + n);
+            failures += !std::is_sorted(values, values + n);
+        }
+    }
+    std::cout << "networks: failures " << failures << ", comparators for 16: "
+              << Somn::detail::sorting::networks::networks[16]._count << std::endl;
+}
+
+void test_sort() {
+    std::mt19937 gen(6);
+    size_t failures = 0;
+    // Sizes around every threshold, several value distributions
+    for (size_t n = 0; n < 600; n += (n < 40 ? 1 : 37)) {
+        for (int kind = 0; kind < 4; ++kind) {
+            Somn::myVector<int> v;
+            for (size_t i = 0; i < n; ++i) {
+                int value = kind == 0 ? static_cast<int>(gen()) : kind == 1 ? static_cast<int>(gen() % 4)
+                          : kind == 2 ? static_cast<int>(i) : static_cast<int>(n - i);
+                v.push_back(value);
+            }
+            Somn::myVector<int> expected(v);
+            std::sort(expected.begin(), expected.end());
+            Somn::myVector<int> sorted(v), down(v), stable(v);
+            Somn::sort(sorted.begin(), sorted.end());
+            Somn::sort(down.begin(), down.end(), moon::greater<int>());
+            Somn::stable_sort(stable.begin(), stable.end(), moon::less<int>());
+            for (size_t i = 0; i < n; ++i) {
+                failures += sorted[i] != expected[i] || stable[i] != expected[i] || down[i] != expected[n - 1 - i];
+            }
+        }
+    }
+
+    // Non-arithmetic elements take the branching partition
+    Somn::myVector<cocoon::myString> words;
+    for (int i = 0; i < 5000; ++i) {
+        cocoon::myString word("w");
+        word.append_int(static_cast<int>(gen() % 1000));
+        words.push_back(word);
+    }
+    Somn::sort(words.begin(), words.end(), [](const cocoon::myString& l, const cocoon::myString& r) {
+        return strcmp(l.c_str(), r.c_str()) < 0;
+    });
+    for (size_t i = 1; i < words.size(); ++i) {
+        failures += strcmp(words[i - 1].c_str(), words[i].c_str()) > 0;
+    }
+
+    // Stability: equal keys keep their original order
+    Somn::myVector<std::pair<int, int>> records;
+    for (int i = 0; i < 100000; ++i) {
+        records.push_back({static_cast<int>(gen() % 100), i});
+    }
+    Somn::stable_sort(records.begin(), records.end(), [](const std::pair<int, int>& l, const std::pair<int, int>& r) {
+        return l.first < r.first;
+    });
+    for (size_t i = 1; i < records.size(); ++i) {
+        failures += records[i - 1].first > records[i].first
+                    || (records[i - 1].first == records[i].first && records[i - 1].second > records[i].second);
+    }
+    std::cout << "sort: failures " << failures << std::endl;
+}
+
+template<class Sort>
+double time_sort(const Somn::myVector<int>& input, Sort sort) {
+    Somn::myVector<int> v(input);
+    auto start = std::chrono::steady_clock::now();
+    sort(v.begin(), v.end());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!std::is_sorted(v.begin(), v.end())) {
+        std::cout << "not sorted!" << std::endl;
+    }
+    return ms;
+}
+
+void bench_sort() {
+    const size_t n = 10000000;
+    std::mt19937 gen(2);
+    const char* names[] = {"random      ", "sorted      ", "reverse     ", "duplicates  ", "sorted+noise"};
+    std::cout << n << " ints: Somn::sort / std::sort / Somn::stable_sort / std::stable_sort (ms)" << std::endl;
+    for (int kind = 0; kind < 5; ++kind) {
+        Somn::myVector<int> input;
+        input.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            int value = kind == 0 ? static_cast<int>(gen()) : kind == 1 ? static_cast<int>(i)
+                      : kind == 2 ? static_cast<int>(n - i) : kind == 3 ? static_cast<int>(gen() % 100)
+                      : static_cast<int>(gen() % 1000 == 0 ? gen() : i);
+            input.push_back(value);
+        }
+        std::cout << "  " << names[kind] << " "
+                  << time_sort(input, [](int* f, int* l) { Somn::sort(f, l, moon::less<int>()); }) << " / "
+                  << time_sort(input, [](int* f, int* l) { std::sort(f, l); }) << " / "
+                  << time_sort(input, [](int* f, int* l) { Somn::stable_sort(f, l); }) << " / "
+                  << time_sort(input, [](int* f, int* l) { std::stable_sort(f, l); }) << std::endl;
+    }
+
+    // Many tiny sorts: the sorting networks against std::sort's insertion sort
+    Somn::myVector<int> small;
+    for (size_t i = 0; i < n; ++i) {
+        small.push_back(static_cast<int>(gen()));
+    }
+    for (int width : {8, 16}) {
+        auto chunks = [width](int* f, int* l, auto sort) {
+            for (; f + width <= l; f += width) {
+                sort(f, f + width);
+            }
+        };
+        Somn::myVector<int> a(small), b(small);
+        auto start = std::chrono::steady_clock::now();
+        chunks(a.begin(), a.end(), [](int* f, int* l) { Somn::sort(f, l); });
+        auto t1 = std::chrono::steady_clock::now();
+        chunks(b.begin(), b.end(), [](int* f, int* l) { std::sort(f, l); });
+        auto t2 = std::chrono::steady_clock::now();
+        std::cout << "  " << n / width << " sorts of " << width << ": Somn::sort "
+                  << std::chrono::duration<double, std::milli>(t1 - start).count() << " ms, std::sort "
+                  << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+    }
+}
+
+int main() {
+    test_networks();
+    test_sort();
+    bench_sort();
+    return 0;
+}
@@ -0,0 +1,947 @@
+/**
+ * @file btree.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{btree}
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include "../memory/arena.h"
+#include "../vector/myVector.h"
+
+namespace Somn {
+
+	namespace detail {
+		// Uninitialized storage for one T; nodes construct and destroy elements explicitly
+		template<class T>
+		struct raw_slot {
+			alignas(T) unsigned char _bytes[sizeof(T)];
+
+			T& get() { return *reinterpret_cast<T*>(_bytes); }
+
+			const T& get() const { return *reinterpret_cast<const T*>(_bytes); }
+		};
+
+		// Move-construct *to from from, then destroy from
+		template<class T>
+		void relocate(raw_slot<T>* to, T& from) {
+			new(to->_bytes) T(std::move(from));
+			from.~T();
+		}
+
+		struct map_key_of {
+			template<class Pair>
+			const typename Pair::first_type& operator()(const Pair& entry) const { return entry.first; }
+		};
+
+		struct set_key_of {
+			template<class T>
+			const T& operator()(const T& value) const { return value; }
+		};
+
+		/**
+		 * @brief Bidirectional iterator over the values of a btree, leaf by leaf.
+		 *
+		 * A position is a leaf and an index in it. The end iterator points
+		 * one past the last value of the rightmost leaf.
+		 */
+		template<class Leaf, class Value>
+		class btree_iterator {
+		public:
+			typedef std::bidirectional_iterator_tag iterator_category;
+			typedef Value value_type;
+			typedef ptrdiff_t difference_type;
+			typedef Value* pointer;
+			typedef Value& reference;
+
+			btree_iterator() : _leaf(nullptr), _index(0) {}
+
+			btree_iterator(Leaf* leaf, size_t index) : _leaf(leaf), _index(index) {}
+
+			// Allow iterator -> const_iterator
+			template<class Other, class = std::enable_if_t<std::is_convertible<Other*, Value*>::value>>
+			btree_iterator(const btree_iterator<Leaf, Other>& it) : _leaf(it._leaf), _index(it._index) {}
+
+			reference operator*() const { return _leaf->value(_index); }
+
+			pointer operator->() const { return &_leaf->value(_index); }
+
+			btree_iterator& operator++() {
+				// Moving off the end of a leaf continues in the next one, except after the last leaf
+				if (++_index == _leaf->_count && _leaf->_next) {
+					_leaf = _leaf->_next;
+					_index = 0;
+				}
+				return *this;
+			}
+
+			btree_iterator operator++(int) {
+				btree_iterator temp(*this);
+				++*this;
+				return temp;
+			}
+
+			btree_iterator& operator--() {
+				if (_index == 0) {
+					_leaf = _leaf->_prev;
+					_index = _leaf->_count;
+				}
+				--_index;
+				return *this;
+			}
+
+			btree_iterator operator--(int) {
+				btree_iterator temp(*this);
+				--*this;
+				return temp;
+			}
+
+			bool operator==(const btree_iterator& it) const { return _leaf == it._leaf && _index == it._index; }
+
+			bool operator!=(const btree_iterator& it) const { return !(*this == it); }
+
+			Leaf* _leaf;     /**< Current leaf */
+			size_t _index;   /**< Position in the leaf */
+		};
+
+		/**
+		 * @brief B+tree shared by btree_map and btree_set.
+		 *
+		 * All values live in the leaves, which are linked in key order, so
+		 * range scans walk contiguous arrays and never climb back up the tree.
+		 * Internal nodes only hold separator keys and child pointers. Nodes
+		 * are sized to about NodeBytes (eight cache lines by default), which
+		 * gives a fanout of dozens for small keys and a shallow tree.
+		 *
+		 * Iterators are invalidated by any insertion or erasure.
+		 */
+		template<class Key, class Value, class KeyOfValue, class Compare, size_t NodeBytes>
+		class btree {
+		private:
+			struct node {
+				bool _leaf;
+				size_t _count;   // Values in a leaf, separator keys in an internal node
+			};
+
+			static constexpr size_t fit(size_t bytes, size_t per_slot) {
+				return bytes / per_slot < 4 ? 4 : bytes / per_slot;
+			}
+
+		public:
+			typedef Key key_type;
+			typedef Value value_type;
+			typedef Compare key_compare;
+			typedef size_t size_type;
+
+			/** Values per leaf. */
+			static constexpr size_t leaf_slots = fit(NodeBytes - sizeof(node) - 2 * sizeof(void*), sizeof(Value));
+			/** Children per internal node. */
+			static constexpr size_t internal_slots = fit(NodeBytes - sizeof(node) + sizeof(Key), sizeof(Key) + sizeof(void*));
+
+		private:
+			static constexpr size_t internal_keys = internal_slots - 1;
+			static constexpr size_t leaf_min = leaf_slots / 2;
+			static constexpr size_t internal_min = internal_keys / 2;
+
+			// Each array has one spare slot: an insert may overflow a node by one before it is split
+			struct leaf_node : node {
+				leaf_node* _prev;
+				leaf_node* _next;
+				raw_slot<Value> _values[leaf_slots + 1];
+
+				Value& value(size_t index) { return _values[index].get(); }
+			};
+
+			struct internal_node : node {
+				raw_slot<Key> _keys[internal_keys + 1];
+				node* _children[internal_slots + 1];
+
+				Key& key(size_t index) { return _keys[index].get(); }
+			};
+
+			// A node split off during insertion, to be linked into the parent after key
+			struct split_result {
+				node* _right = nullptr;
+				std::optional<Key> _key;
+			};
+
+		public:
+			typedef btree_iterator<leaf_node, Value> iterator;
+			typedef btree_iterator<leaf_node, const Value> const_iterator;
+			typedef std::reverse_iterator<iterator> reverse_iterator;
+			typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+			btree() : btree(Compare(), default_resource()) {}
+
+			explicit btree(memory_resource* resource) : btree(Compare(), resource) {}
+
+			explicit btree(const Compare& comp, memory_resource* resource = default_resource())
+				: _root(nullptr), _leftmost(nullptr), _rightmost(nullptr), _size(0), _comp(comp), _resource(resource) {}
+
+			/**
+			 * @brief Copy constructor; the copy is bulk loaded and uses the default resource.
+			 */
+			btree(const btree& other) : btree(other._comp, default_resource()) {
+				bulk_load(other.begin(), other.end());
+			}
+
+			btree(btree&& other) noexcept : btree(other._comp, other._resource) {
+				swap(other);
+			}
+
+			btree& operator=(const btree& other) {
+				if (this != &other) {
+					btree temp(other);
+					swap(temp);
+				}
+				return *this;
+			}
+
+			btree& operator=(btree&& other) noexcept {
+				swap(other);
+				return *this;
+			}
+
+			~btree() {
+				clear();
+			}
+
+			iterator begin() { return iterator(_leftmost, 0); }
+
+			iterator end() { return iterator(_rightmost, _rightmost ? _rightmost->_count : 0); }
+
+			const_iterator begin() const { return const_iterator(_leftmost, 0); }
+
+			const_iterator end() const { return const_iterator(_rightmost, _rightmost ? _rightmost->_count : 0); }
+
+			reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+			reverse_iterator rend() { return reverse_iterator(begin()); }
+
+			const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+			const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+			size_t size() const { return _size; }
+
+			bool empty() const { return _size == 0; }
+
+			/**
+			 * @brief Number of levels, 0 for an empty tree.
+			 */
+			size_t height() const {
+				size_t levels = 0;
+				for (node* cur = _root; cur; cur = cur->_leaf ? nullptr : static_cast<internal_node*>(cur)->_children[0]) {
+					levels++;
+				}
+				return levels;
+			}
+
+			key_compare key_comp() const { return _comp; }
+
+			memory_resource* resource() const { return _resource; }
+
+			/**
+			 * @brief First value whose key is not less than key.
+			 */
+			iterator lower_bound(const Key& key) {
+				if (!_root) {
+					return end();
+				}
+				leaf_node* leaf = find_leaf(key);
+				return normalize(leaf, leaf_lower_bound(leaf, key));
+			}
+
+			const_iterator lower_bound(const Key& key) const {
+				return const_cast<btree*>(this)->lower_bound(key);
+			}
+
+			/**
+			 * @brief First value whose key is greater than key.
+			 */
+			iterator upper_bound(const Key& key) {
+				if (!_root) {
+					return end();
+				}
+				leaf_node* leaf = find_leaf(key);
+				return normalize(leaf, leaf_upper_bound(leaf, key));
+			}
+
+			const_iterator upper_bound(const Key& key) const {
+				return const_cast<btree*>(this)->upper_bound(key);
+			}
+
+			std::pair<iterator, iterator> equal_range(const Key& key) {
+				return {lower_bound(key), upper_bound(key)};
+			}
+
+			std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+				return {lower_bound(key), upper_bound(key)};
+			}
+
+			iterator find(const Key& key) {
+				iterator it = lower_bound(key);
+				if (it == end() || _comp(key, KeyOfValue()(*it))) {
+					return end();
+				}
+				return it;
+			}
+
+			const_iterator find(const Key& key) const {
+				return const_cast<btree*>(this)->find(key);
+			}
+
+			bool contains(const Key& key) const {
+				return find(key) != end();
+			}
+
+			size_t count(const Key& key) const {
+				return contains(key) ? 1 : 0;
+			}
+
+			/**
+			 * @brief Erase the value with the given key.
+			 * @return The number of values erased (0 or 1).
+			 */
+			size_t erase(const Key& key) {
+				if (!_root || !erase_from(_root, key)) {
+					return 0;
+				}
+				_size--;
+				if (_root->_count == 0) {
+					// The root lost its last separator or value: drop a level
+					if (_root->_leaf) {
+						delete_object(_resource, static_cast<leaf_node*>(_root));
+						_root = _leftmost = _rightmost = nullptr;
+					}
+					else {
+						internal_node* old = static_cast<internal_node*>(_root);
+						_root = old->_children[0];
+						delete_object(_resource, old);
+					}
+				}
+				return 1;
+			}
+
+			/**
+			 * @brief Erase the value at pos.
+			 * @return An iterator to the value that followed it.
+			 */
+			iterator erase(const_iterator pos) {
+				assert(pos != end());
+				Key key = KeyOfValue()(*pos);
+				erase(key);
+				return upper_bound(key);
+			}
+
+			iterator erase(iterator pos) {
+				return erase(const_iterator(pos));
+			}
+
+			/**
+			 * @brief Erase every value with a key in [first, last).
+			 */
+			iterator erase(const_iterator first, const_iterator last) {
+				if (last == end()) {
+					while (first != end()) {
+						first = erase(first);
+					}
+					return end();
+				}
+				Key stop = KeyOfValue()(*last);
+				while (first != end() && _comp(KeyOfValue()(*first), stop)) {
+					first = erase(first);
+				}
+				return lower_bound(stop);
+			}
+
+			/**
+			 * @brief Destroy every value and free every node.
+			 */
+			void clear() {
+				if (_root) {
+					destroy_subtree(_root);
+				}
+				_root = _leftmost = _rightmost = nullptr;
+				_size = 0;
+			}
+
+			/**
+			 * @brief Replace the contents with a sorted range of unique values in O(n).
+			 *
+			 * Leaves are filled almost completely and each level above is built
+			 * in one pass, which is much faster than inserting one by one and
+			 * gives a denser tree.
+			 * @param first, last A range sorted by key, without duplicate keys.
+			 */
+			template<class ForwardIt>
+			void bulk_load(ForwardIt first, ForwardIt last) {
+				clear();
+				size_t n = std::distance(first, last);
+				if (n == 0) {
+					return;
+				}
+
+				// Spread the values evenly, so every leaf is at least half full
+				size_t leaves = (n + leaf_slots - 1) / leaf_slots;
+				myVector<std::pair<node*, const Key*>> level;
+				level.reserve(leaves);
+				leaf_node* prev = nullptr;
+				for (size_t index = 0; index < leaves; index++) {
+					size_t count = n / leaves + (index < n % leaves ? 1 : 0);
+					leaf_node* leaf = new_leaf();
+					for (; leaf->_count < count; ++first) {
+						new(leaf->_values[leaf->_count]._bytes) Value(*first);
+						assert(leaf->_count == 0 || _comp(KeyOfValue()(leaf->value(leaf->_count - 1)), KeyOfValue()(leaf->value(leaf->_count))));
+						assert(prev == nullptr || leaf->_count > 0 || _comp(KeyOfValue()(prev->value(prev->_count - 1)), KeyOfValue()(leaf->value(0))));
+						leaf->_count++;
+						_size++;
+					}
+					leaf->_prev = prev;
+					if (prev) {
+						prev->_next = leaf;
+					}
+					else {
+						_leftmost = leaf;
+					}
+					prev = leaf;
+					level.push_back({leaf, &KeyOfValue()(leaf->value(0))});
+				}
+				_rightmost = prev;
+
+				// Build internal levels until one node is left; the separator before
+				// each child is the smallest key of that child's subtree
+				while (level.size() > 1) {
+					size_t children = level.size();
+					size_t parents = (children + internal_slots - 1) / internal_slots;
+					myVector<std::pair<node*, const Key*>> upper;
+					upper.reserve(parents);
+					size_t child = 0;
+					for (size_t index = 0; index < parents; index++) {
+						size_t count = children / parents + (index < children % parents ? 1 : 0);
+						internal_node* parent = new_internal();
+						parent->_children[0] = level[child].first;
+						const Key* smallest = level[child].second;
+						for (size_t slot = 1; slot < count; slot++) {
+							new(parent->_keys[slot - 1]._bytes) Key(*level[child + slot].second);
+							parent->_children[slot] = level[child + slot].first;
+						}
+						parent->_count = count - 1;
+						child += count;
+						upper.push_back({parent, smallest});
+					}
+					level.swap(upper);
+				}
+				_root = level[0].first;
+			}
+
+			void swap(btree& other) {
+				std::swap(_root, other._root);
+				std::swap(_leftmost, other._leftmost);
+				std::swap(_rightmost, other._rightmost);
+				std::swap(_size, other._size);
+				std::swap(_comp, other._comp);
+				std::swap(_resource, other._resource);
+			}
+
+		protected:
+			/**
+			 * @brief Insert a value built from args unless key is present; args are untouched when it is.
+			 */
+			template<class... Args>
+			std::pair<iterator, bool> insert_unique(const Key& key, Args&&... args) {
+				if (!_root) {
+					leaf_node* leaf = new_leaf();
+					_root = _leftmost = _rightmost = leaf;
+				}
+				split_result split;
+				std::pair<iterator, bool> result = insert_into(_root, key, split, std::forward<Args>(args)...);
+				if (split._right) {
+					// The root split: grow a level
+					internal_node* root = new_internal();
+					new(root->_keys[0]._bytes) Key(std::move(*split._key));
+					root->_children[0] = _root;
+					root->_children[1] = split._right;
+					root->_count = 1;
+					_root = root;
+				}
+				if (result.second) {
+					_size++;
+				}
+				return result;
+			}
+
+		private:
+			leaf_node* new_leaf() {
+				leaf_node* leaf = new_object<leaf_node>(_resource);
+				leaf->_leaf = true;
+				leaf->_count = 0;
+				leaf->_prev = leaf->_next = nullptr;
+				return leaf;
+			}
+
+			internal_node* new_internal() {
+				internal_node* internal = new_object<internal_node>(_resource);
+				internal->_leaf = false;
+				internal->_count = 0;
+				return internal;
+			}
+
+			void destroy_subtree(node* n) {
+				if (n->_leaf) {
+					leaf_node* leaf = static_cast<leaf_node*>(n);
+					for (size_t index = 0; index < leaf->_count; index++) {
+						leaf->value(index).~Value();
+					}
+					delete_object(_resource, leaf);
+					return;
+				}
+				internal_node* internal = static_cast<internal_node*>(n);
+				for (size_t index = 0; index <= internal->_count; index++) {
+					destroy_subtree(internal->_children[index]);
+				}
+				for (size_t index = 0; index < internal->_count; index++) {
+					internal->key(index).~Key();
+				}
+				delete_object(_resource, internal);
+			}
+
+			// Child to descend into: the number of separators not greater than key
+			size_t child_index(internal_node* internal, const Key& key) const {
+				size_t low = 0, high = internal->_count;
+				while (low < high) {
+					size_t mid = (low + high) / 2;
+					if (_comp(key, internal->key(mid))) {
+						high = mid;
+					}
+					else {
+						low = mid + 1;
+					}
+				}
+				return low;
+			}
+
+			size_t leaf_lower_bound(leaf_node* leaf, const Key& key) const {
+				size_t low = 0, high = leaf->_count;
+				while (low < high) {
+					size_t mid = (low + high) / 2;
+					if (_comp(KeyOfValue()(leaf->value(mid)), key)) {
+						low = mid + 1;
+					}
+					else {
+						high = mid;
+					}
+				}
+				return low;
+			}
+
+			size_t leaf_upper_bound(leaf_node* leaf, const Key& key) const {
+				size_t low = 0, high = leaf->_count;
+				while (low < high) {
+					size_t mid = (low + high) / 2;
+					if (_comp(key, KeyOfValue()(leaf->value(mid)))) {
+						high = mid;
+					}
+					else {
+						low = mid + 1;
+					}
+				}
+				return low;
+			}
+
+			leaf_node* find_leaf(const Key& key) const {
+				node* cur = _root;
+				while (!cur->_leaf) {
+					internal_node* internal = static_cast<internal_node*>(cur);
+					cur = internal->_children[child_index(internal, key)];
+				}
+				return static_cast<leaf_node*>(cur);
+			}
+
+			// A position past the end of a leaf is the start of the next leaf
+			iterator normalize(leaf_node* leaf, size_t index) {
+				if (index == leaf->_count && leaf->_next) {
+					return iterator(leaf->_next, 0);
+				}
+				return iterator(leaf, index);
+			}
+
+			template<class... Args>
+			std::pair<iterator, bool> insert_into(node* n, const Key& key, split_result& split, Args&&... args) {
+				if (n->_leaf) {
+					leaf_node* leaf = static_cast<leaf_node*>(n);
+					size_t pos = leaf_lower_bound(leaf, key);
+					if (pos < leaf->_count && !_comp(key, KeyOfValue()(leaf->value(pos)))) {
+						return {iterator(leaf, pos), false};
+					}
+					// Build the value before shifting, so a throwing constructor leaves the leaf intact
+					Value value(std::forward<Args>(args)...);
+					for (size_t index = leaf->_count; index > pos; index--) {
+						relocate(&leaf->_values[index], leaf->value(index - 1));
+					}
+					new(leaf->_values[pos]._bytes) Value(std::move(value));
+					leaf->_count++;
+					if (leaf->_count <= leaf_slots) {
+						return {iterator(leaf, pos), true};
+					}
+					leaf_node* right = split_leaf(leaf);
+					split._right = right;
+					split._key.emplace(KeyOfValue()(right->value(0)));
+					if (pos < leaf->_count) {
+						return {iterator(leaf, pos), true};
+					}
+					return {iterator(right, pos - leaf->_count), true};
+				}
+
+				internal_node* internal = static_cast<internal_node*>(n);
+				size_t child = child_index(internal, key);
+				split_result child_split;
+				std::pair<iterator, bool> result = insert_into(internal->_children[child], key, child_split, std::forward<Args>(args)...);
+				if (child_split._right) {
+					for (size_t index = internal->_count; index > child; index--) {
+						relocate(&internal->_keys[index], internal->key(index - 1));
+					}
+					new(internal->_keys[child]._bytes) Key(std::move(*child_split._key));
+					for (size_t index = internal->_count + 1; index > child + 1; index--) {
+						internal->_children[index] = internal->_children[index - 1];
+					}
+					internal->_children[child + 1] = child_split._right;
+					internal->_count++;
+					if (internal->_count > internal_keys) {
+						split_internal(internal, split);
+					}
+				}
+				return result;
+			}
+
+			// Move the upper half of an overfull leaf into a new right sibling
+			leaf_node* split_leaf(leaf_node* leaf) {
+				leaf_node* right = new_leaf();
+				size_t keep = leaf->_count / 2;
+				for (size_t index = keep; index < leaf->_count; index++) {
+					relocate(&right->_values[index - keep], leaf->value(index));
+				}
+				right->_count = leaf->_count - keep;
+				leaf->_count = keep;
+
+				right->_next = leaf->_next;
+				right->_prev = leaf;
+				if (leaf->_next) {
+					leaf->_next->_prev = right;
+				}
+				else {
+					_rightmost = right;
+				}
+				leaf->_next = right;
+				return right;
+			}
+
+			// Split an overfull internal node; its middle key moves up into split
+			void split_internal(internal_node* internal, split_result& split) {
+				internal_node* right = new_internal();
+				size_t mid = internal->_count / 2;
+				for (size_t index = mid + 1; index < internal->_count; index++) {
+					relocate(&right->_keys[index - mid - 1], internal->key(index));
+				}
+				for (size_t index = mid + 1; index <= internal->_count; index++) {
+					right->_children[index - mid - 1] = internal->_children[index];
+				}
+				right->_count = internal->_count - mid - 1;
+				split._key.emplace(std::move(internal->key(mid)));
+				internal->key(mid).~Key();
+				internal->_count = mid;
+				split._right = right;
+			}
+
+			bool erase_from(node* n, const Key& key) {
+				if (n->_leaf) {
+					leaf_node* leaf = static_cast<leaf_node*>(n);
+					size_t pos = leaf_lower_bound(leaf, key);
+					if (pos == leaf->_count || _comp(key, KeyOfValue()(leaf->value(pos)))) {
+						return false;
+					}
+					leaf->value(pos).~Value();
+					for (size_t index = pos + 1; index < leaf->_count; index++) {
+						relocate(&leaf->_values[index - 1], leaf->value(index));
+					}
+					leaf->_count--;
+					return true;
+				}
+				internal_node* internal = static_cast<internal_node*>(n);
+				size_t child = child_index(internal, key);
+				if (!erase_from(internal->_children[child], key)) {
+					return false;
+				}
+				node* c = internal->_children[child];
+				if (c->_count < (c->_leaf ? leaf_min : internal_min)) {
+					rebalance(internal, child);
+				}
+				return true;
+			}
+
+			// Refill an underfull child from a sibling, or merge it with one
+			void rebalance(internal_node* parent, size_t child) {
+				node* left = child > 0 ? parent->_children[child - 1] : nullptr;
+				node* right = child < parent->_count ? parent->_children[child + 1] : nullptr;
+				size_t min = parent->_children[child]->_leaf ? leaf_min : internal_min;
+				if (left && left->_count > min) {
+					borrow_from_left(parent, child);
+				}
+				else if (right && right->_count > min) {
+					borrow_from_right(parent, child);
+				}
+				else if (left) {
+					merge(parent, child - 1);
+				}
+				else {
+					merge(parent, child);
+				}
+			}
+
+			void borrow_from_left(internal_node* parent, size_t child) {
+				if (parent->_children[child]->_leaf) {
+					leaf_node* c = static_cast<leaf_node*>(parent->_children[child]);
+					leaf_node* left = static_cast<leaf_node*>(parent->_children[child - 1]);
+					for (size_t index = c->_count; index > 0; index--) {
+						relocate(&c->_values[index], c->value(index - 1));
+					}
+					relocate(&c->_values[0], left->value(left->_count - 1));
+					left->_count--;
+					c->_count++;
+					parent->key(child - 1) = KeyOfValue()(c->value(0));
+					return;
+				}
+				// Rotate through the parent: its separator comes down, the left sibling's last key goes up
+				internal_node* c = static_cast<internal_node*>(parent->_children[child]);
+				internal_node* left = static_cast<internal_node*>(parent->_children[child - 1]);
+				for (size_t index = c->_count; index > 0; index--) {
+					relocate(&c->_keys[index], c->key(index - 1));
+				}
+				for (size_t index = c->_count + 1; index > 0; index--) {
+					c->_children[index] = c->_children[index - 1];
+				}
+				new(c->_keys[0]._bytes) Key(std::move(parent->key(child - 1)));
+				c->_children[0] = left->_children[left->_count];
+				parent->key(child - 1) = std::move(left->key(left->_count - 1));
+				left->key(left->_count - 1).~Key();
+				left->_count--;
+				c->_count++;
+			}
+
+			void borrow_from_right(internal_node* parent, size_t child) {
+				if (parent->_children[child]->_leaf) {
+					leaf_node* c = static_cast<leaf_node*>(parent->_children[child]);
+					leaf_node* right = static_cast<leaf_node*>(parent->_children[child + 1]);
+					relocate(&c->_values[c->_count], right->value(0));
+					for (size_t index = 1; index < right->_count; index++) {
+						relocate(&right->_values[index - 1], right->value(index));
+					}
+					right->_count--;
+					c->_count++;
+					parent->key(child) = KeyOfValue()(right->value(0));
+					return;
+				}
+				internal_node* c = static_cast<internal_node*>(parent->_children[child]);
+				internal_node* right = static_cast<internal_node*>(parent->_children[child + 1]);
+				new(c->_keys[c->_count]._bytes) Key(std::move(parent->key(child)));
+				c->_children[c->_count + 1] = right->_children[0];
+				parent->key(child) = std::move(right->key(0));
+				right->key(0).~Key();
+				for (size_t index = 1; index < right->_count; index++) {
+					relocate(&right->_keys[index - 1], right->key(index));
+				}
+				for (size_t index = 1; index <= right->_count; index++) {
+					right->_children[index - 1] = right->_children[index];
+				}
+				right->_count--;
+				c->_count++;
+			}
+
+			// Merge child index + 1 into child index and drop their separator from the parent
+			void merge(internal_node* parent, size_t index) {
+				node* a = parent->_children[index];
+				node* b = parent->_children[index + 1];
+				if (a->_leaf) {
+					leaf_node* left = static_cast<leaf_node*>(a);
+					leaf_node* right = static_cast<leaf_node*>(b);
+					for (size_t pos = 0; pos < right->_count; pos++) {
+						relocate(&left->_values[left->_count + pos], right->value(pos));
+					}
+					left->_count += right->_count;
+					left->_next = right->_next;
+					if (right->_next) {
+						right->_next->_prev = left;
+					}
+					else {
+						_rightmost = left;
+					}
+					delete_object(_resource, right);
+				}
+				else {
+					internal_node* left = static_cast<internal_node*>(a);
+					internal_node* right = static_cast<internal_node*>(b);
+					relocate(&left->_keys[left->_count], parent->key(index));
+					for (size_t pos = 0; pos < right->_count; pos++) {
+						relocate(&left->_keys[left->_count + 1 + pos], right->key(pos));
+					}
+					for (size_t pos = 0; pos <= right->_count; pos++) {
+						left->_children[left->_count + 1 + pos] = right->_children[pos];
+					}
+					left->_count += right->_count + 1;
+					right->_count = 0;
+					delete_object(_resource, right);
+				}
+				if (a->_leaf) {
+					parent->key(index).~Key();
+				}
+				// The separator slot is now empty: close the gap in keys and children
+				for (size_t pos = index + 1; pos < parent->_count; pos++) {
+					relocate(&parent->_keys[pos - 1], parent->key(pos));
+				}
+				for (size_t pos = index + 2; pos <= parent->_count; pos++) {
+					parent->_children[pos - 1] = parent->_children[pos];
+				}
+				parent->_count--;
+			}
+
+			node* _root;                /**< Root node, nullptr when empty */
+			leaf_node* _leftmost;       /**< First leaf, where begin() points */
+			leaf_node* _rightmost;      /**< Last leaf, where end() points */
+			size_t _size;               /**< Number of values */
+			mutable Compare _comp;      /**< moon::less and moon::greater have non-const operator() */
+			memory_resource* _resource; /**< Source of the nodes */
+		};
+	}
+
+	/**
+	 * @brief Ordered map on a B+tree.
+	 * @tparam Key The key type.
+	 * @tparam T The mapped type.
+	 * @tparam Compare Strict weak ordering of keys, e.g. std::less, moon::less or moon::greater.
+	 * @tparam NodeBytes Target node size in bytes.
+	 */
+	template<class Key, class T, class Compare = std::less<Key>, size_t NodeBytes = 512>
+	class btree_map : public detail::btree<Key, std::pair<const Key, T>, detail::map_key_of, Compare, NodeBytes> {
+		typedef detail::btree<Key, std::pair<const Key, T>, detail::map_key_of, Compare, NodeBytes> base;
+
+	public:
+		typedef T mapped_type;
+		typedef typename base::value_type value_type;
+		typedef typename base::iterator iterator;
+		typedef typename base::const_iterator const_iterator;
+
+		using base::base;
+
+		btree_map() = default;
+
+		/**
+		 * @brief Insert a copy of entry unless its key is already present.
+		 * @return The entry with that key and whether it was inserted.
+		 */
+		std::pair<iterator, bool> insert(const value_type& entry) {
+			return this->insert_unique(entry.first, entry);
+		}
+
+		template<class InputIt>
+		void insert(InputIt first, InputIt last) {
+			for (; first != last; ++first) {
+				insert(*first);
+			}
+		}
+
+		/**
+		 * @brief Insert (key, mapped constructed from args) unless key is present.
+		 */
+		template<class... Args>
+		std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+			return this->insert_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+			                           std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		/**
+		 * @brief Insert key with value, or assign value to the existing entry.
+		 */
+		template<class M>
+		std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value) {
+			std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(value));
+			if (!result.second) {
+				result.first->second = std::forward<M>(value);
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Access the value for key, inserting a default-constructed one if absent.
+		 */
+		T& operator[](const Key& key) {
+			return try_emplace(key).first->second;
+		}
+
+		/**
+		 * @brief Access the value for key.
+		 * @throws std::out_of_range when key is absent.
+		 */
+		T& at(const Key& key) {
+			iterator it = this->find(key);
+			if (it == this->end()) {
+				throw std::out_of_range("btree_map::at: key not found");
+			}
+			return it->second;
+		}
+
+		const T& at(const Key& key) const {
+			return const_cast<btree_map*>(this)->at(key);
+		}
+	};
+
+	/**
+	 * @brief Ordered set on a B+tree; values cannot be changed through iterators.
+	 * @tparam Key The value type.
+	 * @tparam Compare Strict weak ordering, e.g. std::less, moon::less or moon::greater.
+	 * @tparam NodeBytes Target node size in bytes.
+	 */
+	template<class Key, class Compare = std::less<Key>, size_t NodeBytes = 512>
+	class btree_set : public detail::btree<Key, Key, detail::set_key_of, Compare, NodeBytes> {
+		typedef detail::btree<Key, Key, detail::set_key_of, Compare, NodeBytes> base;
+
+	public:
+		typedef typename base::const_iterator iterator;
+		typedef typename base::const_iterator const_iterator;
+
+		using base::base;
+
+		btree_set() = default;
+
+		iterator begin() const { return base::begin(); }
+
+		iterator end() const { return base::end(); }
+
+		iterator find(const Key& key) const { return base::find(key); }
+
+		iterator lower_bound(const Key& key) const { return base::lower_bound(key); }
+
+		iterator upper_bound(const Key& key) const { return base::upper_bound(key); }
+
+		/**
+		 * @brief Insert value unless it is already present.
+		 */
+		std::pair<iterator, bool> insert(const Key& value) {
+			return this->insert_unique(value, value);
+		}
+
+		template<class InputIt>
+		void insert(InputIt first, InputIt last) {
+			for (; first != last; ++first) {
+				insert(*first);
+			}
+		}
+	};
+
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include "btree.h"
+#include "../vector/myVector.h"
+#include "../priority_queue/priority_queue.h"
+#include "../string/myString.h"
+
+void test_btree() {
+    using namespace Somn;
+
+    btree_map<int, int> map;
+    for (int i = 0; i < 1000; ++i) {
+        map[(i * 7919) % 1000] = i;             // Out-of-order inserts
+    }
+    map.insert({5, -1});                        // Key exists, not replaced
+    map.insert_or_assign(6, -1);                // Key exists, replaced
+    std::cout << "size " << map.size() << ", height " << map.height() << ", map[5] " << (map.at(5) != -1)
+              << ", map[6] " << map.at(6) << ", contains 1000 " << map.contains(1000) << std::endl;
+
+    // Bounds and a range scan [100, 110)
+    std::cout << "lower_bound(100) " << map.lower_bound(100)->first << ", upper_bound(100) " << map.upper_bound(100)->first
+              << ", upper_bound(999) is end " << (map.upper_bound(999) == map.end()) << std::endl;
+    std::cout << "range [100, 110):";
+    for (auto it = map.lower_bound(100); it != map.lower_bound(110); ++it) {
+        std::cout << " " << it->first;
+    }
+    std::cout << std::endl;
+
+    // Reverse iteration and erase while iterating
+    std::cout << "last three:";
+    auto rit = map.rbegin();
+    for (int i = 0; i < 3; ++i, ++rit) {
+        std::cout << " " << rit->first;
+    }
+    std::cout << std::endl;
+    for (auto it = map.begin(); it != map.end();) {
+        it = it->first % 3 == 0 ? map.erase(it) : std::next(it);
+    }
+    std::cout << "after erasing multiples of 3: " << map.size() << ", first " << map.begin()->first << std::endl;
+
+    // moon comparators: a descending set
+    btree_set<int, moon::greater<int>> set;
+    for (int i = 0; i < 20; ++i) {
+        set.insert(i);
+    }
+    std::cout << "greater set:";
+    for (auto it = set.lower_bound(12); it != set.end(); ++it) {
+        std::cout << " " << *it;
+    }
+    std::cout << std::endl;
+
+    // Bulk load from sorted input, then keep modifying it
+    myVector<std::pair<cocoon::myString, int>> sorted;
+    for (int i = 0; i < 5000; ++i) {
+        cocoon::myString key("key:");
+        key.append_int(100000 + i);
+        sorted.push_back({key, i});
+    }
+    arena a;
+    btree_map<cocoon::myString, int> words(&a);
+    words.bulk_load(sorted.begin(), sorted.end());
+    words.erase(cocoon::myString("key:100000"));
+    words[cocoon::myString("key:0")] = -1;
+    std::cout << "bulk load: size " << words.size() << ", height " << words.height() << ", first "
+              << words.begin()->first.c_str() << ", arena " << (words.resource() == &a) << std::endl;
+}
+
+// Random inserts, erases and bounds checked against std::map
+void test_against_std() {
+    Somn::btree_map<long long, long long, std::less<long long>, 128> map;   // Small nodes: many splits and merges
+    std::map<long long, long long> reference;
+    std::mt19937_64 gen(17);
+    size_t mismatches = 0;
+    for (int i = 0; i < 300000; ++i) {
+        long long key = static_cast<long long>(gen() % 20000);
+        switch (gen() % 4) {
+        case 0:
+            map[key] = i;
+            reference[key] = i;
+            break;
+        case 1:
+            mismatches += map.erase(key) != reference.erase(key);
+            break;
+        case 2: {
+            auto it = map.lower_bound(key);
+            auto ref = reference.lower_bound(key);
+            mismatches += (it == map.end()) != (ref == reference.end());
+            if (it != map.end() && ref != reference.end()) {
+                mismatches += it->first != ref->first || it->second != ref->second;
+            }
+            break;
+        }
+        default: {
+            auto it = map.upper_bound(key);
+            auto ref = reference.upper_bound(key);
+            mismatches += (it == map.end()) != (ref == reference.end());
+            if (it != map.end() && ref != reference.end()) {
+                mismatches += it->first != ref->first;
+            }
+        }
+        }
+    }
+    mismatches += !std::equal(map.begin(), map.end(), reference.begin(), reference.end());
+    mismatches += !std::equal(map.rbegin(), map.rend(), reference.rbegin(), reference.rend());
+
+    // Copies and erasing down to nothing
+    auto copy = map;
+    mismatches += copy.size() != map.size() || !std::equal(copy.begin(), copy.end(), map.begin());
+    for (const auto& entry : reference) {
+        mismatches += map.erase(entry.first) != 1;
+    }
+    std::cout << "random ops: size " << copy.size() << "/" << reference.size() << ", empty after erase "
+              << (map.empty() && map.begin() == map.end() && map.height() == 0) << ", mismatches " << mismatches << std::endl;
+}
+
+template<class Map>
+void bench_map(const char* name, const Somn::myVector<long long>& keys, const Somn::myVector<long long>& probes) {
+    typedef std::chrono::steady_clock clock;
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    size_t n = keys.size();
+
+    auto start = clock::now();
+    Map map;
+    for (size_t i = 0; i < n; ++i) {
+        map[keys[i]] = i;
+    }
+    auto t1 = clock::now();
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        hits += map.find(probes[i]) != map.end();
+    }
+    auto t2 = clock::now();
+    // 100000 scans of 100 entries from a random start
+    long long sum = 0;
+    for (size_t i = 0; i < 100000; ++i) {
+        auto it = map.lower_bound(probes[i]);
+        for (int j = 0; j < 100 && it != map.end(); ++j, ++it) {
+            sum += it->second;
+        }
+    }
+    auto t3 = clock::now();
+    for (const auto& entry : map) {
+        sum += entry.second;
+    }
+    auto t4 = clock::now();
+    std::cout << name << ": insert " << ms(start, t1) << " ms, find " << ms(t1, t2) << " ms, range scan " << ms(t2, t3)
+              << " ms, full scan " << ms(t3, t4) << " ms (" << hits << ", " << sum << ")" << std::endl;
+}
+
+void bench_btree() {
+    typedef std::chrono::steady_clock clock;
+    const size_t n = 1000000;
+    std::mt19937_64 gen(5);
+    Somn::myVector<long long> keys, probes;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(static_cast<long long>(gen() % (4 * n)));
+        probes.push_back(static_cast<long long>(gen() % (4 * n)));
+    }
+    std::cout << n << " random keys, fanout " << Somn::btree_map<long long, size_t>::leaf_slots << "/"
+              << Somn::btree_map<long long, size_t>::internal_slots << std::endl;
+    bench_map<Somn::btree_map<long long, size_t>>("  Somn::btree_map", keys, probes);
+    bench_map<std::map<long long, size_t>>("  std::map       ", keys, probes);
+
+    // Bulk load of sorted input against one insert per key
+    Somn::myVector<std::pair<long long, size_t>> sorted;
+    for (size_t i = 0; i < n; ++i) {
+        sorted.push_back({static_cast<long long>(i * 2), i});
+    }
+    auto start = clock::now();
+    Somn::btree_map<long long, size_t> loaded;
+    loaded.bulk_load(sorted.begin(), sorted.end());
+    auto t1 = clock::now();
+    Somn::btree_map<long long, size_t> inserted;
+    for (const auto& entry : sorted) {
+        inserted.insert(entry);
+    }
+    auto t2 = clock::now();
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    std::cout << "  sorted input: bulk_load " << ms(start, t1) << " ms (height " << loaded.height() << "), insert "
+              << ms(t1, t2) << " ms (height " << inserted.height() << ")" << std::endl;
+}
+
+int main() {
+    test_btree();
+    test_against_std();
+    bench_btree();
+    return 0;
+}
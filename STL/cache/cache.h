@@ -0,0 +1,504 @@
+/**
+ * @file cache.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{cache}
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "../list/list.h"
+#include "../hash_map/hash_map.h"
+#include "../memory/pool.h"
+
+namespace Somn {
+
+	namespace detail {
+		/**
+		 * @brief Capacity, counters and eviction callback shared by lru_cache and lfu_cache.
+		 *
+		 * Capacity is a total cost: with the default cost of 1 per entry it is
+		 * an entry count, with byte sizes as costs it is a byte budget.
+		 */
+		template<class Key, class Value>
+		class cache_base {
+		public:
+			typedef Key key_type;
+			typedef Value mapped_type;
+			typedef std::function<void(const Key&, Value&)> eviction_callback;
+
+			size_t capacity() const { return _capacity; }
+
+			/** Sum of the costs of the cached entries. */
+			size_t cost() const { return _cost; }
+
+			size_t hits() const { return _hits; }
+
+			size_t misses() const { return _misses; }
+
+			size_t evictions() const { return _evictions; }
+
+			void reset_stats() {
+				_hits = _misses = _evictions = 0;
+			}
+
+			/**
+			 * @brief Call callback with every entry evicted for capacity; erase() and clear() do not call it.
+			 */
+			void set_eviction_callback(eviction_callback callback) {
+				_on_evict = std::move(callback);
+			}
+
+		protected:
+			explicit cache_base(size_t capacity) : _capacity(capacity), _cost(0), _hits(0), _misses(0), _evictions(0) {}
+
+			size_t _capacity;
+			size_t _cost;
+			size_t _hits;
+			size_t _misses;
+			size_t _evictions;
+			eviction_callback _on_evict;
+		};
+	}
+
+	/**
+	 * @brief Least-recently-used cache: a beat::list in recency order plus a hash_map index.
+	 *
+	 * get, put, erase and eviction are O(1). A hit splices the entry to the
+	 * front of the list, so nothing is allocated or copied; list nodes come
+	 * from a pool_resource owned by the cache and are recycled on eviction.
+	 * Not thread safe; see sharded_cache.
+	 */
+	template<class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<>>
+	class lru_cache : public detail::cache_base<Key, Value> {
+		typedef detail::cache_base<Key, Value> base;
+
+		struct entry {
+			Key _key;
+			Value _value;
+			size_t _cost;
+		};
+
+		typedef beat::list<entry> list_type;
+		typedef typename list_type::iterator position;
+
+	public:
+		typedef Hash hasher;
+
+		/**
+		 * @param capacity Total cost the cache may hold.
+		 */
+		explicit lru_cache(size_t capacity = 0) : base(capacity), _entries(&_pool) {}
+
+		lru_cache(const lru_cache&) = delete;
+		lru_cache& operator=(const lru_cache&) = delete;
+
+		/**
+		 * @brief Look up key and mark it most recently used.
+		 * @return The cached value, or nullptr on a miss. Valid until the next put or erase.
+		 */
+		Value* get(const Key& key) {
+			auto it = _index.find(key);
+			if (it == _index.end()) {
+				this->_misses++;
+				return nullptr;
+			}
+			this->_hits++;
+			_entries.splice(_entries.begin(), _entries, it->second);
+			return &(*it->second)._value;
+		}
+
+		/**
+		 * @brief Look up key without touching recency or the counters.
+		 */
+		Value* peek(const Key& key) {
+			auto it = _index.find(key);
+			return it == _index.end() ? nullptr : &(*it->second)._value;
+		}
+
+		bool contains(const Key& key) const {
+			return _index.contains(key);
+		}
+
+		/**
+		 * @brief Insert or replace key, then evict least recently used entries until the cost fits.
+		 * @param cost Cost of this entry, e.g. 1 or its size in bytes.
+		 * @return false, caching nothing, if cost alone exceeds the capacity.
+		 */
+		bool put(const Key& key, Value value, size_t cost = 1) {
+			if (cost > this->_capacity) {
+				erase(key);
+				return false;
+			}
+			auto it = _index.find(key);
+			if (it != _index.end()) {
+				entry& cached = *it->second;
+				cached._value = std::move(value);
+				this->_cost += cost - cached._cost;
+				cached._cost = cost;
+				_entries.splice(_entries.begin(), _entries, it->second);
+			}
+			else {
+				_entries.push_front(entry{key, std::move(value), cost});
+				_index.try_emplace(key, _entries.begin());
+				this->_cost += cost;
+			}
+			shrink_to_capacity();
+			return true;
+		}
+
+		/**
+		 * @brief Remove key without calling the eviction callback.
+		 * @return The number of entries removed (0 or 1).
+		 */
+		size_t erase(const Key& key) {
+			auto it = _index.find(key);
+			if (it == _index.end()) {
+				return 0;
+			}
+			this->_cost -= (*it->second)._cost;
+			_entries.erase(it->second);
+			_index.erase(it);
+			return 1;
+		}
+
+		void clear() {
+			_entries.clear();
+			_index.clear();
+			this->_cost = 0;
+		}
+
+		/**
+		 * @brief Change the capacity, evicting entries if it shrinks.
+		 */
+		void set_capacity(size_t capacity) {
+			this->_capacity = capacity;
+			shrink_to_capacity();
+		}
+
+		size_t size() const { return _index.size(); }
+
+		bool empty() const { return _index.empty(); }
+
+	private:
+		void shrink_to_capacity() {
+			while (this->_cost > this->_capacity) {
+				position last = --_entries.end();
+				entry& victim = *last;
+				if (this->_on_evict) {
+					this->_on_evict(victim._key, victim._value);
+				}
+				this->_evictions++;
+				this->_cost -= victim._cost;
+				_index.erase(victim._key);
+				_entries.erase(last);
+			}
+		}
+
+		pool_resource _pool;                          /**< List nodes; declared first so it outlives _entries */
+		list_type _entries;                           /**< Most recently used first */
+		hash_map<Key, position, Hash, KeyEqual> _index;
+	};
+
+	/**
+	 * @brief Least-frequently-used cache with O(1) operations; ties go to the least recently used.
+	 *
+	 * The entries form one beat::list ordered by use count, and within one
+	 * count by the time they reached it. A second index remembers the last
+	 * entry of each count, so a hit moves its entry to the end of the next
+	 * count's run with a single splice. Eviction takes the front of the list.
+	 * Not thread safe; see sharded_cache.
+	 */
+	template<class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<>>
+	class lfu_cache : public detail::cache_base<Key, Value> {
+		typedef detail::cache_base<Key, Value> base;
+
+		struct entry {
+			Key _key;
+			Value _value;
+			size_t _cost;
+			size_t _frequency;
+		};
+
+		typedef beat::list<entry> list_type;
+		typedef typename list_type::iterator position;
+
+	public:
+		typedef Hash hasher;
+
+		explicit lfu_cache(size_t capacity = 0) : base(capacity), _entries(&_pool) {}
+
+		lfu_cache(const lfu_cache&) = delete;
+		lfu_cache& operator=(const lfu_cache&) = delete;
+
+		/**
+		 * @brief Look up key and count one more use.
+		 * @return The cached value, or nullptr on a miss. Valid until the next put or erase.
+		 */
+		Value* get(const Key& key) {
+			auto it = _index.find(key);
+			if (it == _index.end()) {
+				this->_misses++;
+				return nullptr;
+			}
+			this->_hits++;
+			promote(it->second);
+			return &(*it->second)._value;
+		}
+
+		Value* peek(const Key& key) {
+			auto it = _index.find(key);
+			return it == _index.end() ? nullptr : &(*it->second)._value;
+		}
+
+		bool contains(const Key& key) const {
+			return _index.contains(key);
+		}
+
+		/**
+		 * @brief Insert or replace key, then evict least frequently used entries until the cost fits.
+		 *
+		 * Replacing a value counts as a use. A new entry starts with a count of
+		 * one. Neither a new nor a replaced entry is evicted to make room for itself.
+		 * @return false, caching nothing, if cost alone exceeds the capacity.
+		 */
+		bool put(const Key& key, Value value, size_t cost = 1) {
+			if (cost > this->_capacity) {
+				erase(key);
+				return false;
+			}
+			auto it = _index.find(key);
+			if (it != _index.end()) {
+				entry& cached = *it->second;
+				cached._value = std::move(value);
+				this->_cost += cost - cached._cost;
+				cached._cost = cost;
+				promote(it->second);
+				// The updated entry fits on its own, so it is never its own victim either
+				shrink_to_capacity(it->second);
+				return true;
+			}
+			// Make room first, so the newcomer is not its own victim
+			this->_cost += cost;
+			shrink_to_capacity();
+			auto tail = _tails.find(size_t(1));
+			position where = tail == _tails.end() ? _entries.begin() : next_of(tail->second);
+			position inserted = _entries.insert(where, entry{key, std::move(value), cost, 1});
+			_tails.insert_or_assign(size_t(1), inserted);
+			_index.try_emplace(key, inserted);
+			return true;
+		}
+
+		size_t erase(const Key& key) {
+			auto it = _index.find(key);
+			if (it == _index.end()) {
+				return 0;
+			}
+			this->_cost -= (*it->second)._cost;
+			unlink(it->second);
+			_index.erase(it);
+			return 1;
+		}
+
+		void clear() {
+			_entries.clear();
+			_index.clear();
+			_tails.clear();
+			this->_cost = 0;
+		}
+
+		void set_capacity(size_t capacity) {
+			this->_capacity = capacity;
+			shrink_to_capacity();
+		}
+
+		size_t size() const { return _index.size(); }
+
+		bool empty() const { return _index.empty(); }
+
+		/**
+		 * @brief Use count of key, 0 if absent.
+		 */
+		size_t frequency(const Key& key) {
+			auto it = _index.find(key);
+			return it == _index.end() ? 0 : (*it->second)._frequency;
+		}
+
+	private:
+		static position next_of(position pos) {
+			return ++pos;
+		}
+
+		// Forget pos as the tail of its count's run
+		void leave_run(position pos) {
+			size_t frequency = (*pos)._frequency;
+			auto tail = _tails.find(frequency);
+			if (tail->second != pos) {
+				return;
+			}
+			position prev = pos;
+			if (pos != _entries.begin() && (*--prev)._frequency == frequency) {
+				tail->second = prev;
+			}
+			else {
+				_tails.erase(tail);
+			}
+		}
+
+		void promote(position pos) {
+			entry& cached = *pos;
+			size_t frequency = cached._frequency;
+			// Join the end of the next run, or start it right after the current run
+			auto next_tail = _tails.find(frequency + 1);
+			position after = next_tail != _tails.end() ? next_tail->second : _tails.find(frequency)->second;
+			leave_run(pos);
+			if (after != pos) {
+				_entries.splice(next_of(after), _entries, pos);
+			}
+			cached._frequency = frequency + 1;
+			_tails.insert_or_assign(frequency + 1, pos);
+		}
+
+		void unlink(position pos) {
+			leave_run(pos);
+			_entries.erase(pos);
+		}
+
+		// Evict from the least used end, skipping keep
+		void shrink_to_capacity(position keep) {
+			position next = _entries.begin();
+			while (this->_cost > this->_capacity && next != _entries.end()) {
+				if (next == keep) {
+					++next;
+					continue;
+				}
+				position first = next++;
+				entry& victim = *first;
+				if (this->_on_evict) {
+					this->_on_evict(victim._key, victim._value);
+				}
+				this->_evictions++;
+				this->_cost -= victim._cost;
+				_index.erase(victim._key);
+				unlink(first);
+			}
+		}
+
+		void shrink_to_capacity() {
+			shrink_to_capacity(_entries.end());
+		}
+
+		pool_resource _pool;
+		list_type _entries;                           /**< Ascending use count, oldest first within a count */
+		hash_map<Key, position, Hash, KeyEqual> _index;
+		hash_map<size_t, position> _tails;            /**< Last entry of each use count */
+	};
+
+	/**
+	 * @brief Thread-safe cache split into Shards independent caches, each behind its own mutex.
+	 *
+	 * A key always maps to the same shard, so threads working on different
+	 * keys rarely contend. Capacity is divided evenly, which makes eviction
+	 * per shard rather than global. Values are copied out, since a pointer
+	 * into a shard would outlive its lock.
+	 * @tparam Cache lru_cache or lfu_cache.
+	 * @tparam Shards Number of shards, a power of two.
+	 */
+	template<class Cache, size_t Shards = 16>
+	class sharded_cache {
+		static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+	public:
+		typedef typename Cache::key_type key_type;
+		typedef typename Cache::mapped_type mapped_type;
+
+		explicit sharded_cache(size_t capacity) : _shards(new shard[Shards]) {
+			for (size_t index = 0; index < Shards; index++) {
+				_shards[index]._cache.set_capacity((capacity + Shards - 1) / Shards);
+			}
+		}
+
+		/**
+		 * @brief Copy the value for key into out.
+		 * @return Whether key was cached.
+		 */
+		bool get(const key_type& key, mapped_type& out) {
+			shard& s = shard_for(key);
+			std::lock_guard<std::mutex> guard(s._lock);
+			const mapped_type* value = s._cache.get(key);
+			if (value == nullptr) {
+				return false;
+			}
+			out = *value;
+			return true;
+		}
+
+		bool put(const key_type& key, mapped_type value, size_t cost = 1) {
+			shard& s = shard_for(key);
+			std::lock_guard<std::mutex> guard(s._lock);
+			return s._cache.put(key, std::move(value), cost);
+		}
+
+		size_t erase(const key_type& key) {
+			shard& s = shard_for(key);
+			std::lock_guard<std::mutex> guard(s._lock);
+			return s._cache.erase(key);
+		}
+
+		/**
+		 * @brief Set the callback of every shard; it runs with that shard locked.
+		 */
+		void set_eviction_callback(typename Cache::eviction_callback callback) {
+			for (size_t index = 0; index < Shards; index++) {
+				std::lock_guard<std::mutex> guard(_shards[index]._lock);
+				_shards[index]._cache.set_eviction_callback(callback);
+			}
+		}
+
+		size_t size() const { return sum(&Cache::size); }
+
+		size_t hits() const { return sum(&Cache::hits); }
+
+		size_t misses() const { return sum(&Cache::misses); }
+
+		size_t evictions() const { return sum(&Cache::evictions); }
+
+	private:
+		// Each shard on its own cache lines, so neighbouring locks do not false-share
+		struct alignas(64) shard {
+			mutable std::mutex _lock;
+			Cache _cache;
+		};
+
+		shard& shard_for(const key_type& key) {
+			uint64_t h = static_cast<uint64_t>(typename Cache::hasher()(key));
+			// Top bits of a multiplicative hash, so weak hashes such as identity still spread
+			return _shards[Shards == 1 ? 0 : (h * 0x9E3779B97F4A7C15ull) >> (64 - shard_bits())];
+		}
+
+		static constexpr unsigned shard_bits() {
+			unsigned bits = 0;
+			while ((size_t(1) << bits) < Shards) {
+				bits++;
+			}
+			return bits;
+		}
+
+		template<class Getter>
+		size_t sum(Getter getter) const {
+			size_t total = 0;
+			for (size_t index = 0; index < Shards; index++) {
+				std::lock_guard<std::mutex> guard(_shards[index]._lock);
+				total += (_shards[index]._cache.*getter)();
+			}
+			return total;
+		}
+
+		std::unique_ptr<shard[]> _shards;
+	};
+
+}
@@ -0,0 +1,269 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "cache.h"
+#include "../vector/myVector.h"
+#include "../string/myString.h"
+
+void test_lru_cache() {
+    using namespace Somn;
+
+    lru_cache<int, int> cache(3);
+    size_t evicted_sum = 0;
+    cache.set_eviction_callback([&](const int& key, int&) { evicted_sum += key; });
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    cache.get(1);                       // 1 is now the most recent, 2 the least
+    cache.put(4, 40);                   // Evicts 2
+    std::cout << "lru: has 2 " << cache.contains(2) << ", get(1) " << *cache.get(1) << ", get(2) " << (cache.get(2) == nullptr)
+              << ", hits " << cache.hits() << ", misses " << cache.misses() << ", evicted " << evicted_sum << std::endl;
+
+    // Byte budget: costs are sizes, one large value pushes out several small ones
+    lru_cache<cocoon::myString, cocoon::myString> pages(100);
+    for (int i = 0; i < 5; ++i) {
+        cocoon::myString key("page");
+        key.append_int(i);
+        pages.put(key, cocoon::myString("0123456789"), 20);
+    }
+    pages.put(cocoon::myString("big"), cocoon::myString("large"), 70);
+    bool too_big = pages.put(cocoon::myString("huge"), cocoon::myString("x"), 101);
+    std::cout << "byte budget: size " << pages.size() << ", cost " << pages.cost() << ", page4 " << pages.contains(cocoon::myString("page4"))
+              << ", page2 " << pages.contains(cocoon::myString("page2")) << ", huge accepted " << too_big << std::endl;
+}
+
+void test_lfu_cache() {
+    using namespace Somn;
+
+    lfu_cache<int, int> cache(3);
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    cache.get(1);
+    cache.get(1);
+    cache.get(2);
+    cache.put(4, 40);                   // 3 has the lowest count
+    cache.put(5, 50);                   // 4 has count 1, as 5 will; 4 is older
+    std::cout << "lfu: has 3 " << cache.contains(3) << ", has 4 " << cache.contains(4) << ", freq(1) " << cache.frequency(1)
+              << ", freq(2) " << cache.frequency(2) << ", freq(5) " << cache.frequency(5) << ", size " << cache.size() << std::endl;
+
+    // Replacing a value with a larger cost evicts others, never the replaced entry itself
+    lfu_cache<int, int> costly(10);
+    costly.put(1, 1, 5);
+    for (int i = 0; i < 4; ++i) {
+        costly.get(1);
+    }
+    costly.put(2, 2, 1);
+    bool replaced = costly.put(2, 3, 6);
+    std::cout << "lfu replace with cost 6: put " << replaced << ", has 2 " << costly.contains(2) << ", has 1 "
+              << costly.contains(1) << ", size " << costly.size() << std::endl;
+
+    // Random operations with random costs against a brute-force LFU with the same tie-break
+    const size_t capacity = 100;
+    lfu_cache<int, int> fast(capacity);
+    struct slow_entry {
+        size_t count;
+        size_t time;    // last time the count changed
+        size_t cost;
+    };
+    std::unordered_map<int, slow_entry> slow;
+    size_t slow_cost = 0;
+    auto evict_except = [&slow, &slow_cost, capacity](int keep, size_t incoming) {
+        while (slow_cost + incoming > capacity) {
+            auto victim = slow.end();
+            for (auto cur = slow.begin(); cur != slow.end(); ++cur) {
+                if (cur->first != keep && (victim == slow.end() || cur->second.count < victim->second.count
+                                           || (cur->second.count == victim->second.count && cur->second.time < victim->second.time))) {
+                    victim = cur;
+                }
+            }
+            slow_cost -= victim->second.cost;
+            slow.erase(victim);
+        }
+    };
+    std::mt19937 gen(21);
+    size_t mismatches = 0, clock = 0;
+    for (int i = 0; i < 200000; ++i) {
+        int key = static_cast<int>(gen() % 200);
+        ++clock;
+        if (gen() % 2) {
+            bool hit = fast.get(key) != nullptr;
+            auto it = slow.find(key);
+            mismatches += hit != (it != slow.end());
+            if (it != slow.end()) {
+                it->second.count++;
+                it->second.time = clock;
+            }
+        }
+        else {
+            size_t cost = gen() % 8 + 1;
+            auto it = slow.find(key);
+            if (it != slow.end()) {
+                slow_cost += cost - it->second.cost;
+                it->second = {it->second.count + 1, clock, cost};
+                evict_except(key, 0);
+            }
+            else {
+                evict_except(key, cost);
+                slow[key] = {1, clock, cost};
+                slow_cost += cost;
+            }
+            bool cached = fast.put(key, i, cost);
+            mismatches += !cached || !fast.contains(key);
+        }
+    }
+    for (const auto& entry : slow) {
+        mismatches += fast.frequency(entry.first) != entry.second.count;
+    }
+    std::cout << "lfu random ops: size " << fast.size() << "/" << slow.size() << ", mismatches " << mismatches << std::endl;
+}
+
+void test_sharded_cache() {
+    Somn::sharded_cache<Somn::lru_cache<int, int>, 4> cache(400);
+    std::thread workers[4];
+    for (int t = 0; t < 4; ++t) {
+        workers[t] = std::thread([&cache, t] {
+            for (int i = 0; i < 10000; ++i) {
+                int key = (i * 7 + t) % 300;
+                int value;
+                if (!cache.get(key, value)) {
+                    cache.put(key, key * 2);
+                }
+                else if (value != key * 2) {
+                    std::cout << "bad value" << std::endl;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::cout << "sharded: size " << cache.size() << ", hits + misses " << cache.hits() + cache.misses() << std::endl;
+}
+
+// Zipf(s) over keys [0, n): precomputed CDF, sampled by binary search
+Somn::myVector<unsigned long long> zipf_keys(size_t n, double s, size_t count, unsigned seed) {
+    Somn::myVector<double> cdf;
+    cdf.reserve(n);
+    double total = 0;
+    for (size_t k = 1; k <= n; ++k) {
+        total += 1.0 / std::pow(static_cast<double>(k), s);
+        cdf.push_back(total);
+    }
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> uniform(0, total);
+    Somn::myVector<unsigned long long> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double u = uniform(gen);
+        size_t low = 0, high = n - 1;
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (cdf[mid] < u) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        // Scatter the ranks so hot keys are not numerically adjacent
+        keys.push_back(low * 0x9E3779B97F4A7C15ull);
+    }
+    return keys;
+}
+
+// The hand-written version this component replaces: std::list plus an unordered_map of iterators
+class manual_lru {
+public:
+    explicit manual_lru(size_t capacity) : _capacity(capacity) {}
+
+    long long* get(unsigned long long key) {
+        auto it = _index.find(key);
+        if (it == _index.end()) {
+            return nullptr;
+        }
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return &it->second->second;
+    }
+
+    void put(unsigned long long key, long long value) {
+        _entries.emplace_front(key, value);
+        _index[key] = _entries.begin();
+        if (_entries.size() > _capacity) {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+    }
+
+private:
+    size_t _capacity;
+    std::list<std::pair<unsigned long long, long long>> _entries;
+    std::unordered_map<unsigned long long, std::list<std::pair<unsigned long long, long long>>::iterator> _index;
+};
+
+template<class Cache>
+void bench_cache(const char* name, const Somn::myVector<unsigned long long>& keys, size_t capacity) {
+    typedef std::chrono::steady_clock clock;
+    auto start = clock::now();
+    Cache cache(capacity);
+    size_t hits = 0;
+    for (unsigned long long key : keys) {
+        if (cache.get(key)) {
+            ++hits;
+        }
+        else {
+            cache.put(key, static_cast<long long>(key));
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << name << ": " << ms << " ms, hit ratio " << static_cast<double>(hits) / keys.size() << std::endl;
+}
+
+template<class Cache>
+void bench_threads(const char* name, const Somn::myVector<unsigned long long>& keys, size_t capacity, int threads) {
+    typedef std::chrono::steady_clock clock;
+    Cache cache(capacity);
+    auto start = clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, &keys, t, threads] {
+            long long value;
+            for (size_t i = t; i < keys.size(); i += threads) {
+                if (!cache.get(keys[i], value)) {
+                    cache.put(keys[i], static_cast<long long>(keys[i]));
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << name << ": " << ms << " ms, hit ratio " << static_cast<double>(cache.hits()) / keys.size() << std::endl;
+}
+
+void bench_zipf() {
+    const size_t universe = 1000000, requests = 5000000, capacity = 50000;
+    Somn::myVector<unsigned long long> keys = zipf_keys(universe, 0.99, requests, 7);
+    std::cout << requests << " Zipf(0.99) requests over " << universe << " keys, capacity " << capacity << std::endl;
+    bench_cache<Somn::lru_cache<unsigned long long, long long>>("  Somn::lru_cache        ", keys, capacity);
+    bench_cache<Somn::lfu_cache<unsigned long long, long long>>("  Somn::lfu_cache        ", keys, capacity);
+    bench_cache<manual_lru>("  std::list + unordered_map", keys, capacity);
+
+    // One shard is the same cache behind a single mutex
+    bench_threads<Somn::sharded_cache<Somn::lru_cache<unsigned long long, long long>, 1>>("  1 lock, 4 threads      ", keys, capacity, 4);
+    bench_threads<Somn::sharded_cache<Somn::lru_cache<unsigned long long, long long>, 16>>("  16 shards, 4 threads   ", keys, capacity, 4);
+}
+
+int main() {
+    test_lru_cache();
+    test_lfu_cache();
+    test_sharded_cache();
+    bench_zipf();
+    return 0;
+}
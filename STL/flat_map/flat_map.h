@@ -0,0 +1,677 @@
+/**
+ * @file flat_map.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{flat_map}
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "../vector/myVector.h"
+#include "../algorithm/sort.h"
+
+namespace Somn {
+
+	/**
+	 * @brief Storage order of a flat_map or flat_set.
+	 */
+	enum class flat_layout {
+		sorted,     /**< Keys in ascending order; branchless binary search */
+		eytzinger   /**< Keys in the breadth-first order of a complete binary search tree */
+	};
+
+	namespace detail {
+		/**
+		 * @brief Sorted keys shared by flat_map and flat_set: lookup, in-order traversal and batch merging.
+		 *
+		 * Keys live in their own myVector, so a lookup only touches keys. In
+		 * the sorted layout, position i is the i-th smallest key. In the
+		 * Eytzinger layout, position 1 is the root and positions 2k and 2k + 1
+		 * are the children of k (slot 0 is unused): the first levels of every
+		 * search share a few cache lines and the next ones can be prefetched,
+		 * which pays off once the table no longer fits in cache. Iteration is
+		 * in key order for both layouts.
+		 *
+		 * Built for read-mostly use: single insertions and erasures are O(n)
+		 * (and rebuild the tree in the Eytzinger layout), so changes should be
+		 * batched through insert(first, last) or insert_sorted().
+		 */
+		template<class Key, class Compare, flat_layout Layout>
+		class flat_keys {
+		protected:
+			static constexpr bool eytzinger = Layout == flat_layout::eytzinger;
+			static constexpr size_t first_slot = eytzinger ? 1 : 0;
+
+		public:
+			typedef Key key_type;
+			typedef Compare key_compare;
+
+			/** Returned by index_of when a key is absent. */
+			static constexpr size_t npos = static_cast<size_t>(-1);
+
+			size_t size() const { return _keys.size() - first_slot; }
+
+			bool empty() const { return size() == 0; }
+
+			key_compare key_comp() const { return _comp; }
+
+			/**
+			 * @brief Storage position of key, or npos.
+			 */
+			size_t index_of(const Key& key) const {
+				size_t pos = lower_bound_slot(key);
+				return pos != end_slot() && !_comp(key, _keys[pos]) ? pos : npos;
+			}
+
+			bool contains(const Key& key) const { return index_of(key) != npos; }
+
+			size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+			/**
+			 * @brief Keys in storage order: ascending, or tree order for the Eytzinger layout (from index 1).
+			 */
+			const myVector<Key>& keys() const { return _keys; }
+
+		protected:
+			explicit flat_keys(const Compare& comp) : _comp(comp) {}
+
+			// Position one past the last key in iteration order
+			size_t end_slot() const { return eytzinger ? 0 : _keys.size(); }
+
+			size_t begin_slot() const { return eytzinger ? first_tree_slot(size()) : 0; }
+
+			size_t next_slot(size_t k) const { return eytzinger ? next_tree_slot(k, size()) : k + 1; }
+
+			// Leftmost slot of an n-node tree, 0 when empty
+			static size_t first_tree_slot(size_t n) {
+				size_t k = 1;
+				if (n == 0) {
+					return 0;
+				}
+				while (2 * k <= n) {
+					k *= 2;
+				}
+				return k;
+			}
+
+			// In-order successor of slot k in an n-node tree
+			static size_t next_tree_slot(size_t k, size_t n) {
+				if (2 * k + 1 <= n) {
+					// Leftmost node of the right subtree
+					k = 2 * k + 1;
+					while (2 * k <= n) {
+						k *= 2;
+					}
+					return k;
+				}
+				// Climb while k is a right child, then once more; past the maximum this gives 0
+				return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+			}
+
+			/**
+			 * @brief Slot of the first key not less than key, or end_slot().
+			 */
+			size_t lower_bound_slot(const Key& key) const {
+				if (eytzinger) {
+					const Key* tree = _keys.begin();
+					size_t n = size(), k = 1;
+					// A cache line of keys 4 levels down: the grandchildren's grandchildren of k
+					constexpr size_t ahead = 64 / sizeof(Key) > 1 ? 64 / sizeof(Key) : 1;
+					while (k <= n) {
+						__builtin_prefetch(tree + k * ahead);
+						k = 2 * k + _comp(tree[k], key);
+					}
+					// Undo the right turns taken after the last left turn
+					return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+				}
+				const Key* base = _keys.begin();
+				size_t n = _keys.size();
+				if (n == 0) {
+					return 0;
+				}
+				// Halve the range by arithmetic on the comparison result rather than a branch,
+				// prefetching the midpoints of both possible next halves
+				while (n > 1) {
+					size_t half = n / 2;
+					__builtin_prefetch(base + half / 2 - 1);
+					__builtin_prefetch(base + half + half / 2 - 1);
+					base += static_cast<size_t>(_comp(base[half - 1], key)) * half;
+					n -= half;
+				}
+				return static_cast<size_t>(base - _keys.begin()) + _comp(*base, key);
+			}
+
+			// Number of keys less than key in sorted keys
+			size_t rank_of(const myVector<Key>& keys, const Key& key) const {
+				size_t rank = 0;
+				while (_comp(keys[rank], key)) {
+					rank++;
+				}
+				return rank;
+			}
+
+			/**
+			 * @brief Walk two sorted, unique key runs in merged order: take(true, i) for old_keys[i],
+			 * take(false, j) for keys[j]; on equal keys only the old one is taken.
+			 */
+			template<class Take>
+			void merge_keys(const myVector<Key>& old_keys, const myVector<Key>& keys, Take take) const {
+				size_t i = 0, j = 0;
+				while (i < old_keys.size() || j < keys.size()) {
+					if (j == keys.size() || (i < old_keys.size() && !_comp(keys[j], old_keys[i]))) {
+						if (j < keys.size() && !_comp(old_keys[i], keys[j])) {
+							j++;   // Same key in the batch: keep the existing entry
+						}
+						take(true, i++);
+					}
+					else {
+						take(false, j++);
+					}
+				}
+			}
+
+			// Sort entries by key and keep the first of each run of equal keys
+			template<class Entry, class KeyOf>
+			void sort_unique(myVector<Entry>& entries, KeyOf key_of) {
+				Compare& comp = _comp;
+				Somn::stable_sort(entries.begin(), entries.end(), [&comp, key_of](const Entry& l, const Entry& r) {
+					return comp(key_of(l), key_of(r));
+				});
+				size_t kept = 0;
+				for (size_t index = 0; index < entries.size(); index++) {
+					if (kept == 0 || _comp(key_of(entries[kept - 1]), key_of(entries[index]))) {
+						entries[kept++] = entries[index];
+					}
+				}
+				entries.resize(kept);
+			}
+
+			myVector<Key> _keys;                /**< Keys in storage order */
+			mutable Compare _comp;              /**< moon::less and moon::greater have non-const operator() */
+		};
+
+		/**
+		 * @brief flat_keys plus a parallel myVector of mapped values, for flat_map.
+		 */
+		template<class Key, class T, class Compare, flat_layout Layout>
+		class flat_table : public flat_keys<Key, Compare, Layout> {
+			typedef flat_keys<Key, Compare, Layout> base;
+
+		public:
+			flat_table() : flat_table(Compare()) {}
+
+			explicit flat_table(const Compare& comp) : base(comp) {
+				clear();
+			}
+
+			void clear() {
+				this->_keys.clear();
+				_values.clear();
+				if (base::eytzinger) {
+					this->_keys.push_back(Key());
+					_values.push_back(T());
+				}
+			}
+
+			void reserve(size_t n) {
+				this->_keys.reserve(n + base::first_slot);
+				_values.reserve(n + base::first_slot);
+			}
+
+			/**
+			 * @brief Erase key in O(n).
+			 * @return The number of entries removed (0 or 1).
+			 */
+			size_t erase(const Key& key) {
+				size_t pos = this->index_of(key);
+				if (pos == base::npos) {
+					return 0;
+				}
+				if (!base::eytzinger) {
+					this->_keys.erase(this->_keys.begin() + pos);
+					_values.erase(_values.begin() + pos);
+					return 1;
+				}
+				myVector<Key> keys;
+				myVector<T> values;
+				extract_sorted(keys, values);
+				size_t rank = this->rank_of(keys, key);
+				keys.erase(keys.begin() + rank);
+				values.erase(values.begin() + rank);
+				assign_sorted(keys, values);
+				return 1;
+			}
+
+		protected:
+			// Copy the entries out in key order
+			void extract_sorted(myVector<Key>& keys, myVector<T>& values) const {
+				keys.reserve(this->size());
+				values.reserve(this->size());
+				for (size_t k = this->begin_slot(); k != this->end_slot(); k = this->next_slot(k)) {
+					keys.push_back(this->_keys[k]);
+					values.push_back(_values[k]);
+				}
+			}
+
+			// Replace the contents with sorted, unique entries
+			void assign_sorted(myVector<Key>& keys, myVector<T>& values) {
+				if (!base::eytzinger) {
+					this->_keys.swap(keys);
+					_values.swap(values);
+					return;
+				}
+				// An in-order walk of the implicit tree assigns the sorted entries to their slots
+				size_t n = keys.size();
+				myVector<Key> tree(n + 1);
+				myVector<T> tree_values(n + 1);
+				size_t rank = 0;
+				for (size_t k = base::first_tree_slot(n); k != 0; k = base::next_tree_slot(k, n)) {
+					tree[k] = keys[rank];
+					tree_values[k] = values[rank];
+					rank++;
+				}
+				this->_keys.swap(tree);
+				_values.swap(tree_values);
+			}
+
+			/**
+			 * @brief Merge sorted, unique entries in O(n + k); on equal keys the existing entry wins.
+			 */
+			void merge_sorted(myVector<Key>& keys, myVector<T>& values) {
+				myVector<Key> old_keys;
+				myVector<T> old_values;
+				if (base::eytzinger) {
+					extract_sorted(old_keys, old_values);
+				}
+				else {
+					old_keys.swap(this->_keys);
+					old_values.swap(_values);
+				}
+				myVector<Key> merged_keys;
+				myVector<T> merged_values;
+				merged_keys.reserve(old_keys.size() + keys.size());
+				merged_values.reserve(old_keys.size() + keys.size());
+				this->merge_keys(old_keys, keys, [&](bool old, size_t index) {
+					merged_keys.push_back(old ? old_keys[index] : keys[index]);
+					merged_values.push_back(old ? old_values[index] : values[index]);
+				});
+				assign_sorted(merged_keys, merged_values);
+			}
+
+			myVector<T> _values;    /**< Values, parallel to _keys */
+		};
+
+		/**
+		 * @brief Keys only, for flat_set.
+		 */
+		template<class Key, class Compare, flat_layout Layout>
+		class flat_table<Key, void, Compare, Layout> : public flat_keys<Key, Compare, Layout> {
+			typedef flat_keys<Key, Compare, Layout> base;
+
+		public:
+			flat_table() : flat_table(Compare()) {}
+
+			explicit flat_table(const Compare& comp) : base(comp) {
+				clear();
+			}
+
+			void clear() {
+				this->_keys.clear();
+				if (base::eytzinger) {
+					this->_keys.push_back(Key());
+				}
+			}
+
+			void reserve(size_t n) { this->_keys.reserve(n + base::first_slot); }
+
+			/**
+			 * @brief Erase key in O(n).
+			 * @return The number of entries removed (0 or 1).
+			 */
+			size_t erase(const Key& key) {
+				size_t pos = this->index_of(key);
+				if (pos == base::npos) {
+					return 0;
+				}
+				if (!base::eytzinger) {
+					this->_keys.erase(this->_keys.begin() + pos);
+					return 1;
+				}
+				myVector<Key> keys;
+				extract_sorted(keys);
+				keys.erase(keys.begin() + this->rank_of(keys, key));
+				assign_sorted(keys);
+				return 1;
+			}
+
+		protected:
+			void extract_sorted(myVector<Key>& keys) const {
+				keys.reserve(this->size());
+				for (size_t k = this->begin_slot(); k != this->end_slot(); k = this->next_slot(k)) {
+					keys.push_back(this->_keys[k]);
+				}
+			}
+
+			void assign_sorted(myVector<Key>& keys) {
+				if (!base::eytzinger) {
+					this->_keys.swap(keys);
+					return;
+				}
+				size_t n = keys.size();
+				myVector<Key> tree(n + 1);
+				size_t rank = 0;
+				for (size_t k = base::first_tree_slot(n); k != 0; k = base::next_tree_slot(k, n)) {
+					tree[k] = keys[rank++];
+				}
+				this->_keys.swap(tree);
+			}
+
+			void merge_sorted(myVector<Key>& keys) {
+				myVector<Key> old_keys;
+				if (base::eytzinger) {
+					extract_sorted(old_keys);
+				}
+				else {
+					old_keys.swap(this->_keys);
+				}
+				myVector<Key> merged;
+				merged.reserve(old_keys.size() + keys.size());
+				this->merge_keys(old_keys, keys, [&](bool old, size_t index) {
+					merged.push_back(old ? old_keys[index] : keys[index]);
+				});
+				assign_sorted(merged);
+			}
+		};
+
+		/**
+		 * @brief operator-> result for iterators whose reference is a proxy pair of references.
+		 */
+		template<class Reference>
+		struct flat_arrow {
+			Reference _ref;
+			const Reference* operator->() const { return &_ref; }
+		};
+
+		/**
+		 * @brief Iterator in key order over a flat table; Table may be const.
+		 */
+		template<class Table, class Reference>
+		class flat_iterator {
+			static constexpr bool proxy = !std::is_lvalue_reference<Reference>::value;
+
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef std::remove_cv_t<std::remove_reference_t<Reference>> value_type;
+			typedef ptrdiff_t difference_type;
+			/** A real pointer for flat_set; a proxy holding the pair of references for flat_map. */
+			typedef std::conditional_t<proxy, flat_arrow<Reference>, std::add_pointer_t<Reference>> pointer;
+			typedef Reference reference;
+
+			flat_iterator(Table* table, size_t slot) : _table(table), _slot(slot) {}
+
+			Reference operator*() const { return _table->entry(_slot); }
+
+			pointer operator->() const {
+				if constexpr (proxy) {
+					return pointer{**this};
+				}
+				else {
+					return &_table->entry(_slot);
+				}
+			}
+
+			flat_iterator& operator++() {
+				_slot = _table->next_slot(_slot);
+				return *this;
+			}
+
+			flat_iterator operator++(int) {
+				flat_iterator temp(*this);
+				++*this;
+				return temp;
+			}
+
+			bool operator==(const flat_iterator& it) const { return _slot == it._slot; }
+
+			bool operator!=(const flat_iterator& it) const { return _slot != it._slot; }
+
+			/** Storage position, as used by index_of. */
+			size_t slot() const { return _slot; }
+
+		private:
+			Table* _table;
+			size_t _slot;
+		};
+	}
+
+	/**
+	 * @brief Sorted associative array on two myVectors, one for keys and one for values.
+	 * @tparam Key The key type; must be default constructible and copyable.
+	 * @tparam T The mapped type; must be default constructible and copyable.
+	 * @tparam Compare Strict weak ordering, e.g. std::less, moon::less or moon::greater.
+	 * @tparam Layout flat_layout::sorted, or flat_layout::eytzinger for lookup-heavy tables.
+	 */
+	template<class Key, class T, class Compare = std::less<Key>, flat_layout Layout = flat_layout::sorted>
+	class flat_map : public detail::flat_table<Key, T, Compare, Layout> {
+		typedef detail::flat_table<Key, T, Compare, Layout> base;
+		template<class, class> friend class detail::flat_iterator;
+
+	public:
+		typedef T mapped_type;
+		typedef std::pair<const Key&, T&> reference;
+		typedef std::pair<const Key&, const T&> const_reference;
+		typedef detail::flat_iterator<flat_map, reference> iterator;
+		typedef detail::flat_iterator<const flat_map, const_reference> const_iterator;
+
+		using base::base;
+
+		flat_map() = default;
+
+		/**
+		 * @brief Build from unsorted (key, value) pairs: one sort, then duplicates dropped (the first wins).
+		 */
+		template<class InputIt>
+		flat_map(InputIt first, InputIt last, const Compare& comp = Compare()) : base(comp) {
+			insert(first, last);
+		}
+
+		iterator begin() { return iterator(this, this->begin_slot()); }
+
+		iterator end() { return iterator(this, this->end_slot()); }
+
+		const_iterator begin() const { return const_iterator(this, this->begin_slot()); }
+
+		const_iterator end() const { return const_iterator(this, this->end_slot()); }
+
+		iterator find(const Key& key) {
+			size_t pos = this->index_of(key);
+			return pos == base::npos ? end() : iterator(this, pos);
+		}
+
+		const_iterator find(const Key& key) const {
+			size_t pos = this->index_of(key);
+			return pos == base::npos ? end() : const_iterator(this, pos);
+		}
+
+		/**
+		 * @brief First entry whose key is not less than key.
+		 */
+		iterator lower_bound(const Key& key) { return iterator(this, this->lower_bound_slot(key)); }
+
+		const_iterator lower_bound(const Key& key) const { return const_iterator(this, this->lower_bound_slot(key)); }
+
+		/**
+		 * @brief Pointer to the value for key, or nullptr.
+		 */
+		T* get(const Key& key) {
+			size_t pos = this->index_of(key);
+			return pos == base::npos ? nullptr : &this->_values[pos];
+		}
+
+		const T* get(const Key& key) const {
+			return const_cast<flat_map*>(this)->get(key);
+		}
+
+		/**
+		 * @throws std::out_of_range when key is absent.
+		 */
+		T& at(const Key& key) {
+			T* value = get(key);
+			if (value == nullptr) {
+				throw std::out_of_range("flat_map::at: key not found");
+			}
+			return *value;
+		}
+
+		const T& at(const Key& key) const {
+			return const_cast<flat_map*>(this)->at(key);
+		}
+
+		/**
+		 * @brief Values in storage order, parallel to keys().
+		 */
+		const myVector<T>& values() const { return this->_values; }
+
+		/**
+		 * @brief Insert one entry in O(n) unless key is present.
+		 */
+		bool insert(const Key& key, const T& value) {
+			if (this->contains(key)) {
+				return false;
+			}
+			myVector<Key> keys;
+			myVector<T> values;
+			keys.push_back(key);
+			values.push_back(value);
+			this->merge_sorted(keys, values);
+			return true;
+		}
+
+		/**
+		 * @brief Insert a batch of unsorted (key, value) pairs: O(k log k) to sort it, O(n + k) to merge.
+		 *
+		 * Keys already present, and repeats within the batch after the first, are ignored.
+		 */
+		template<class InputIt>
+		void insert(InputIt first, InputIt last) {
+			myVector<std::pair<Key, T>> batch;
+			for (; first != last; ++first) {
+				batch.push_back(std::pair<Key, T>(first->first, first->second));
+			}
+			this->sort_unique(batch, [](const std::pair<Key, T>& entry) -> const Key& { return entry.first; });
+			myVector<Key> keys;
+			myVector<T> values;
+			keys.reserve(batch.size());
+			values.reserve(batch.size());
+			for (size_t index = 0; index < batch.size(); index++) {
+				keys.push_back(batch[index].first);
+				values.push_back(batch[index].second);
+			}
+			this->merge_sorted(keys, values);
+		}
+
+		/**
+		 * @brief Merge a batch already sorted by key and free of duplicates in O(n + k).
+		 */
+		template<class InputIt>
+		void insert_sorted(InputIt first, InputIt last) {
+			myVector<Key> keys;
+			myVector<T> values;
+			for (; first != last; ++first) {
+				assert(keys.empty() || this->_comp(keys[keys.size() - 1], first->first));
+				keys.push_back(first->first);
+				values.push_back(first->second);
+			}
+			this->merge_sorted(keys, values);
+		}
+
+	private:
+		reference entry(size_t slot) { return reference(this->_keys[slot], this->_values[slot]); }
+
+		const_reference entry(size_t slot) const { return const_reference(this->_keys[slot], this->_values[slot]); }
+	};
+
+	/**
+	 * @brief Sorted set on a myVector.
+	 * @tparam Key The value type; must be default constructible and copyable.
+	 * @tparam Compare Strict weak ordering, e.g. std::less, moon::less or moon::greater.
+	 * @tparam Layout flat_layout::sorted, or flat_layout::eytzinger for lookup-heavy tables.
+	 */
+	template<class Key, class Compare = std::less<Key>, flat_layout Layout = flat_layout::sorted>
+	class flat_set : public detail::flat_table<Key, void, Compare, Layout> {
+		typedef detail::flat_table<Key, void, Compare, Layout> base;
+		template<class, class> friend class detail::flat_iterator;
+
+	public:
+		typedef detail::flat_iterator<const flat_set, const Key&> iterator;
+		typedef iterator const_iterator;
+
+		using base::base;
+
+		flat_set() = default;
+
+		/**
+		 * @brief Build from unsorted values: one sort, then duplicates dropped.
+		 */
+		template<class InputIt>
+		flat_set(InputIt first, InputIt last, const Compare& comp = Compare()) : base(comp) {
+			insert(first, last);
+		}
+
+		iterator begin() const { return iterator(this, this->begin_slot()); }
+
+		iterator end() const { return iterator(this, this->end_slot()); }
+
+		iterator find(const Key& key) const {
+			size_t pos = this->index_of(key);
+			return pos == base::npos ? end() : iterator(this, pos);
+		}
+
+		iterator lower_bound(const Key& key) const { return iterator(this, this->lower_bound_slot(key)); }
+
+		bool insert(const Key& key) {
+			if (this->contains(key)) {
+				return false;
+			}
+			myVector<Key> keys;
+			keys.push_back(key);
+			this->merge_sorted(keys);
+			return true;
+		}
+
+		/**
+		 * @brief Insert a batch of unsorted values: O(k log k) to sort it, O(n + k) to merge.
+		 */
+		template<class InputIt>
+		void insert(InputIt first, InputIt last) {
+			myVector<Key> keys;
+			for (; first != last; ++first) {
+				keys.push_back(*first);
+			}
+			this->sort_unique(keys, [](const Key& key) -> const Key& { return key; });
+			this->merge_sorted(keys);
+		}
+
+		/**
+		 * @brief Merge a batch already sorted and free of duplicates in O(n + k).
+		 */
+		template<class InputIt>
+		void insert_sorted(InputIt first, InputIt last) {
+			myVector<Key> keys;
+			for (; first != last; ++first) {
+				assert(keys.empty() || this->_comp(keys[keys.size() - 1], *first));
+				keys.push_back(*first);
+			}
+			this->merge_sorted(keys);
+		}
+
+	private:
+		const Key& entry(size_t slot) const { return this->_keys[slot]; }
+	};
+
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "flat_map.h"
+#include "../vector/myVector.h"
+#include "../priority_queue/priority_queue.h"
+#include "../string/myString.h"
+
+void test_flat_map() {
+    using namespace Somn;
+
+    // Bulk construction from unsorted input with duplicates: the first occurrence wins
+    std::vector<std::pair<int, int>> input = {{5, 50}, {1, 10}, {3, 30}, {5, -1}, {9, 90}, {1, -1}, {7, 70}};
+    flat_map<int, int> map(input.begin(), input.end());
+    std::cout << "size " << map.size() << ", map[5] " << map.at(5) << ", map[1] " << map.at(1) << ", has 4 " << map.contains(4)
+              << ", lower_bound(4) " << map.lower_bound(4)->first << ", lower_bound(10) is end " << (map.lower_bound(10) == map.end()) << std::endl;
+
+    // Batched insert: existing keys are kept, new ones merged in
+    std::vector<std::pair<int, int>> batch = {{2, 20}, {3, -1}, {8, 80}, {10, 100}};
+    map.insert_sorted(batch.begin(), batch.end());
+    map.insert(6, 60);
+    map.erase(9);
+    std::cout << "after batch:";
+    for (auto entry : map) {
+        std::cout << " " << entry.first << "=" << entry.second;
+    }
+    std::cout << std::endl;
+
+    // Eytzinger layout iterates in key order as well
+    flat_map<int, int, std::less<int>, flat_layout::eytzinger> tree(input.begin(), input.end());
+    tree.insert_sorted(batch.begin(), batch.end());
+    tree.insert(6, 60);
+    tree.erase(9);
+    tree.at(7) += 1;
+    std::cout << "eytzinger:  ";
+    for (auto entry : tree) {
+        std::cout << " " << entry.first << "=" << entry.second;
+    }
+    std::cout << std::endl;
+
+    // moon::greater for descending order, string values
+    flat_map<int, cocoon::myString, moon::greater<int>> names;
+    const char* words[] = {"pear", "apple", "fig", "kiwi", "plum"};
+    for (int i = 0; i < 5; ++i) {
+        names.insert(i * 3 % 5, cocoon::myString(words[i]));
+    }
+    names.insert(0, cocoon::myString("ignored"));
+    std::cout << "descending:";
+    for (auto entry : names) {
+        std::cout << " " << entry.first << "=" << entry.second;
+    }
+    std::cout << std::endl;
+
+    bool threw = false;
+    try {
+        map.at(42);
+    }
+    catch (const std::out_of_range&) {
+        threw = true;
+    }
+    std::cout << "at(42) throws " << threw << std::endl;
+}
+
+void test_flat_set() {
+    using namespace Somn;
+
+    int values[] = {4, 8, 15, 16, 23, 42, 8, 4};
+    flat_set<int> set(values, values + 8);
+    flat_set<int, std::less<int>, flat_layout::eytzinger> tree(values, values + 8);
+    std::cout << "set:";
+    for (int value : set) {
+        std::cout << " " << value;
+    }
+    std::cout << ", tree:";
+    for (int value : tree) {
+        std::cout << " " << value;
+    }
+    std::cout << ", tree has 15 " << tree.contains(15) << ", tree lower_bound(17) " << *tree.lower_bound(17) << std::endl;
+
+    // operator-> on a set iterator points at the stored key
+    std::pair<int, int> pairs[] = {{3, 30}, {1, 10}, {2, 20}};
+    flat_set<std::pair<int, int>> pair_set(pairs, pairs + 3);
+    flat_set<std::pair<int, int>, std::less<std::pair<int, int>>, flat_layout::eytzinger> pair_tree(pairs, pairs + 3);
+    std::cout << "pair set: begin()->first " << pair_set.begin()->first << ", find({2, 20})->second "
+              << pair_set.find({2, 20})->second << ", tree begin()->second " << pair_tree.begin()->second << std::endl;
+
+    // Random operations against std::map / std::set in both layouts, for every size up to a few levels
+    std::mt19937 gen(44);
+    size_t mismatches = 0;
+    flat_map<int, int> sorted;
+    flat_map<int, int, std::less<int>, flat_layout::eytzinger> eytzinger;
+    flat_set<int, std::less<int>, flat_layout::eytzinger> keys;
+    std::map<int, int> reference;
+    for (int round = 0; round < 2000; ++round) {
+        int op = static_cast<int>(gen() % 4);
+        if (op == 0) {
+            std::vector<std::pair<int, int>> batch;
+            for (int i = static_cast<int>(gen() % 8); i > 0; --i) {
+                batch.emplace_back(static_cast<int>(gen() % 300), round);
+            }
+            sorted.insert(batch.begin(), batch.end());
+            eytzinger.insert(batch.begin(), batch.end());
+            for (auto& entry : batch) {
+                keys.insert(entry.first);
+                reference.insert(entry);
+            }
+        }
+        else if (op == 1) {
+            int key = static_cast<int>(gen() % 300);
+            size_t erased = reference.erase(key);
+            mismatches += sorted.erase(key) != erased;
+            mismatches += eytzinger.erase(key) != erased;
+            keys.erase(key);
+        }
+        else {
+            int key = static_cast<int>(gen() % 310);
+            auto expect = reference.lower_bound(key);
+            auto got = sorted.lower_bound(key);
+            auto got_tree = eytzinger.lower_bound(key);
+            auto got_key = keys.lower_bound(key);
+            if (expect == reference.end()) {
+                mismatches += got != sorted.end();
+                mismatches += got_tree != eytzinger.end();
+                mismatches += got_key != keys.end();
+            }
+            else {
+                mismatches += got == sorted.end() || got->first != expect->first || got->second != expect->second;
+                mismatches += got_tree == eytzinger.end() || got_tree->first != expect->first || got_tree->second != expect->second;
+                mismatches += got_key == keys.end() || *got_key != expect->first;
+            }
+        }
+        mismatches += sorted.size() != reference.size() || eytzinger.size() != reference.size() || keys.size() != reference.size();
+    }
+    auto expect = reference.begin();
+    for (auto entry : eytzinger) {
+        mismatches += entry.first != expect->first;
+        ++expect;
+    }
+    std::cout << "random ops: size " << sorted.size() << ", mismatches " << mismatches << std::endl;
+}
+
+template<class Lookup>
+void bench_lookup(const char* name, const std::vector<unsigned>& queries, Lookup lookup) {
+    typedef std::chrono::steady_clock clock;
+    auto start = clock::now();
+    size_t found = 0;
+    for (unsigned query : queries) {
+        found += lookup(query);
+    }
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << name << ": " << ms << " ms, found " << found << std::endl;
+}
+
+void bench_flat_map() {
+    typedef std::chrono::steady_clock clock;
+    const size_t queries_count = 5000000;
+    std::mt19937 gen(2024);
+    for (size_t n : {size_t(10000), size_t(1000000), size_t(8000000)}) {
+        std::vector<std::pair<unsigned, unsigned>> input(n);
+        for (size_t i = 0; i < n; ++i) {
+            input[i] = {static_cast<unsigned>(gen()), static_cast<unsigned>(i)};
+        }
+        std::vector<unsigned> queries(queries_count);
+        for (size_t i = 0; i < queries_count; ++i) {
+            queries[i] = i % 2 ? input[gen() % n].first : static_cast<unsigned>(gen());
+        }
+
+        auto start = clock::now();
+        Somn::flat_map<unsigned, unsigned> sorted(input.begin(), input.end());
+        double build_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        Somn::flat_map<unsigned, unsigned, std::less<unsigned>, Somn::flat_layout::eytzinger> tree(input.begin(), input.end());
+
+        std::vector<unsigned> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = input[i].first;
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::cout << n << " keys, " << queries_count << " lookups (half hits), bulk build " << build_ms << " ms" << std::endl;
+        bench_lookup("  std::lower_bound on std::vector", queries, [&keys](unsigned key) {
+            auto it = std::lower_bound(keys.begin(), keys.end(), key);
+            return it != keys.end() && *it == key;
+        });
+        bench_lookup("  flat_map, sorted             ", queries, [&sorted](unsigned key) { return sorted.contains(key); });
+        bench_lookup("  flat_map, eytzinger          ", queries, [&tree](unsigned key) { return tree.contains(key); });
+    }
+
+    // Merging a sorted batch vs inserting its entries one by one
+    Somn::flat_map<unsigned, unsigned> one_by_one, batched;
+    std::vector<std::pair<unsigned, unsigned>> batch;
+    for (unsigned i = 0; i < 20000; ++i) {
+        batch.emplace_back(i * 2 + 1, i);
+    }
+    auto start = clock::now();
+    for (auto& entry : batch) {
+        one_by_one.insert(entry.first, entry.second);
+    }
+    double single_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    start = clock::now();
+    for (size_t i = 0; i < batch.size(); i += 1000) {
+        batched.insert_sorted(batch.begin() + i, batch.begin() + i + 1000);
+    }
+    double batch_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << "20000 inserts: one by one " << single_ms << " ms, in sorted batches of 1000 " << batch_ms << " ms" << std::endl;
+}
+
+int main() {
+    test_flat_map();
+    test_flat_set();
+    bench_flat_map();
+    return 0;
+}
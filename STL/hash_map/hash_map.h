@@ -0,0 +1,671 @@
+/**
+ * @file hash_map.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{hash_map}
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "../memory/arena.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH_MAP_HAS_SSE2 1
+#endif
+
+namespace Somn {
+
+	namespace detail {
+		// Control byte of a slot: empty, deleted, or the low 7 bits of the hash when full
+		typedef int8_t ctrl_t;
+		const ctrl_t ctrl_empty = -128;    // 0b10000000
+		const ctrl_t ctrl_deleted = -2;    // 0b11111110
+		const size_t group_width = 16;
+
+		/**
+		 * @brief The 16 control bytes of one probe group, matched all at once.
+		 *
+		 * Each match returns a bit mask with bit i set when byte i matches.
+		 */
+		struct group {
+#ifdef HASH_MAP_HAS_SSE2
+			__m128i _ctrl;
+
+			explicit group(const ctrl_t* ctrl) : _ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+			uint32_t match(ctrl_t h2) const {
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(h2))));
+			}
+
+			uint32_t match_empty() const {
+				return match(ctrl_empty);
+			}
+
+			// Empty and deleted are the only negative control bytes
+			uint32_t match_empty_or_deleted() const {
+				return static_cast<uint32_t>(_mm_movemask_epi8(_ctrl));
+			}
+#else
+			const ctrl_t* _ctrl;
+
+			explicit group(const ctrl_t* ctrl) : _ctrl(ctrl) {}
+
+			uint32_t match(ctrl_t h2) const {
+				uint32_t bits = 0;
+				for (size_t index = 0; index < group_width; index++) {
+					bits |= uint32_t(_ctrl[index] == h2) << index;
+				}
+				return bits;
+			}
+
+			uint32_t match_empty() const {
+				return match(ctrl_empty);
+			}
+
+			uint32_t match_empty_or_deleted() const {
+				uint32_t bits = 0;
+				for (size_t index = 0; index < group_width; index++) {
+					bits |= uint32_t(_ctrl[index] < 0) << index;
+				}
+				return bits;
+			}
+#endif
+		};
+
+		inline unsigned lowest_bit(uint32_t bits) {
+			return static_cast<unsigned>(__builtin_ctz(bits));
+		}
+
+		// Spread the user hash over all 64 bits; std::hash of integers is the identity
+		inline size_t mix_hash(size_t h) {
+#ifdef __SIZEOF_INT128__
+			unsigned __int128 product = static_cast<unsigned __int128>(h) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(product) ^ static_cast<size_t>(product >> 64);
+#else
+			h ^= h >> 33;
+			h *= 0xFF51AFD7ED558CCDull;
+			h ^= h >> 33;
+			return h;
+#endif
+		}
+
+		template<class Hash, class KeyEqual, class = void>
+		struct is_transparent : std::false_type {};
+
+		template<class Hash, class KeyEqual>
+		struct is_transparent<Hash, KeyEqual, std::void_t<typename Hash::is_transparent, typename KeyEqual::is_transparent>>
+			: std::true_type {};
+
+		// Depends on the lookup key type K, so that heterogeneous overloads are only checked when used
+		template<class Hash, class KeyEqual, class K>
+		struct transparent_key : is_transparent<Hash, KeyEqual> {};
+	}
+
+	template<class Key, class T, class Hash, class KeyEqual>
+	class hash_map;
+
+	/**
+	 * @brief Forward iterator over the full slots of a hash_map.
+	 */
+	template<class Value, class Slot>
+	class hash_map_iterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Value value_type;
+		typedef ptrdiff_t difference_type;
+		typedef Value* pointer;
+		typedef Value& reference;
+
+		hash_map_iterator() : _ctrl(nullptr), _slot(nullptr), _end(nullptr) {}
+
+		// Allow iterator -> const_iterator
+		template<class Other, class = std::enable_if_t<std::is_convertible<Other*, Value*>::value>>
+		hash_map_iterator(const hash_map_iterator<Other, Slot>& it) : _ctrl(it._ctrl), _slot(it._slot), _end(it._end) {}
+
+		reference operator*() const { return *reinterpret_cast<pointer>(_slot); }
+
+		pointer operator->() const { return reinterpret_cast<pointer>(_slot); }
+
+		hash_map_iterator& operator++() {
+			++_ctrl;
+			++_slot;
+			skip_empty();
+			return *this;
+		}
+
+		hash_map_iterator operator++(int) {
+			hash_map_iterator temp(*this);
+			++*this;
+			return temp;
+		}
+
+		bool operator==(const hash_map_iterator& it) const { return _ctrl == it._ctrl; }
+
+		bool operator!=(const hash_map_iterator& it) const { return _ctrl != it._ctrl; }
+
+	private:
+		template<class K, class V, class H, class E> friend class hash_map;
+		template<class V, class S> friend class hash_map_iterator;
+
+		hash_map_iterator(const detail::ctrl_t* ctrl, Slot* slot, const detail::ctrl_t* end)
+			: _ctrl(ctrl), _slot(slot), _end(end) {}
+
+		void skip_empty() {
+			while (_ctrl != _end && *_ctrl < 0) {
+				++_ctrl;
+				++_slot;
+			}
+		}
+
+		const detail::ctrl_t* _ctrl;   /**< Control byte of the current slot */
+		Slot* _slot;                   /**< Current slot */
+		const detail::ctrl_t* _end;    /**< One past the last control byte */
+	};
+
+	/**
+	 * @brief Open-addressing hash map in the style of Swiss tables.
+	 *
+	 * Entries live in one flat array of slots, next to an array of one-byte
+	 * control words holding 7 bits of each entry's hash. A lookup probes whole
+	 * groups of 16 control bytes with a single SIMD compare and only touches
+	 * slots whose control byte matches, so both hits and misses usually cost
+	 * one cache line of metadata plus one slot.
+	 *
+	 * Pointers and iterators stay valid until the next insertion that grows
+	 * or rehashes the table; erase never moves other entries, so erasing
+	 * while iterating is safe through the returned iterator.
+	 *
+	 * @tparam Key The key type.
+	 * @tparam T The mapped type.
+	 * @tparam Hash Hash function; with KeyEqual both defining is_transparent,
+	 *         find/count/contains/erase also accept keys of other types.
+	 * @tparam KeyEqual Key comparison; the default std::equal_to<> is transparent.
+	 */
+	template<class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<>>
+	class hash_map {
+	public:
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef std::pair<const Key, T> value_type;
+		typedef size_t size_type;
+
+	private:
+		// Raw storage for one entry; constructed only while its control byte is full
+		struct slot {
+			alignas(value_type) unsigned char _bytes[sizeof(value_type)];
+		};
+
+	public:
+		typedef hash_map_iterator<value_type, slot> iterator;
+		typedef hash_map_iterator<const value_type, slot> const_iterator;
+
+		/**
+		 * @brief Default constructor; allocates nothing until the first insert.
+		 */
+		hash_map() : hash_map(default_resource()) {}
+
+		/**
+		 * @brief Constructs an empty map that allocates from the given resource.
+		 * @param resource The memory resource used for the table, e.g. an arena.
+		 */
+		explicit hash_map(memory_resource* resource)
+			: _ctrl(nullptr), _slots(nullptr), _capacity(0), _size(0), _growth_left(0), _resource(resource) {}
+
+		/**
+		 * @brief Copy constructor; the copy uses the default resource.
+		 */
+		hash_map(const hash_map& other) : hash_map() {
+			reserve(other.size());
+			for (const value_type& entry : other) {
+				insert(entry);
+			}
+		}
+
+		hash_map(hash_map&& other) noexcept : hash_map(other._resource) {
+			swap(other);
+		}
+
+		hash_map& operator=(const hash_map& other) {
+			if (this != &other) {
+				hash_map temp(other);
+				swap(temp);
+			}
+			return *this;
+		}
+
+		hash_map& operator=(hash_map&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+
+		~hash_map() {
+			destroy_all();
+			deallocate_table(_ctrl, _capacity);
+		}
+
+		iterator begin() {
+			iterator it(_ctrl, _slots, _ctrl + _capacity);
+			it.skip_empty();
+			return it;
+		}
+
+		iterator end() {
+			return iterator(_ctrl + _capacity, _slots + _capacity, _ctrl + _capacity);
+		}
+
+		const_iterator begin() const {
+			return const_cast<hash_map*>(this)->begin();
+		}
+
+		const_iterator end() const {
+			return const_cast<hash_map*>(this)->end();
+		}
+
+		size_t size() const { return _size; }
+
+		bool empty() const { return _size == 0; }
+
+		/**
+		 * @brief Number of slots; the table grows when size() would exceed 7/8 of it.
+		 */
+		size_t capacity() const { return _capacity; }
+
+		float load_factor() const { return _capacity ? float(_size) / float(_capacity) : 0.0f; }
+
+		memory_resource* resource() const { return _resource; }
+
+		/**
+		 * @brief Make room for n entries without further rehashing.
+		 */
+		void reserve(size_t n) {
+			if (n > _size + _growth_left) {
+				resize(capacity_for(n));
+			}
+		}
+
+		/**
+		 * @brief Rebuild the table with at least count slots (and room for size()).
+		 *        rehash(0) shrinks to the smallest table that fits and drops tombstones.
+		 */
+		void rehash(size_t count) {
+			size_t target = capacity_for(_size);
+			while (target < count) {
+				target *= 2;
+			}
+			if (_size == 0 && count == 0) {
+				target = 0;
+			}
+			resize(target);
+		}
+
+		/**
+		 * @brief Insert a copy of entry unless its key is already present.
+		 * @return The entry with that key and whether it was inserted.
+		 */
+		std::pair<iterator, bool> insert(const value_type& entry) {
+			return try_emplace(entry.first, entry.second);
+		}
+
+		/**
+		 * @brief Insert (key, mapped constructed from args) unless key is present;
+		 *        args are left untouched when it is.
+		 */
+		template<class... Args>
+		std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+			size_t hash = hash_of(key);
+			size_t index = find_index(key, hash);
+			if (index != npos) {
+				return {iterator_at(index), false};
+			}
+			index = prepare_insert(hash);
+			construct_at(index, key, std::forward<Args>(args)...);
+			return {iterator_at(index), true};
+		}
+
+		template<class... Args>
+		std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+			size_t hash = hash_of(key);
+			size_t index = find_index(key, hash);
+			if (index != npos) {
+				return {iterator_at(index), false};
+			}
+			index = prepare_insert(hash);
+			construct_at(index, std::move(key), std::forward<Args>(args)...);
+			return {iterator_at(index), true};
+		}
+
+		/**
+		 * @brief Insert key with value, or assign value to the existing entry.
+		 */
+		template<class M>
+		std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+			std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(value));
+			if (!result.second) {
+				result.first->second = std::forward<M>(value);
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Access the value for key, inserting a default-constructed one if absent.
+		 */
+		T& operator[](const key_type& key) {
+			return try_emplace(key).first->second;
+		}
+
+		T& operator[](key_type&& key) {
+			return try_emplace(std::move(key)).first->second;
+		}
+
+		/**
+		 * @brief Access the value for key.
+		 * @throws std::out_of_range when key is absent.
+		 */
+		T& at(const key_type& key) {
+			iterator it = find(key);
+			if (it == end()) {
+				throw std::out_of_range("hash_map::at: key not found");
+			}
+			return it->second;
+		}
+
+		const T& at(const key_type& key) const {
+			return const_cast<hash_map*>(this)->at(key);
+		}
+
+		iterator find(const key_type& key) {
+			size_t index = find_index(key, hash_of(key));
+			return index == npos ? end() : iterator_at(index);
+		}
+
+		const_iterator find(const key_type& key) const {
+			return const_cast<hash_map*>(this)->find(key);
+		}
+
+		/**
+		 * @brief Heterogeneous lookup, e.g. a myString_view or const char* for myString keys.
+		 */
+		template<class K, class = std::enable_if_t<detail::transparent_key<Hash, KeyEqual, K>::value>>
+		iterator find(const K& key) {
+			size_t index = find_index(key, hash_of(key));
+			return index == npos ? end() : iterator_at(index);
+		}
+
+		template<class K, class = std::enable_if_t<detail::transparent_key<Hash, KeyEqual, K>::value>>
+		const_iterator find(const K& key) const {
+			return const_cast<hash_map*>(this)->find(key);
+		}
+
+		bool contains(const key_type& key) const {
+			return find(key) != end();
+		}
+
+		template<class K, class = std::enable_if_t<detail::transparent_key<Hash, KeyEqual, K>::value>>
+		bool contains(const K& key) const {
+			return find(key) != end();
+		}
+
+		size_t count(const key_type& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		template<class K, class = std::enable_if_t<detail::transparent_key<Hash, KeyEqual, K>::value>>
+		size_t count(const K& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		/**
+		 * @brief Erase the entry at pos; no other entry moves.
+		 * @return An iterator to the entry following pos in iteration order.
+		 */
+		iterator erase(const_iterator pos) {
+			assert(pos != end());
+			size_t index = pos._ctrl - _ctrl;
+			erase_at(index);
+			iterator next(_ctrl + index, _slots + index, _ctrl + _capacity);
+			next.skip_empty();
+			return next;
+		}
+
+		iterator erase(iterator pos) {
+			return erase(const_iterator(pos));
+		}
+
+		/**
+		 * @brief Erase the entry with the given key.
+		 * @return The number of entries erased (0 or 1).
+		 */
+		size_t erase(const key_type& key) {
+			size_t index = find_index(key, hash_of(key));
+			if (index == npos) {
+				return 0;
+			}
+			erase_at(index);
+			return 1;
+		}
+
+		template<class K, class = std::enable_if_t<detail::transparent_key<Hash, KeyEqual, K>::value &&
+		                                           !std::is_convertible<K, const_iterator>::value>>
+		size_t erase(const K& key) {
+			size_t index = find_index(key, hash_of(key));
+			if (index == npos) {
+				return 0;
+			}
+			erase_at(index);
+			return 1;
+		}
+
+		/**
+		 * @brief Destroy all entries; the table keeps its capacity.
+		 */
+		void clear() {
+			destroy_all();
+			if (_capacity) {
+				memset(_ctrl, static_cast<unsigned char>(detail::ctrl_empty), _capacity);
+			}
+			_size = 0;
+			_growth_left = max_size_for(_capacity);
+		}
+
+		void swap(hash_map& other) {
+			std::swap(_ctrl, other._ctrl);
+			std::swap(_slots, other._slots);
+			std::swap(_capacity, other._capacity);
+			std::swap(_size, other._size);
+			std::swap(_growth_left, other._growth_left);
+			std::swap(_resource, other._resource);
+			std::swap(_hash, other._hash);
+			std::swap(_equal, other._equal);
+		}
+
+	private:
+		static const size_t npos = static_cast<size_t>(-1);
+
+		// Entries a table of the given capacity may hold: 7/8 load factor
+		static size_t max_size_for(size_t capacity) {
+			return capacity - capacity / 8;
+		}
+
+		// Smallest power-of-two capacity, at least one group, that holds n entries
+		static size_t capacity_for(size_t n) {
+			size_t capacity = detail::group_width;
+			while (max_size_for(capacity) < n) {
+				capacity *= 2;
+			}
+			return capacity;
+		}
+
+		static size_t slot_offset(size_t capacity) {
+			size_t align = alignof(slot);
+			return (capacity + align - 1) / align * align;
+		}
+
+		static size_t table_alignment() {
+			return alignof(slot) > detail::group_width ? alignof(slot) : detail::group_width;
+		}
+
+		template<class K>
+		size_t hash_of(const K& key) const {
+			return detail::mix_hash(_hash(key));
+		}
+
+		iterator iterator_at(size_t index) {
+			return iterator(_ctrl + index, _slots + index, _ctrl + _capacity);
+		}
+
+		value_type& entry(size_t index) {
+			return *reinterpret_cast<value_type*>(_slots + index);
+		}
+
+		// Probe groups in triangular order, which visits every group when their number is a power of two
+		template<class K>
+		size_t find_index(const K& key, size_t hash) {
+			if (_capacity == 0) {
+				return npos;
+			}
+			size_t mask = _capacity / detail::group_width - 1;
+			size_t g = (hash >> 7) & mask;
+			detail::ctrl_t h2 = static_cast<detail::ctrl_t>(hash & 0x7F);
+			for (size_t step = 1;; step++) {
+				detail::group grp(_ctrl + g * detail::group_width);
+				for (uint32_t bits = grp.match(h2); bits; bits &= bits - 1) {
+					size_t index = g * detail::group_width + detail::lowest_bit(bits);
+					if (_equal(entry(index).first, key)) {
+						return index;
+					}
+				}
+				// An empty slot ends the probe: the key would have been placed there
+				if (grp.match_empty()) {
+					return npos;
+				}
+				g = (g + step) & mask;
+			}
+		}
+
+		// First empty or deleted slot on the probe sequence of hash
+		size_t find_free(size_t hash) const {
+			size_t mask = _capacity / detail::group_width - 1;
+			size_t g = (hash >> 7) & mask;
+			for (size_t step = 1;; step++) {
+				uint32_t bits = detail::group(_ctrl + g * detail::group_width).match_empty_or_deleted();
+				if (bits) {
+					return g * detail::group_width + detail::lowest_bit(bits);
+				}
+				g = (g + step) & mask;
+			}
+		}
+
+		// Claim a slot for a new entry with the given hash, growing first if needed
+		size_t prepare_insert(size_t hash) {
+			size_t index = _capacity ? find_free(hash) : 0;
+			if (_capacity == 0 || (_growth_left == 0 && _ctrl[index] == detail::ctrl_empty)) {
+				// Full of entries or tombstones; a same-size rehash drops the tombstones
+				resize(capacity_for(_size + 1));
+				index = find_free(hash);
+			}
+			if (_ctrl[index] == detail::ctrl_empty) {
+				_growth_left--;
+			}
+			_ctrl[index] = static_cast<detail::ctrl_t>(hash & 0x7F);
+			_size++;
+			return index;
+		}
+
+		// Construct the entry in a slot claimed by prepare_insert(); give the slot back if that throws
+		template<class K, class... Args>
+		void construct_at(size_t index, K&& key, Args&&... args) {
+			try {
+				new(_slots + index) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+				                               std::forward_as_tuple(std::forward<Args>(args)...));
+			}
+			catch (...) {
+				_ctrl[index] = detail::ctrl_deleted;
+				_size--;
+				throw;
+			}
+		}
+
+		void erase_at(size_t index) {
+			entry(index).~value_type();
+			_size--;
+			// If the group still has an empty slot it was never full, so no probe
+			// sequence continues past it and the slot can become empty again
+			size_t group_start = index / detail::group_width * detail::group_width;
+			if (detail::group(_ctrl + group_start).match_empty()) {
+				_ctrl[index] = detail::ctrl_empty;
+				_growth_left++;
+			}
+			else {
+				_ctrl[index] = detail::ctrl_deleted;
+			}
+		}
+
+		void resize(size_t capacity) {
+			detail::ctrl_t* old_ctrl = _ctrl;
+			slot* old_slots = _slots;
+			size_t old_capacity = _capacity;
+
+			_ctrl = nullptr;
+			_slots = nullptr;
+			_capacity = 0;
+			_growth_left = 0;
+			if (capacity) {
+				void* memory = _resource->allocate(slot_offset(capacity) + capacity * sizeof(slot), table_alignment());
+				_ctrl = static_cast<detail::ctrl_t*>(memory);
+				_slots = reinterpret_cast<slot*>(static_cast<char*>(memory) + slot_offset(capacity));
+				_capacity = capacity;
+				memset(_ctrl, static_cast<unsigned char>(detail::ctrl_empty), capacity);
+				_growth_left = max_size_for(capacity) - _size;
+			}
+
+			// Move every entry over; the new table has no tombstones, so the first free slot is empty
+			for (size_t index = 0; index < old_capacity; index++) {
+				if (old_ctrl[index] >= 0) {
+					value_type& old_entry = *reinterpret_cast<value_type*>(old_slots + index);
+					size_t hash = hash_of(old_entry.first);
+					size_t target = find_free(hash);
+					_ctrl[target] = static_cast<detail::ctrl_t>(hash & 0x7F);
+					new(_slots + target) value_type(std::move(const_cast<Key&>(old_entry.first)), std::move(old_entry.second));
+					old_entry.~value_type();
+				}
+			}
+			deallocate_table(old_ctrl, old_capacity);
+		}
+
+		void destroy_all() {
+			if (!std::is_trivially_destructible<value_type>::value) {
+				for (size_t index = 0; index < _capacity; index++) {
+					if (_ctrl[index] >= 0) {
+						entry(index).~value_type();
+					}
+				}
+			}
+		}
+
+		void deallocate_table(detail::ctrl_t* ctrl, size_t capacity) {
+			if (ctrl) {
+				_resource->deallocate(ctrl, slot_offset(capacity) + capacity * sizeof(slot), table_alignment());
+			}
+		}
+
+		detail::ctrl_t* _ctrl;      /**< Control bytes, one per slot */
+		slot* _slots;               /**< Entry storage, same index as _ctrl */
+		size_t _capacity;           /**< Number of slots, 0 or a power of two >= 16 */
+		size_t _size;               /**< Number of entries */
+		size_t _growth_left;        /**< Inserts into empty slots left before a rehash */
+		memory_resource* _resource; /**< Source of the table */
+		Hash _hash;
+		KeyEqual _equal;
+	};
+
+}
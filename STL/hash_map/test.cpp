@@ -0,0 +1,162 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "hash_map.h"
+#include "../vector/myVector.h"
+#include "../string/myString.h"
+
+void test_hash_map() {
+    using namespace Somn;
+
+    hash_map<int, int> map;
+    for (int i = 0; i < 1000; ++i) {
+        map[i] = i * i;
+    }
+    map.insert({5, -1});                    // Key exists, not replaced
+    map.insert_or_assign(6, -1);            // Key exists, replaced
+    std::cout << "size " << map.size() << ", map[5] " << map.at(5) << ", map[6] " << map.at(6)
+              << ", contains 1000 " << map.contains(1000) << std::endl;
+
+    // Erase while iterating: erase returns the next entry and moves nothing else
+    size_t visited = 0;
+    for (auto it = map.begin(); it != map.end();) {
+        ++visited;
+        if (it->first % 2 == 0) {
+            it = map.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    std::cout << "visited " << visited << ", left " << map.size() << ", erase(7) " << map.erase(7)
+              << ", erase(8) " << map.erase(8) << std::endl;
+
+    // reserve up front: no rehash, so addresses stay put
+    hash_map<int, int> reserved;
+    reserved.reserve(10000);
+    size_t capacity = reserved.capacity();
+    int* first = &reserved[0];
+    for (int i = 1; i < 10000; ++i) {
+        reserved[i] = i;
+    }
+    std::cout << "reserve: capacity kept " << (reserved.capacity() == capacity) << ", address kept "
+              << (first == &reserved[0]) << std::endl;
+    for (int i = 100; i < 10000; ++i) {
+        reserved.erase(i);
+    }
+    reserved.rehash(0);
+    std::cout << "rehash(0): capacity " << capacity << " -> " << reserved.capacity() << ", size " << reserved.size() << std::endl;
+
+    // myString keys: lookups by view or C string do not build a myString
+    hash_map<cocoon::myString, int> words;
+    words[cocoon::myString("alpha")] = 1;
+    words[cocoon::myString("beta")] = 2;
+    cocoon::myString_view text("alpha beta gamma");
+    std::cout << "heterogeneous: " << words.find(text.substr(6, 4))->second << " " << words.count("alpha")
+              << " " << words.contains(text.substr(11)) << " " << words.erase("beta") << " " << words.size() << std::endl;
+}
+
+// Random inserts and erases checked against std::unordered_map
+void test_against_std() {
+    Somn::hash_map<long long, long long> map;
+    std::unordered_map<long long, long long> reference;
+    std::mt19937_64 gen(11);
+    size_t mismatches = 0;
+    for (int i = 0; i < 300000; ++i) {
+        long long key = static_cast<long long>(gen() % 20000);
+        switch (gen() % 3) {
+        case 0:
+            map[key] = i;
+            reference[key] = i;
+            break;
+        case 1:
+            mismatches += map.erase(key) != reference.erase(key);
+            break;
+        default: {
+            auto it = map.find(key);
+            auto ref = reference.find(key);
+            mismatches += (it == map.end()) != (ref == reference.end());
+            if (it != map.end() && ref != reference.end()) {
+                mismatches += it->second != ref->second;
+            }
+        }
+        }
+    }
+    size_t iterated = 0;
+    for (const auto& entry : map) {
+        ++iterated;
+        mismatches += reference.at(entry.first) != entry.second;
+    }
+    std::cout << "random ops: size " << map.size() << "/" << reference.size() << ", iterated " << iterated
+              << ", mismatches " << mismatches << std::endl;
+}
+
+template<class Map, class Keys>
+void bench_map(const char* name, const Keys& keys, const Keys& missing) {
+    typedef std::chrono::steady_clock clock;
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    size_t n = keys.size();
+
+    auto start = clock::now();
+    Map map;
+    for (size_t i = 0; i < n; ++i) {
+        map[keys[i]] = i;
+    }
+    auto t1 = clock::now();
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        hits += map.find(keys[i]) != map.end();
+    }
+    auto t2 = clock::now();
+    size_t misses = 0;
+    for (size_t i = 0; i < n; ++i) {
+        misses += map.find(missing[i]) == map.end();
+    }
+    auto t3 = clock::now();
+    size_t erased = 0;
+    for (size_t i = 0; i < n; ++i) {
+        erased += map.erase(keys[i]);
+    }
+    auto t4 = clock::now();
+    std::cout << name << ": insert " << ms(start, t1) << " ms, hit " << ms(t1, t2) << " ms, miss " << ms(t2, t3)
+              << " ms, erase " << ms(t3, t4) << " ms (" << hits << "/" << misses << "/" << erased << ")" << std::endl;
+}
+
+void bench_hash_map() {
+    const size_t n = 1000000;
+    std::mt19937_64 gen(3);
+    Somn::myVector<unsigned long long> keys, missing;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned long long key = gen();
+        keys.push_back(key | 1);            // Odd keys are present,
+        missing.push_back(key & ~1ull);     // even keys never are
+    }
+    std::cout << n << " integer keys" << std::endl;
+    bench_map<Somn::hash_map<unsigned long long, size_t>>("  Somn::hash_map    ", keys, missing);
+    bench_map<std::unordered_map<unsigned long long, size_t>>("  std::unordered_map", keys, missing);
+
+    Somn::myVector<cocoon::myString> texts, missing_texts;
+    Somn::myVector<std::string> std_texts, std_missing;
+    for (size_t i = 0; i < n / 2; ++i) {
+        std::string key = "user:" + std::to_string(keys[i]);
+        std::string other = "user:" + std::to_string(missing[i]);
+        texts.push_back(cocoon::myString(key.c_str()));
+        missing_texts.push_back(cocoon::myString(other.c_str()));
+        std_texts.push_back(key);
+        std_missing.push_back(other);
+    }
+    std::cout << n / 2 << " string keys" << std::endl;
+    bench_map<Somn::hash_map<cocoon::myString, size_t>>("  Somn::hash_map<myString>        ", texts, missing_texts);
+    bench_map<std::unordered_map<std::string, size_t>>("  std::unordered_map<std::string> ", std_texts, std_missing);
+}
+
+int main() {
+    test_hash_map();
+    test_against_std();
+    bench_hash_map();
+    return 0;
+}
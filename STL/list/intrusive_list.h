@@ -0,0 +1,246 @@
+#ifndef LIST_INTRUSIVE_LIST_H
+#define LIST_INTRUSIVE_LIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace beat {
+
+    // 侵入式链表的挂钩，作为成员嵌入对象中；一个对象可以有多个挂钩，同时位于多个链表
+    // Hook of an intrusive list, embedded in the object as a member; an object with several hooks can be in several lists at once
+    struct list_hook {
+        list_hook *_next;   // 指向下一个挂钩 (Pointer to the next hook)
+        list_hook *_prev;   // 指向前一个挂钩 (Pointer to the previous hook)
+
+        list_hook() : _next(nullptr), _prev(nullptr) {}
+
+        // 复制对象不复制链接关系，副本不在任何链表中
+        // Copying an object does not copy its links; the copy is in no list
+        list_hook(const list_hook &) : _next(nullptr), _prev(nullptr) {}
+
+        list_hook &operator=(const list_hook &) { return *this; }
+
+        // 对象销毁前必须先从链表中移除
+        // The object must be removed from its list before it is destroyed
+        ~list_hook() { assert(!is_linked()); }
+
+        // 是否在某个链表中
+        // Whether the hook is in a list
+        [[nodiscard]] bool is_linked() const { return _next != nullptr; }
+    };
+
+    // 侵入式链表迭代器，与list_iterator相同，只是指向挂钩并换算回对象
+    // Intrusive list iterator, like list_iterator but pointing at hooks and converting back to the object
+    template<class T, list_hook T::*Hook, class Ref, class Ptr>
+    struct intrusive_list_iterator {
+        typedef T val_type;
+        typedef list_hook *node_ptr;
+        typedef intrusive_list_iterator<T, Hook, Ref, Ptr> Self;
+
+        explicit intrusive_list_iterator(node_ptr pointer) : _pointer(pointer) {}
+
+        Ref operator*() { return *owner(_pointer); }
+
+        Ptr operator->() { return owner(_pointer); }
+
+        bool operator!=(const Self &it) const { return _pointer != it._pointer; }
+
+        bool operator==(const Self &it) const { return _pointer == it._pointer; }
+
+        Self &operator++() {
+            _pointer = _pointer->_next;
+            return *this;
+        }
+
+        Self operator++(int) {
+            Self temp(*this);
+            _pointer = _pointer->_next;
+            return temp;
+        }
+
+        Self &operator--() {
+            _pointer = _pointer->_prev;
+            return *this;
+        }
+
+        Self operator--(int) {
+            Self temp(*this);
+            _pointer = _pointer->_prev;
+            return temp;
+        }
+
+        // 挂钩在对象中的偏移量，相当于对成员指针求offsetof
+        // Offset of the hook inside the object, i.e. offsetof for a pointer to member
+        static size_t hook_offset() {
+            alignas(T) static const char probe[sizeof(T)] = {};   // 只用于地址计算，从不构造 (Only used for address arithmetic, never constructed)
+            const T *object = reinterpret_cast<const T *>(probe);
+            return reinterpret_cast<const char *>(&(object->*Hook)) - probe;
+        }
+
+        // 由挂钩地址得到所属对象
+        // Returns the object that contains the hook
+        static T *owner(list_hook *hook) {
+            return reinterpret_cast<T *>(reinterpret_cast<char *>(hook) - hook_offset());
+        }
+
+        node_ptr _pointer;
+    };
+
+    // 侵入式双向链表 (Intrusive Doubly Linked List)
+    // 与list使用相同的哨兵节点设计，但节点就是对象中的挂钩：插入和删除不分配内存，也不复制对象，
+    // 已知对象即可O(1)删除，无需查找。链表不拥有对象，对象的生命周期由调用者（例如对象池）管理。
+    // Same sentinel design as list, but the nodes are the hooks inside the objects: insertion and removal neither
+    // allocate nor copy, and a known object is removed in O(1) without a lookup. The list does not own the objects;
+    // their lifetime is managed by the caller (e.g. an object pool).
+    template<class T, list_hook T::*Hook>
+    class intrusive_list {
+    public:
+        typedef list_hook node;
+        typedef intrusive_list_iterator<T, Hook, T &, T *> iterator;
+        typedef intrusive_list_iterator<T, Hook, const T &, const T *> const_iterator;
+
+        // 构造一个空链表，哨兵节点是链表自身的成员
+        // Constructs an empty list; the sentinel is a member of the list itself
+        intrusive_list() { empty_initialize(); }
+
+        intrusive_list(const intrusive_list &) = delete;
+
+        intrusive_list &operator=(const intrusive_list &) = delete;
+
+        // 移动构造，元素转移到新链表
+        // Move constructor, the elements move to the new list
+        intrusive_list(intrusive_list &&lt) noexcept {
+            empty_initialize();
+            swap(lt);
+        }
+
+        // 析构时只解除链接，不销毁对象
+        // The destructor only unlinks the objects, it does not destroy them
+        ~intrusive_list() { clear(); }
+
+        iterator begin() { return iterator(_head._next); }
+
+        const_iterator begin() const { return const_iterator(_head._next); }
+
+        iterator end() { return iterator(&_head); }
+
+        const_iterator end() const { return const_iterator(const_cast<sentinel *>(&_head)); }
+
+        T &front() { return *begin(); }
+
+        T &back() { return *--end(); }
+
+        [[nodiscard]] bool empty() const { return _head._next == &_head; }
+
+        [[nodiscard]] size_t size() const { return _size; }
+
+        void push_back(T &val) { insert(end(), val); }
+
+        void push_front(T &val) { insert(begin(), val); }
+
+        void pop_front() { erase(begin()); }
+
+        void pop_back() { erase(--end()); }
+
+        // 在pos之前链接val，val不能已在其他使用同一挂钩的链表中
+        // Links val before pos; val must not already be in a list through the same hook
+        iterator insert(iterator pos, T &val) {
+            node *new_node = &(val.*Hook);
+            assert(!new_node->is_linked());
+            node *cur = pos._pointer;
+            node *prev = cur->_prev;
+
+            prev->_next = new_node;
+            new_node->_prev = prev;
+            new_node->_next = cur;
+            cur->_prev = new_node;
+
+            ++_size;
+            return iterator(new_node);
+        }
+
+        // 解除pos处对象的链接，返回下一个位置
+        // Unlinks the object at pos and returns the next position
+        iterator erase(iterator pos) {
+            assert(pos != end());
+
+            node *prev_node = pos._pointer->_prev;
+            node *next_node = pos._pointer->_next;
+
+            prev_node->_next = next_node;
+            next_node->_prev = prev_node;
+            pos._pointer->_next = nullptr;
+            pos._pointer->_prev = nullptr;
+
+            --_size;
+            return iterator(next_node);
+        }
+
+        // 直接从本链表中移除对象，O(1)且无需查找
+        // Removes the object from this list directly, in O(1) and without a lookup
+        void erase(T &val) { erase(iterator_to(val)); }
+
+        // 对象在本链表中的位置
+        // Position of an object that is in this list
+        iterator iterator_to(T &val) { return iterator(&(val.*Hook)); }
+
+        // 把val移到链表末尾，例如重新排队
+        // Moves val to the end of the list, e.g. to requeue it
+        void move_to_back(T &val) {
+            erase(val);
+            push_back(val);
+        }
+
+        // 解除所有对象的链接
+        // Unlinks every object
+        void clear() {
+            node *cur = _head._next;
+            while (cur != &_head) {
+                node *next = cur->_next;
+                cur->_next = nullptr;
+                cur->_prev = nullptr;
+                cur = next;
+            }
+            empty_initialize();
+        }
+
+        // 交换两个链表的内容；哨兵是成员，所以要修正首尾元素的指针
+        // Swaps the content of two lists; the sentinels are members, so the first and last elements are relinked
+        void swap(intrusive_list &lt) {
+            std::swap(_head._next, lt._head._next);
+            std::swap(_head._prev, lt._head._prev);
+            std::swap(_size, lt._size);
+            fix_sentinel();
+            lt.fix_sentinel();
+        }
+
+    private:
+        void empty_initialize() {
+            _head._next = &_head;
+            _head._prev = &_head;
+            _size = 0;
+        }
+
+        void fix_sentinel() {
+            if (_size == 0) {
+                empty_initialize();
+            }
+            else {
+                _head._next->_prev = &_head;
+                _head._prev->_next = &_head;
+            }
+        }
+
+        // 哨兵在销毁时处于链接状态（指向自身），析构前置空以满足挂钩的断言
+        // The sentinel is linked to itself; reset it before destruction to satisfy the hook's assertion
+        struct sentinel : node {
+            ~sentinel() { _next = _prev = nullptr; }
+        };
+
+        sentinel _head;
+        size_t _size{};
+    };
+}
+
+#endif //LIST_INTRUSIVE_LIST_H
@@ -1,8 +1,10 @@
 #ifndef LIST_LIST_H
 #define LIST_LIST_H
 
+#include <cassert>
 #include <iostream>
 #include "iterator.h"
+#include "../memory/arena.h"
 
 namespace beat {
 
@@ -20,6 +22,10 @@ namespace beat {
         // 带参数的构造函数，初始化指针为空，数据为传入的值
         // Constructor with parameters, initializes pointers to nullptr and data to the given value
         explicit list_node(const T &val) : _next(nullptr), _prev(nullptr), _data(val) {}
+
+        // 移动构造数据的构造函数
+        // Constructor that moves the given value into the node
+        explicit list_node(T &&val) : _next(nullptr), _prev(nullptr), _data(std::move(val)) {}
     };
 
     // 链表迭代器结构体 (Structure for Linked List Iterator)
@@ -90,7 +96,9 @@ namespace beat {
         typedef reverseIterator<T, const T &, const T *> const_reverse_iterator;
 
         void empty_initialize() {
-            _head = new node();
+            _head = Somn::new_object<node>(_resource);
+            _head->_next = _head;
+            _head->_prev = _head;
             _size = 0;
         }
 
@@ -98,6 +106,14 @@ namespace beat {
         // Default constructor, initializes an empty list
         list() { empty_initialize(); }
 
+        // 构造一个空链表，节点从resource（例如arena）分配
+        // Constructs an empty list whose nodes are allocated from resource (e.g. an arena)
+        explicit list(Somn::memory_resource *resource) : _resource(resource) { empty_initialize(); }
+
+        // 返回分配节点所用的资源
+        // Returns the resource the nodes are allocated from
+        [[nodiscard]] Somn::memory_resource *resource() const { return _resource; }
+
         // 返回链表的起始迭代器
         // Returns an iterator pointing to the beginning of the list
         iterator begin() { return iterator(_head->_next); }
@@ -130,6 +146,12 @@ namespace beat {
         // Adds an element to the beginning of the list
         void push_front(const T &val) { insert(begin(), val); }
 
+        // 移动版本的push_back和push_front
+        // Moving versions of push_back and push_front
+        void push_back(T &&val) { insert(end(), std::move(val)); }
+
+        void push_front(T &&val) { insert(begin(), std::move(val)); }
+
         // 移除链表开头的元素
         // Removes the element at the beginning of the list
         void pop_front() { erase(begin()); }
@@ -149,7 +171,7 @@ namespace beat {
         // 在指定位置插入元素
         // Inserts an element at the specified position
         iterator insert(iterator pos, const T &val) {
-            auto new_node = new node(val);
+            auto new_node = Somn::new_object<node>(_resource, val);
             node *cur = pos._pointer;
             node *prev = cur->_prev;
 
@@ -162,6 +184,46 @@ namespace beat {
             return iterator(new_node);
         }
 
+        // 在指定位置插入元素（移动版本）
+        // Inserts an element at the specified position, moving it into the node
+        iterator insert(iterator pos, T &&val) {
+            auto new_node = Somn::new_object<node>(_resource, std::move(val));
+            node *cur = pos._pointer;
+            node *prev = cur->_prev;
+
+            prev->_next = new_node;
+            new_node->_prev = prev;
+            new_node->_next = cur;
+            cur->_prev = new_node;
+
+            ++_size;
+            return iterator(new_node);
+        }
+
+        // 把other中it处的节点移到pos之前，不分配也不复制；other可以是本链表，两个链表须使用同一资源
+        // Moves the node at it in other to before pos without allocating or copying; other may be this list,
+        // and both lists must use the same resource
+        void splice(iterator pos, list<T> &other, iterator it) {
+            node *moved = it._pointer;
+            node *cur = pos._pointer;
+            if (moved == cur || moved->_next == cur) {
+                return;
+            }
+            assert(other._resource == _resource);
+
+            moved->_prev->_next = moved->_next;
+            moved->_next->_prev = moved->_prev;
+
+            node *prev = cur->_prev;
+            prev->_next = moved;
+            moved->_prev = prev;
+            moved->_next = cur;
+            cur->_prev = moved;
+
+            --other._size;
+            ++_size;
+        }
+
         // 删除指定位置的元素
         // Deletes the element at the specified position
         iterator erase(iterator pos) {
@@ -173,7 +235,7 @@ namespace beat {
             prev_node->_next = next_node;
             next_node->_prev = prev_node;
 
-            delete pos._pointer;
+            Somn::delete_object(_resource, pos._pointer);
 
             --_size;
             return iterator(next_node);
@@ -193,8 +255,9 @@ namespace beat {
         // Copy constructor, initializes the current list with another list
         list(const list<T> &lt) {
             empty_initialize();
-            list<T> tmp = (lt.begin(), lt.end());
-            swap(tmp);
+            for (const T &val : lt) {
+                push_back(val);
+            }
         }
 
         // 赋值运算符，将一个链表对象的内容赋值给另一个链表对象
@@ -203,9 +266,11 @@ namespace beat {
             if (this != &lt) { // 检查自赋值
                 clear(); // 清空当前链表
 
-                // 创建一个临时链表副本，然后交换它们
-                list<T> tmp = lt;
-                swap(tmp);
+                // 逐个复制，节点从本链表的资源分配，使用arena的链表赋值后仍在arena上
+                // Copy element by element so the nodes come from this list's resource
+                for (const T &val : lt) {
+                    push_back(val);
+                }
             }
             return *this;
         }
@@ -215,13 +280,14 @@ namespace beat {
         void swap(list<T> &lt) {
             std::swap(_head, lt._head);
             std::swap(_size, lt._size);
+            std::swap(_resource, lt._resource);
         }
 
         // 析构函数，清空链表并释放内存
         // Destructor, clears the list and releases memory
         ~list() {
             clear();
-            delete _head;
+            Somn::delete_object(_resource, _head);
             _head = nullptr;
             _size = 0;
         }
@@ -229,6 +295,7 @@ namespace beat {
     private:
         node *_head;
         size_t _size{};
+        Somn::memory_resource *_resource = Somn::default_resource();
     };
 }
 
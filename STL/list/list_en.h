@@ -1,5 +1,6 @@
 #pragma once
 #include <cassert>
+#include "../memory/arena.h"
 
 namespace Somn {
 
@@ -102,6 +103,22 @@ namespace Somn {
             empty_initialize();
         }
 
+        /**
+         * @brief Initialize an empty list whose nodes come from the given resource.
+         * @param resource The memory resource used for the nodes, e.g. an arena.
+         */
+        explicit list(memory_resource* resource) : _resource(resource) {
+            empty_initialize();
+        }
+
+        /**
+         * @brief Get the memory resource the nodes are allocated from.
+         * @return The resource passed at construction, or default_resource().
+         */
+        memory_resource* resource() const {
+            return _resource;
+        }
+
         /**
          * @brief Copy constructor.
          * @param lt The list to be copied.
@@ -131,10 +148,11 @@ namespace Somn {
         void swap(list<T>& lt) {
             std::swap(_head, lt._head);
             std::swap(_size, lt._size);
+            std::swap(_resource, lt._resource);
         }
 
         /**
-         * @brief Assignment operator.
+         * @brief Assignment operator; the nodes come from this list's resource, which is kept.
          * @param lt The list to be assigned.
          * @return A reference to the assigned list.
          */
@@ -149,11 +167,6 @@ namespace Somn {
             return *this;
         }
 
-        list<T>& operator=(list<T> lt) {
-            swap(lt);
-            return *this;
-        }
-
         /**
          * @brief Add an element to the end of the list.
          * @param val The value to be added to the end of the list.
@@ -180,7 +193,7 @@ namespace Somn {
          */
         iterator insert(iterator pos, const T& val) {
             // Insert a new node with the given value at the specified position.
-            node* new_node = new node(val);
+            node* new_node = new_object<node>(_resource, val);
             node* cur = pos._pnode;
             node* prev = cur->_pre;
 
@@ -209,7 +222,7 @@ namespace Somn {
             prev->_next = next;
             next->_pre = prev;
 
-            delete pos._pnode;
+            delete_object(_resource, pos._pnode);
 
             _size--;
 
@@ -287,16 +300,17 @@ namespace Somn {
          */
         ~list() {
             clear();
-            delete _head;
+            delete_object(_resource, _head);
             _head = nullptr;
         }
 
     private:
         node* _head; // Pointer to the dummy head node of the list
         size_t _size;
+        memory_resource* _resource = default_resource(); // Source of the nodes
 
         inline void empty_initialize() {
-            _head = new node(T());
+            _head = new_object<node>(_resource, T());
             _head->_next = _head;
             _head->_pre = _head;
             _size = 0;
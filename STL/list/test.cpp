@@ -1,5 +1,109 @@
+#include <chrono>
 #include <iostream>
+#include <random>
 #include "list_en.h"
+#include "list.h"
+#include "intrusive_list.h"
+#include "../vector/myVector.h"
+
+// Pooled object that is in a run queue and an LRU list at the same time
+struct Task {
+    int id = 0;
+    long long work = 0;
+    beat::list_hook run_hook;
+    beat::list_hook lru_hook;
+};
+
+typedef beat::intrusive_list<Task, &Task::run_hook> run_queue;
+typedef beat::intrusive_list<Task, &Task::lru_hook> lru_list;
+
+void test_intrusive_list() {
+    Somn::myVector<Task> pool(8);
+    run_queue run;
+    lru_list lru;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i].id = static_cast<int>(i);
+        run.push_back(pool[i]);
+        lru.push_front(pool[i]);
+    }
+
+    // Unlink from one list without a lookup; the other list is untouched
+    run.erase(pool[3]);
+    lru.move_to_back(pool[0]);
+    std::cout << "run:";
+    for (Task& task : run) {
+        std::cout << " " << task.id;
+    }
+    std::cout << "\nlru:";
+    for (Task& task : lru) {
+        std::cout << " " << task.id;
+    }
+    std::cout << "\nsizes " << run.size() << " " << lru.size() << ", 3 linked " << pool[3].run_hook.is_linked()
+              << pool[3].lru_hook.is_linked() << std::endl;
+
+    // Moving a list relinks the sentinel; clear only unlinks
+    run_queue moved(std::move(run));
+    std::cout << "moved: " << moved.size() << " front " << moved.front().id << " back " << moved.back().id
+              << ", old empty " << run.empty() << std::endl;
+    moved.clear();
+    lru.clear();
+}
+
+// Requeue random tasks in two queues: intrusive relinking against beat::list<Task*> with stored iterators
+void bench_intrusive_list() {
+    typedef std::chrono::steady_clock clock;
+    const int tasks = 10000, rounds = 2000000;
+    Somn::myVector<Task> pool(tasks);
+    Somn::myVector<int> picks;
+    std::mt19937 gen(9);
+    for (int i = 0; i < rounds; ++i) {
+        picks.push_back(static_cast<int>(gen() % tasks));
+    }
+
+    auto start = clock::now();
+    {
+        run_queue run;
+        lru_list lru;
+        for (Task& task : pool) {
+            run.push_back(task);
+            lru.push_back(task);
+        }
+        for (int pick : picks) {
+            run.move_to_back(pool[pick]);
+            lru.move_to_back(pool[pick]);
+        }
+        std::cout << "  checks " << run.front().id + lru.back().id;
+        run.clear();
+        lru.clear();
+    }
+    auto t1 = clock::now();
+    {
+        typedef beat::list<Task*>::iterator position;
+        beat::list<Task*> run, lru;
+        Somn::myVector<beat::list<Task*>::node*> run_pos, lru_pos;
+        for (Task& task : pool) {
+            run.push_back(&task);
+            lru.push_back(&task);
+            run_pos.push_back(run.end()._pointer->_prev);
+            lru_pos.push_back(lru.end()._pointer->_prev);
+        }
+        for (int pick : picks) {
+            run.erase(position(run_pos[pick]));
+            lru.erase(position(lru_pos[pick]));
+            run.push_back(&pool[pick]);
+            lru.push_back(&pool[pick]);
+            run_pos[pick] = run.end()._pointer->_prev;
+            lru_pos[pick] = lru.end()._pointer->_prev;
+        }
+        std::cout << " " << (*run.begin())->id + (*--lru.end())->id << std::endl;
+    }
+    auto t2 = clock::now();
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    std::cout << rounds << " requeues in 2 lists: intrusive_list " << ms(start, t1) << " ms, beat::list<Task*> "
+              << ms(t1, t2) << " ms" << std::endl;
+}
 
 int main() {
     Somn::list<int> myList;
@@ -30,5 +134,7 @@ int main() {
     }
     std::cout << std::endl;
 
+    test_intrusive_list();
+    bench_intrusive_list();
     return 0;
 }
@@ -0,0 +1,337 @@
+/**
+ * @file arena.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{arena}
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace Somn {
+
+	/**
+	 * @brief Abstract source of raw memory used by the containers.
+	 *
+	 * Containers keep a pointer to a memory_resource and get every buffer
+	 * and node from it, so the same container type can draw from the heap
+	 * or from an arena.
+	 */
+	class memory_resource {
+	public:
+		virtual ~memory_resource() = default;
+
+		/**
+		 * @brief Allocate at least bytes bytes aligned to alignment.
+		 * @throws std::bad_alloc when no memory is available.
+		 */
+		virtual void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) = 0;
+
+		/**
+		 * @brief Give back memory obtained from allocate() with the same size and alignment.
+		 */
+		virtual void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) = 0;
+	};
+
+	/**
+	 * @brief memory_resource that forwards to global operator new and delete.
+	 */
+	class new_delete_resource : public memory_resource {
+	public:
+		void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				return ::operator new(bytes, std::align_val_t(alignment));
+			}
+			return ::operator new(bytes);
+		}
+
+		void deallocate(void* p, size_t, size_t alignment = alignof(std::max_align_t)) override {
+			if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				::operator delete(p, std::align_val_t(alignment));
+			}
+			else {
+				::operator delete(p);
+			}
+		}
+	};
+
+	/**
+	 * @brief The resource containers use when none is given: plain new and delete.
+	 */
+	inline memory_resource* default_resource() {
+		static new_delete_resource resource;
+		return &resource;
+	}
+
+	/**
+	 * @brief Monotonic arena for request-scoped allocations.
+	 *
+	 * Allocation bumps a pointer inside the current block; when the block is
+	 * full a new one, twice as large, is taken from the upstream resource.
+	 * deallocate() does nothing: memory comes back all at once through
+	 * reset() or the destructor. Containers using the arena must be destroyed
+	 * (their destructors only run element destructors) or simply abandoned,
+	 * for trivially destructible contents, before reset().
+	 *
+	 * Not thread safe; use one arena per request or per thread.
+	 */
+	class arena : public memory_resource {
+	public:
+		/**
+		 * @brief Create an arena whose first block will hold initial_size bytes.
+		 * @param initial_size Size of the first block, allocated lazily.
+		 * @param upstream Where blocks come from.
+		 */
+		explicit arena(size_t initial_size = 4096, memory_resource* upstream = default_resource())
+			: _upstream(upstream), _blocks(nullptr), _buffer(nullptr), _buffer_size(0),
+			_current(nullptr), _end(nullptr), _next_size(initial_size < 64 ? 64 : initial_size), _used(0) {}
+
+		/**
+		 * @brief Create an arena that starts in a caller-owned buffer, e.g. on the stack.
+		 * @param buffer The first region to allocate from; never freed by the arena.
+		 * @param size Size of buffer in bytes.
+		 * @param upstream Where further blocks come from once buffer is full.
+		 */
+		arena(void* buffer, size_t size, memory_resource* upstream = default_resource())
+			: _upstream(upstream), _blocks(nullptr), _buffer(static_cast<char*>(buffer)), _buffer_size(size),
+			_current(_buffer), _end(_buffer + size), _next_size(size < 64 ? 128 : size * 2), _used(0) {}
+
+		arena(const arena&) = delete;
+		arena& operator=(const arena&) = delete;
+
+		/**
+		 * @brief Return every block to the upstream resource.
+		 */
+		~arena() override {
+			release();
+		}
+
+		void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+			char* p = align_up(_current, alignment);
+			if (_current == nullptr || p + bytes > _end) {
+				grow(bytes, alignment);
+				p = align_up(_current, alignment);
+			}
+			_current = p + bytes;
+			_used += bytes;
+			return p;
+		}
+
+		/**
+		 * @brief No-op; memory is reclaimed by reset().
+		 */
+		void deallocate(void*, size_t, size_t = alignof(std::max_align_t)) override {}
+
+		/**
+		 * @brief Make all memory available again in O(number of blocks).
+		 *
+		 * The largest block is kept, so a steady stream of similar requests
+		 * stops touching the upstream resource after the first few.
+		 */
+		void reset() {
+			if (_blocks) {
+				// The newest block is the largest one; free the others
+				block* keep = _blocks;
+				block* cur = keep->_prev;
+				while (cur) {
+					block* prev = cur->_prev;
+					_upstream->deallocate(cur, cur->_size, alignof(std::max_align_t));
+					cur = prev;
+				}
+				keep->_prev = nullptr;
+				_current = reinterpret_cast<char*>(keep + 1);
+				_end = reinterpret_cast<char*>(keep) + keep->_size;
+			}
+			else {
+				_current = _buffer;
+				_end = _buffer + _buffer_size;
+			}
+			_used = 0;
+		}
+
+		/**
+		 * @brief Return every block to the upstream resource, including the kept one.
+		 */
+		void release() {
+			while (_blocks) {
+				block* prev = _blocks->_prev;
+				_upstream->deallocate(_blocks, _blocks->_size, alignof(std::max_align_t));
+				_blocks = prev;
+			}
+			_current = _buffer;
+			_end = _buffer + _buffer_size;
+			_used = 0;
+		}
+
+		/**
+		 * @brief Bytes handed out since construction or the last reset().
+		 */
+		size_t bytes_used() const {
+			return _used;
+		}
+
+		/**
+		 * @brief Bytes currently held from the upstream resource.
+		 */
+		size_t bytes_reserved() const {
+			size_t total = 0;
+			for (block* cur = _blocks; cur; cur = cur->_prev) {
+				total += cur->_size;
+			}
+			return total;
+		}
+
+	private:
+		// Header at the start of each upstream block; the blocks form a list from newest to oldest
+		struct alignas(std::max_align_t) block {
+			block* _prev;
+			size_t _size;   // Whole block including this header
+		};
+
+		static char* align_up(char* p, size_t alignment) {
+			uintptr_t value = reinterpret_cast<uintptr_t>(p);
+			return reinterpret_cast<char*>((value + alignment - 1) & ~(uintptr_t(alignment) - 1));
+		}
+
+		void grow(size_t bytes, size_t alignment) {
+			size_t need = sizeof(block) + bytes + alignment;
+			size_t size = _next_size;
+			while (size < need) {
+				size *= 2;
+			}
+			void* memory = _upstream->allocate(size, alignof(std::max_align_t));
+			block* fresh = static_cast<block*>(memory);
+			fresh->_prev = _blocks;
+			fresh->_size = size;
+			_blocks = fresh;
+			_current = reinterpret_cast<char*>(fresh + 1);
+			_end = static_cast<char*>(memory) + size;
+			_next_size = size * 2;
+		}
+
+		memory_resource* _upstream; /**< Source of the blocks */
+		block* _blocks;             /**< Newest block, or nullptr */
+		char* _buffer;              /**< Caller-owned initial buffer, or nullptr */
+		size_t _buffer_size;        /**< Size of _buffer */
+		char* _current;             /**< Next free byte in the current region */
+		char* _end;                 /**< End of the current region */
+		size_t _next_size;          /**< Size of the next upstream block */
+		size_t _used;               /**< Bytes handed out since the last reset */
+	};
+
+	/**
+	 * @brief Standard allocator over a memory_resource, for std containers
+	 *        such as the deque behind Queue and Stack.
+	 *
+	 * Copy-constructing a container does not propagate the resource: the
+	 * copy uses default_resource(), as the copy constructors of the Somn,
+	 * Track, beat and cocoon containers do.
+	 */
+	template<class T>
+	class resource_allocator {
+	public:
+		typedef T value_type;
+
+		resource_allocator() noexcept : _resource(default_resource()) {}
+
+		resource_allocator(memory_resource* resource) noexcept : _resource(resource) {}
+
+		template<class U>
+		resource_allocator(const resource_allocator<U>& other) noexcept : _resource(other.resource()) {}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, size_t n) {
+			_resource->deallocate(p, n * sizeof(T), alignof(T));
+		}
+
+		resource_allocator select_on_container_copy_construction() const {
+			return resource_allocator();
+		}
+
+		memory_resource* resource() const {
+			return _resource;
+		}
+
+	private:
+		memory_resource* _resource;
+	};
+
+	template<class T, class U>
+	bool operator==(const resource_allocator<T>& left, const resource_allocator<U>& right) {
+		return left.resource() == right.resource();
+	}
+
+	template<class T, class U>
+	bool operator!=(const resource_allocator<T>& left, const resource_allocator<U>& right) {
+		return left.resource() != right.resource();
+	}
+
+	/**
+	 * @brief Allocate and construct a single object from a resource.
+	 */
+	template<class T, class... Args>
+	T* new_object(memory_resource* resource, Args&&... args) {
+		void* memory = resource->allocate(sizeof(T), alignof(T));
+		try {
+			return new(memory) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			resource->deallocate(memory, sizeof(T), alignof(T));
+			throw;
+		}
+	}
+
+	/**
+	 * @brief Destroy and deallocate an object created by new_object().
+	 */
+	template<class T>
+	void delete_object(memory_resource* resource, T* p) {
+		if (p) {
+			p->~T();
+			resource->deallocate(p, sizeof(T), alignof(T));
+		}
+	}
+
+	/**
+	 * @brief Allocate n default-constructed objects, the resource counterpart of new T[n].
+	 */
+	template<class T>
+	T* new_array(memory_resource* resource, size_t n) {
+		T* p = static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+		size_t constructed = 0;
+		try {
+			for (; constructed < n; constructed++) {
+				new(p + constructed) T;
+			}
+		}
+		catch (...) {
+			while (constructed > 0) {
+				p[--constructed].~T();
+			}
+			resource->deallocate(p, n * sizeof(T), alignof(T));
+			throw;
+		}
+		return p;
+	}
+
+	/**
+	 * @brief Destroy and deallocate an array created by new_array(), the counterpart of delete[].
+	 */
+	template<class T>
+	void delete_array(memory_resource* resource, T* p, size_t n) {
+		if (p) {
+			for (size_t index = 0; index < n; index++) {
+				p[index].~T();
+			}
+			resource->deallocate(p, n * sizeof(T), alignof(T));
+		}
+	}
+
+}
@@ -0,0 +1,124 @@
+/**
+ * @file pool.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{pool}
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include "arena.h"
+
+namespace Somn {
+
+	/**
+	 * @brief memory_resource that recycles small blocks through per-size free lists.
+	 *
+	 * Meant for node-based containers with steady churn, such as the list
+	 * behind a cache: a freed node is handed out again by the next
+	 * allocation of the same size class, so after warm-up allocation is a
+	 * free-list pop and nothing reaches the upstream resource. Requests are
+	 * rounded up to a multiple of 16 bytes; blocks over max_pooled bytes or
+	 * over-aligned ones go straight to upstream. Memory carved for the pools
+	 * is only returned by release() or the destructor.
+	 *
+	 * Not thread safe; use one pool per container or per thread.
+	 */
+	class pool_resource : public memory_resource {
+	public:
+		/** Largest block size served from the pools. */
+		static constexpr size_t max_pooled = 512;
+
+		/**
+		 * @param upstream Where chunks and large blocks come from.
+		 * @param chunk_size Bytes taken from upstream each time the pools run dry.
+		 */
+		explicit pool_resource(memory_resource* upstream = default_resource(), size_t chunk_size = 64 * 1024)
+			: _upstream(upstream), _chunks(nullptr), _current(nullptr), _end(nullptr),
+			_chunk_size(chunk_size < 4 * max_pooled ? 4 * max_pooled : chunk_size), _free() {}
+
+		pool_resource(const pool_resource&) = delete;
+		pool_resource& operator=(const pool_resource&) = delete;
+
+		~pool_resource() override {
+			release();
+		}
+
+		void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			if (bytes > max_pooled || alignment > granularity) {
+				return _upstream->allocate(bytes, alignment);
+			}
+			size_t index = size_class(bytes);
+			if (free_block* block = _free[index]) {
+				_free[index] = block->_next;
+				return block;
+			}
+			size_t size = (index + 1) * granularity;
+			if (_current == nullptr || _current + size > _end) {
+				grow();
+			}
+			void* p = _current;
+			_current += size;
+			return p;
+		}
+
+		void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			if (bytes > max_pooled || alignment > granularity) {
+				_upstream->deallocate(p, bytes, alignment);
+				return;
+			}
+			size_t index = size_class(bytes);
+			free_block* block = static_cast<free_block*>(p);
+			block->_next = _free[index];
+			_free[index] = block;
+		}
+
+		/**
+		 * @brief Return every chunk to upstream; all pooled blocks become invalid.
+		 */
+		void release() {
+			while (_chunks) {
+				chunk* prev = _chunks->_prev;
+				_upstream->deallocate(_chunks, _chunk_size, alignof(std::max_align_t));
+				_chunks = prev;
+			}
+			_current = _end = nullptr;
+			for (free_block*& head : _free) {
+				head = nullptr;
+			}
+		}
+
+	private:
+		static constexpr size_t granularity = 16;
+
+		struct free_block {
+			free_block* _next;
+		};
+
+		// Header at the start of each chunk; the chunks form a list from newest to oldest
+		struct alignas(std::max_align_t) chunk {
+			chunk* _prev;
+		};
+
+		static size_t size_class(size_t bytes) {
+			return bytes == 0 ? 0 : (bytes - 1) / granularity;
+		}
+
+		void grow() {
+			// The tail of the old chunk is dropped; it is smaller than the block being asked for
+			chunk* fresh = static_cast<chunk*>(_upstream->allocate(_chunk_size, alignof(std::max_align_t)));
+			fresh->_prev = _chunks;
+			_chunks = fresh;
+			_current = reinterpret_cast<char*>(fresh + 1);
+			_end = reinterpret_cast<char*>(fresh) + _chunk_size;
+		}
+
+		memory_resource* _upstream;                    /**< Source of the chunks and large blocks */
+		chunk* _chunks;                                /**< Newest chunk, or nullptr */
+		char* _current;                                /**< Next uncarved byte in the newest chunk */
+		char* _end;                                    /**< End of the newest chunk */
+		size_t _chunk_size;                            /**< Size of each chunk */
+		free_block* _free[max_pooled / granularity];   /**< Free list per size class */
+	};
+
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <iostream>
+#include "arena.h"
+#include "pool.h"
+#include "../vector/myVector.h"
+#include "../vector/vector.h"
+#include "../list/list.h"
+#include "../list/list_en.h"
+#include "../queue/queue.cpp"
+#include "../stack/stack.cpp"
+#include "../priority_queue/priority_queue.h"
+#include "../string/myString.h"
+
+void test_arena() {
+    using namespace Somn;
+
+    // Alignment is honoured and the bump pointer only moves forward
+    arena a(256);
+    char* c = static_cast<char*>(a.allocate(1, 1));
+    double* d = static_cast<double*>(a.allocate(sizeof(double), alignof(double)));
+    void* big = a.allocate(64, 64);
+    std::cout << "aligned: " << (reinterpret_cast<uintptr_t>(d) % alignof(double) == 0)
+              << (reinterpret_cast<uintptr_t>(big) % 64 == 0) << ", ordered " << (static_cast<void*>(c) < static_cast<void*>(d)) << std::endl;
+
+    // Overflowing the first block chains a larger one; reset keeps only the largest
+    for (int i = 0; i < 100; ++i) {
+        a.allocate(100);
+    }
+    size_t reserved = a.bytes_reserved();
+    a.reset();
+    std::cout << "used after reset: " << a.bytes_used() << ", reserved " << reserved << " -> " << a.bytes_reserved() << std::endl;
+
+    // Starting from a stack buffer needs no upstream block until it is full
+    char buffer[1024];
+    arena local(buffer, sizeof(buffer));
+    void* first = local.allocate(16);
+    std::cout << "stack buffer: " << (first == buffer) << ", reserved " << local.bytes_reserved() << std::endl;
+}
+
+void test_pool() {
+    using namespace Somn;
+
+    // A freed block is the next one handed out for the same size class
+    arena upstream;
+    pool_resource pool(&upstream);
+    void* a = pool.allocate(24);
+    void* b = pool.allocate(32);
+    pool.deallocate(a, 24);
+    void* c = pool.allocate(20);
+    size_t reserved = upstream.bytes_used();
+    for (int i = 0; i < 1000; ++i) {
+        pool.deallocate(pool.allocate(40), 40);
+    }
+    std::cout << "pool: reused " << (a == c) << ", distinct " << (a != b) << ", steady churn allocates upstream "
+              << (upstream.bytes_used() != reserved) << std::endl;
+
+    // Node containers recycle through it
+    beat::list<int> list(&pool);
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            list.push_back(i);
+        }
+        list.clear();
+    }
+    std::cout << "pool list churn: upstream bytes " << upstream.bytes_used() << std::endl;
+}
+
+void test_containers() {
+    using namespace Somn;
+    arena a;
+
+    // Every container draws from the same arena and behaves as before
+    {
+        myVector<int> v(&a);
+        Track::vector<double> t(&a);
+        beat::list<int> bl(&a);
+        Somn::list<int> sl(&a);
+        cocoon::myString s(&a);
+        Queue<int> q(&a);
+        Stack<int> st(&a);
+        moon::priority_queue<int> pq(&a);
+        for (int i = 0; i < 100; ++i) {
+            v.push_back(i);
+            t.push_back(i * 0.5);
+            bl.push_back(i);
+            sl.push_front(i);
+            s.append_int(i);
+            q.push(i);
+            st.push(i);
+            pq.push(i * 7 % 100);
+        }
+        std::cout << "arena containers: " << v[99] << " " << t[99] << " " << bl.size() << " " << *sl.begin() << " "
+                  << s.size() << " " << q.front() << " " << st.top() << " " << pq.top() << std::endl;
+        std::cout << "same resource: " << (v.resource() == &a && s.resource() == &a && bl.resource() == &a) << std::endl;
+
+        // Copies do not inherit the arena
+        myVector<int> copy(v);
+        cocoon::myString text_copy(s);
+        std::cout << "copies on heap: " << (copy.resource() == default_resource())
+                  << (text_copy.resource() == default_resource()) << std::endl;
+
+        // Assigning into an arena-backed container keeps it on the arena
+        myVector<int> v2(&a);
+        Track::vector<double> t2(&a);
+        beat::list<int> bl2(&a);
+        Somn::list<int> sl2(&a);
+        v2 = copy;
+        t2 = t;
+        bl2 = bl;
+        sl2 = sl;
+        beat::list<int> bl_heap(bl);
+        bl2 = bl_heap;
+        std::cout << "assigned stay on arena: " << (v2.resource() == &a) << (t2.resource() == &a) << (bl2.resource() == &a)
+                  << (sl2.resource() == &a) << ", contents " << v2[99] << " " << t2[99] << " " << bl2.size() << " "
+                  << *sl2.begin() << std::endl;
+    }
+    std::cout << "arena bytes used: " << a.bytes_used() << std::endl;
+    a.reset();
+}
+
+// One request: parse some fields, collect ids, keep a work queue and pick the top results
+template<class MakeResource>
+long long handle_request(int request, MakeResource resource) {
+    Somn::myVector<int> ids(resource());
+    beat::list<int> pending(resource());
+    cocoon::myString body(resource());
+    Queue<int> work(resource());
+    moon::priority_queue<int> best(resource());
+
+    for (int i = 0; i < 64; ++i) {
+        int id = (request * 31 + i * 17) % 1000;
+        ids.push_back(id);
+        pending.push_back(id);
+        body.append("field=");
+        body.append_int(id);
+        body.push_back('&');
+        work.push(id);
+    }
+    long long sum = 0;
+    while (!work.empty()) {
+        best.push(work.front());
+        work.pop();
+    }
+    for (int i = 0; i < 8; ++i) {
+        sum += best.top();
+        best.pop();
+    }
+    return sum + static_cast<long long>(body.size() + pending.size() + ids.size());
+}
+
+void bench_request_workload() {
+    typedef std::chrono::steady_clock clock;
+    using namespace Somn;
+    const int requests = 200000;
+
+    auto start = clock::now();
+    long long heap_sum = 0;
+    for (int r = 0; r < requests; ++r) {
+        heap_sum += handle_request(r, [] { return default_resource(); });
+    }
+    auto t1 = clock::now();
+
+    arena a;
+    long long arena_sum = 0;
+    for (int r = 0; r < requests; ++r) {
+        arena_sum += handle_request(r, [&a] { return &a; });
+        // All request memory goes back in one step
+        a.reset();
+    }
+    auto t2 = clock::now();
+
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    std::cout << requests << " requests: new/delete " << ms(start, t1) << " ms, arena " << ms(t1, t2)
+              << " ms, arena block " << a.bytes_reserved() << " bytes, same result " << (heap_sum == arena_sum) << std::endl;
+}
+
+int main() {
+    test_arena();
+    test_pool();
+    test_containers();
+    bench_request_workload();
+    return 0;
+}
@@ -0,0 +1,332 @@
+/**
+ * @file algorithm.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{algorithm}
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "thread_pool.h"
+
+namespace Somn {
+
+	/**
+	 * @brief Ranges shorter than this are processed on the calling thread.
+	 */
+	const size_t parallel_threshold = 1 << 14;
+
+	namespace detail {
+
+		// Number of chunks to cut n elements into: a few per worker so that
+		// stealing can even out uneven chunks, but never below the threshold.
+		inline size_t chunk_count(size_t n, const thread_pool& pool)
+		{
+			size_t chunks = pool.size() * 4;
+			size_t most = n / (parallel_threshold / 4) + 1;
+			return chunks < most ? chunks : most;
+		}
+
+		// Call fn(index) for every index in [0, count) on the pool and return
+		// when all calls finished. The calling thread runs chunks as well.
+		template<class Function>
+		void run_chunks(thread_pool& pool, size_t count, Function fn)
+		{
+			pool.parallel_for(0, count, 1, fn);
+		}
+
+		// Beginning of chunk 'index' when n elements are cut into 'count' chunks.
+		inline size_t chunk_begin(size_t n, size_t count, size_t index)
+		{
+			return n / count * index + (index < n % count ? index : n % count);
+		}
+	}
+
+	/**
+	 * @brief Apply f to every element of [first, last).
+	 * @param first The beginning of the range, a random access iterator.
+	 * @param last The end of the range.
+	 * @param f The function to apply; must be safe to call concurrently.
+	 */
+	template<class RandomIt, class Function>
+	void parallel_for_each(RandomIt first, RandomIt last, Function f)
+	{
+		size_t n = last - first;
+		if (n < parallel_threshold) {
+			std::for_each(first, last, f);
+			return;
+		}
+		thread_pool& pool = thread_pool::default_pool();
+		size_t count = detail::chunk_count(n, pool);
+		detail::run_chunks(pool, count, [&](size_t index) {
+			std::for_each(first + detail::chunk_begin(n, count, index),
+				first + detail::chunk_begin(n, count, index + 1), f);
+		});
+	}
+
+	/**
+	 * @brief Store op(x) for every x of [first, last) into the range starting at out.
+	 * @return An iterator past the last element written.
+	 */
+	template<class RandomIt, class OutputIt, class UnaryOperation>
+	OutputIt parallel_transform(RandomIt first, RandomIt last, OutputIt out, UnaryOperation op)
+	{
+		size_t n = last - first;
+		if (n < parallel_threshold) {
+			return std::transform(first, last, out, op);
+		}
+		thread_pool& pool = thread_pool::default_pool();
+		size_t count = detail::chunk_count(n, pool);
+		detail::run_chunks(pool, count, [&](size_t index) {
+			size_t begin = detail::chunk_begin(n, count, index);
+			size_t end = detail::chunk_begin(n, count, index + 1);
+			std::transform(first + begin, first + end, out + begin, op);
+		});
+		return out + n;
+	}
+
+	/**
+	 * @brief Combine init and every element of [first, last) with op.
+	 * @param op An associative operation; elements may be grouped in any order.
+	 * @return The combined value.
+	 */
+	template<class RandomIt, class T, class BinaryOperation>
+	T parallel_reduce(RandomIt first, RandomIt last, T init, BinaryOperation op)
+	{
+		size_t n = last - first;
+		if (n < parallel_threshold) {
+			for (; first != last; ++first) {
+				init = op(init, *first);
+			}
+			return init;
+		}
+		thread_pool& pool = thread_pool::default_pool();
+		size_t count = detail::chunk_count(n, pool);
+		std::vector<T> partial(count, init);
+		detail::run_chunks(pool, count, [&](size_t index) {
+			RandomIt it = first + detail::chunk_begin(n, count, index);
+			RandomIt end = first + detail::chunk_begin(n, count, index + 1);
+			// Every chunk is seeded with its first element so init is used only once.
+			T sum = *it;
+			for (++it; it != end; ++it) {
+				sum = op(sum, *it);
+			}
+			partial[index] = sum;
+		});
+		for (size_t index = 0; index < count; index++) {
+			init = op(init, partial[index]);
+		}
+		return init;
+	}
+
+	/**
+	 * @brief Sum the elements of [first, last) starting from init.
+	 */
+	template<class RandomIt, class T>
+	T parallel_reduce(RandomIt first, RandomIt last, T init)
+	{
+		return parallel_reduce(first, last, init, std::plus<T>());
+	}
+
+	namespace detail {
+
+		// Three passes: reduce every chunk, scan the chunk totals on the calling
+		// thread, then scan every chunk again starting from its offset.
+		template<class RandomIt, class OutputIt, class T, class BinaryOperation>
+		OutputIt scan(RandomIt first, RandomIt last, OutputIt out, T init, BinaryOperation op, bool inclusive)
+		{
+			size_t n = last - first;
+			thread_pool& pool = thread_pool::default_pool();
+			size_t count = chunk_count(n, pool);
+			std::vector<T> offset(count, init);
+			run_chunks(pool, count, [&](size_t index) {
+				if (index + 1 == count) {
+					return; // the last total is never needed
+				}
+				RandomIt it = first + chunk_begin(n, count, index);
+				RandomIt end = first + chunk_begin(n, count, index + 1);
+				T sum = *it;
+				for (++it; it != end; ++it) {
+					sum = op(sum, *it);
+				}
+				offset[index + 1] = sum;
+			});
+			for (size_t index = 1; index < count; index++) {
+				offset[index] = op(offset[index - 1], offset[index]);
+			}
+			run_chunks(pool, count, [&](size_t index) {
+				size_t begin = chunk_begin(n, count, index);
+				size_t end = chunk_begin(n, count, index + 1);
+				T sum = offset[index];
+				for (size_t pos = begin; pos < end; pos++) {
+					if (inclusive) {
+						sum = op(sum, first[pos]);
+						out[pos] = sum;
+					}
+					else {
+						// Read before write so the scan may run in place.
+						T next = op(sum, first[pos]);
+						out[pos] = sum;
+						sum = next;
+					}
+				}
+			});
+			return out + n;
+		}
+	}
+
+	/**
+	 * @brief Write the running totals of [first, last), element i included, to out.
+	 * @param init The value every total starts from.
+	 * @return An iterator past the last element written.
+	 */
+	template<class RandomIt, class OutputIt, class T, class BinaryOperation>
+	OutputIt parallel_inclusive_scan(RandomIt first, RandomIt last, OutputIt out, T init, BinaryOperation op)
+	{
+		if (static_cast<size_t>(last - first) < parallel_threshold) {
+			for (; first != last; ++first, ++out) {
+				init = op(init, *first);
+				*out = init;
+			}
+			return out;
+		}
+		return detail::scan(first, last, out, init, op, true);
+	}
+
+	template<class RandomIt, class OutputIt>
+	OutputIt parallel_inclusive_scan(RandomIt first, RandomIt last, OutputIt out)
+	{
+		typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+		return parallel_inclusive_scan(first, last, out, value_type(), std::plus<value_type>());
+	}
+
+	/**
+	 * @brief Write the running totals of [first, last), element i excluded, to out.
+	 * @param init The value written first and every total starts from.
+	 * @return An iterator past the last element written.
+	 */
+	template<class RandomIt, class OutputIt, class T, class BinaryOperation>
+	OutputIt parallel_exclusive_scan(RandomIt first, RandomIt last, OutputIt out, T init, BinaryOperation op)
+	{
+		if (static_cast<size_t>(last - first) < parallel_threshold) {
+			for (; first != last; ++first, ++out) {
+				T next = op(init, *first);
+				*out = init;
+				init = next;
+			}
+			return out;
+		}
+		return detail::scan(first, last, out, init, op, false);
+	}
+
+	template<class RandomIt, class OutputIt, class T>
+	OutputIt parallel_exclusive_scan(RandomIt first, RandomIt last, OutputIt out, T init)
+	{
+		return parallel_exclusive_scan(first, last, out, init, std::plus<T>());
+	}
+
+	/**
+	 * @brief Sort [first, last) with comp.
+	 *
+	 * Chunks are sorted concurrently and then merged pairwise, every round of
+	 * merges running concurrently, through one temporary buffer.
+	 */
+	template<class RandomIt, class Compare>
+	void parallel_sort(RandomIt first, RandomIt last, Compare comp)
+	{
+		typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+		size_t n = last - first;
+		if (n < parallel_threshold) {
+			std::sort(first, last, comp);
+			return;
+		}
+		thread_pool& pool = thread_pool::default_pool();
+		size_t count = detail::chunk_count(n, pool);
+		std::vector<size_t> bounds(count + 1);
+		for (size_t index = 0; index <= count; index++) {
+			bounds[index] = detail::chunk_begin(n, count, index);
+		}
+		detail::run_chunks(pool, count, [&](size_t index) {
+			std::sort(first + bounds[index], first + bounds[index + 1], comp);
+		});
+
+		std::vector<value_type> buffer(first, last);
+		bool in_buffer = false; // which side holds the current runs
+		for (size_t width = 1; width < count; width *= 2) {
+			size_t merges = (count + 2 * width - 1) / (2 * width);
+			detail::run_chunks(pool, merges, [&](size_t index) {
+				size_t low = bounds[index * 2 * width];
+				size_t mid = bounds[std::min(count, index * 2 * width + width)];
+				size_t high = bounds[std::min(count, index * 2 * width + 2 * width)];
+				if (in_buffer) {
+					std::merge(buffer.begin() + low, buffer.begin() + mid,
+						buffer.begin() + mid, buffer.begin() + high, first + low, comp);
+				}
+				else {
+					std::merge(first + low, first + mid, first + mid, first + high,
+						buffer.begin() + low, comp);
+				}
+			});
+			in_buffer = !in_buffer;
+		}
+		if (in_buffer) {
+			parallel_transform(buffer.begin(), buffer.end(), first,
+				[](const value_type& val) { return val; });
+		}
+	}
+
+	template<class RandomIt>
+	void parallel_sort(RandomIt first, RandomIt last)
+	{
+		typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+		parallel_sort(first, last, std::less<value_type>());
+	}
+
+	/**
+	 * @brief Find the first element of [first, last) for which pred is true.
+	 * @return An iterator to that element, or last if there is none.
+	 */
+	template<class RandomIt, class Predicate>
+	RandomIt parallel_find_if(RandomIt first, RandomIt last, Predicate pred)
+	{
+		size_t n = last - first;
+		if (n < parallel_threshold) {
+			return std::find_if(first, last, pred);
+		}
+		thread_pool& pool = thread_pool::default_pool();
+		size_t count = detail::chunk_count(n, pool);
+		std::atomic<size_t> found(n);
+		detail::run_chunks(pool, count, [&](size_t index) {
+			size_t begin = detail::chunk_begin(n, count, index);
+			size_t end = detail::chunk_begin(n, count, index + 1);
+			for (size_t pos = begin; pos < end; pos++) {
+				// Stop as soon as an earlier chunk has a match; check every few elements.
+				if ((pos & 1023) == 0 && found.load(std::memory_order_relaxed) < begin) {
+					return;
+				}
+				if (pred(first[pos])) {
+					size_t current = found.load(std::memory_order_relaxed);
+					while (pos < current && !found.compare_exchange_weak(current, pos)) {
+					}
+					return;
+				}
+			}
+		});
+		return first + found.load();
+	}
+
+	/**
+	 * @brief Find the first element of [first, last) equal to val.
+	 * @return An iterator to that element, or last if there is none.
+	 */
+	template<class RandomIt, class T>
+	RandomIt parallel_find(RandomIt first, RandomIt last, const T& val)
+	{
+		typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+		return parallel_find_if(first, last, [&val](const value_type& elem) { return elem == val; });
+	}
+
+}
@@ -0,0 +1,184 @@
+/**
+ * @file chase_lev_deque.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{chase_lev_deque}
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace Somn {
+
+	/**
+	 * @brief Lock-free work-stealing deque (Chase and Lev, with the memory orders
+	 *        of Le, Pop, Cohen and Zappa Nardelli, PPoPP 2013).
+	 *
+	 * Only the owning thread may call push() and pop(), which work on the bottom
+	 * end. Any thread may call steal(), which takes from the top end.
+	 * @tparam T A trivially copyable element type, usually a pointer.
+	 */
+	template<class T>
+	class chase_lev_deque {
+	public:
+		/**
+		 * @brief Construct an empty deque.
+		 * @param capacity Initial capacity, rounded up to a power of two.
+		 */
+		explicit chase_lev_deque(size_t capacity = 64);
+
+		chase_lev_deque(const chase_lev_deque&) = delete;
+		chase_lev_deque& operator=(const chase_lev_deque&) = delete;
+
+		~chase_lev_deque();
+
+		/**
+		 * @brief Push an element on the bottom end. Owner thread only.
+		 * @param val The element to push.
+		 */
+		void push(T val);
+
+		/**
+		 * @brief Pop the element on the bottom end. Owner thread only.
+		 * @param val Receives the element.
+		 * @return True if an element was popped, false if the deque was empty.
+		 */
+		bool pop(T& val);
+
+		/**
+		 * @brief Take the element on the top end. Any thread.
+		 * @param val Receives the element.
+		 * @return True if an element was stolen, false if the deque was empty
+		 *         or another thread won the race for the element.
+		 */
+		bool steal(T& val);
+
+		/**
+		 * @brief Get an estimate of the number of elements.
+		 */
+		size_t size() const;
+
+	private:
+		// Circular buffer. Replaced buffers are kept until the deque dies because
+		// a thief may still be reading from one.
+		struct ring {
+			size_t _mask;
+			std::atomic<T>* _slots;
+			ring* _retired;
+
+			ring(size_t capacity, ring* retired)
+				: _mask(capacity - 1), _slots(new std::atomic<T>[capacity]), _retired(retired) {}
+			~ring() { delete[] _slots; }
+
+			T get(long index) const { return _slots[index & _mask].load(std::memory_order_relaxed); }
+			void put(long index, T val) { _slots[index & _mask].store(val, std::memory_order_relaxed); }
+		};
+
+		ring* grow(ring* old, long bottom, long top);
+
+		// top and bottom live on separate cache lines, thieves hammer top.
+		alignas(64) std::atomic<long> _top;
+		alignas(64) std::atomic<long> _bottom;
+		alignas(64) std::atomic<ring*> _ring;
+	};
+
+	template<class T>
+	inline chase_lev_deque<T>::chase_lev_deque(size_t capacity)
+		: _top(0), _bottom(0)
+	{
+		size_t rounded = 1;
+		while (rounded < capacity) {
+			rounded *= 2;
+		}
+		_ring.store(new ring(rounded, nullptr), std::memory_order_relaxed);
+	}
+
+	template<class T>
+	inline chase_lev_deque<T>::~chase_lev_deque()
+	{
+		ring* cur = _ring.load(std::memory_order_relaxed);
+		while (cur) {
+			ring* next = cur->_retired;
+			delete cur;
+			cur = next;
+		}
+	}
+
+	template<class T>
+	inline typename chase_lev_deque<T>::ring* chase_lev_deque<T>::grow(ring* old, long bottom, long top)
+	{
+		ring* bigger = new ring((old->_mask + 1) * 2, old);
+		for (long index = top; index < bottom; index++) {
+			bigger->put(index, old->get(index));
+		}
+		_ring.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+	template<class T>
+	inline void chase_lev_deque<T>::push(T val)
+	{
+		long bottom = _bottom.load(std::memory_order_relaxed);
+		long top = _top.load(std::memory_order_acquire);
+		ring* cur = _ring.load(std::memory_order_relaxed);
+		if (bottom - top > static_cast<long>(cur->_mask)) {
+			cur = grow(cur, bottom, top);
+		}
+		cur->put(bottom, val);
+		// Publishes the slot to thieves, which read bottom with acquire.
+		_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	template<class T>
+	inline bool chase_lev_deque<T>::pop(T& val)
+	{
+		long bottom = _bottom.load(std::memory_order_relaxed) - 1;
+		ring* cur = _ring.load(std::memory_order_relaxed);
+		_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long top = _top.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			// Empty, undo the reservation.
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+		val = cur->get(bottom);
+		if (top == bottom) {
+			// Last element, race the thieves for it.
+			bool won = _top.compare_exchange_strong(top, top + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	template<class T>
+	inline bool chase_lev_deque<T>::steal(T& val)
+	{
+		long top = _top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long bottom = _bottom.load(std::memory_order_acquire);
+		if (top >= bottom) {
+			return false;
+		}
+		ring* cur = _ring.load(std::memory_order_acquire);
+		T candidate = cur->get(top);
+		if (!_top.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return false;
+		}
+		val = candidate;
+		return true;
+	}
+
+	template<class T>
+	inline size_t chase_lev_deque<T>::size() const
+	{
+		long bottom = _bottom.load(std::memory_order_relaxed);
+		long top = _top.load(std::memory_order_relaxed);
+		return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+	}
+
+}
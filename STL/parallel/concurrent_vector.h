@@ -0,0 +1,465 @@
+/**
+ * @file concurrent_vector.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{concurrent_vector}
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "../memory/arena.h"
+
+namespace Somn {
+
+	/**
+	 * @brief Append-only vector that many threads can grow at once.
+	 *
+	 * Elements live in segments that double in size and never move: segment k
+	 * holds 16 * 2^k elements, so element addresses stay valid for the life of
+	 * the vector. push_back() and grow_by() claim indices with one fetch_add on
+	 * the size. The thread that claims the first index of a segment allocates
+	 * it; a thread landing in a segment that is still being allocated spins
+	 * until it appears, which happens at most once per segment.
+	 *
+	 * size() counts claimed indices, some of which may still be under
+	 * construction. A reader may access element i once the push_back() that
+	 * returned i happens-before the access, e.g. because the writer published
+	 * i through a release store, a queue or a join.
+	 *
+	 * Elements must be nothrow constructible from the given arguments: an index
+	 * is counted before its element is built, so a throwing constructor would
+	 * leave a hole that clear() cannot tell apart. If allocating a segment
+	 * fails, the segment is marked failed and every call that claimed indices
+	 * in it throws (std::bad_alloc for the threads that did not allocate) after
+	 * constructing its elements in the segments that do exist. After such a
+	 * failure the vector may only be cleared or destroyed; clear() makes it usable again.
+	 * @tparam T The element type.
+	 */
+	template<class T>
+	class concurrent_vector {
+	public:
+		template<class Vector, class Ref>
+		class iterator_base;
+
+		typedef iterator_base<concurrent_vector, T&> iterator;
+		typedef iterator_base<const concurrent_vector, const T&> const_iterator;
+
+		/**
+		 * @brief Construct an empty vector.
+		 * @param resource Source of the segments.
+		 */
+		explicit concurrent_vector(memory_resource* resource = default_resource());
+
+		concurrent_vector(const concurrent_vector&) = delete;
+		concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+		~concurrent_vector();
+
+		/**
+		 * @brief Append a copy of val. Any thread.
+		 * @return The index of the new element.
+		 */
+		size_t push_back(const T& val);
+
+		/**
+		 * @brief Append val by moving it. Any thread.
+		 * @return The index of the new element.
+		 */
+		size_t push_back(T&& val);
+
+		/**
+		 * @brief Append an element constructed from args. Any thread.
+		 * @return The index of the new element.
+		 */
+		template<class... Args>
+		size_t emplace_back(Args&&... args);
+
+		/**
+		 * @brief Append n copies of val as one contiguous range of indices. Any thread.
+		 * @return The index of the first new element.
+		 */
+		size_t grow_by(size_t n, const T& val = T());
+
+		/**
+		 * @brief Append copies of [first, last) as one contiguous range of indices. Any thread.
+		 * @return The index of the first new element.
+		 */
+		template<class ForwardIterator>
+		size_t grow_by(ForwardIterator first, ForwardIterator last);
+
+		/**
+		 * @brief Get the element at index, without bounds checking.
+		 */
+		T& operator[](size_t index);
+		const T& operator[](size_t index) const;
+
+		/**
+		 * @brief Get the element at index.
+		 * @throws std::out_of_range when index >= size().
+		 */
+		T& at(size_t index);
+		const T& at(size_t index) const;
+
+		/**
+		 * @brief Get the number of claimed indices.
+		 */
+		size_t size() const;
+
+		bool empty() const;
+
+		/**
+		 * @brief Get the number of elements the allocated segments can hold.
+		 */
+		size_t capacity() const;
+
+		/**
+		 * @brief Destroy all elements and free the segments. Not thread-safe.
+		 */
+		void clear();
+
+		iterator begin();
+		iterator end();
+		const_iterator begin() const;
+		const_iterator end() const;
+
+	private:
+		static constexpr size_t first_bits = 4;
+		static constexpr size_t segment_count = 64 - first_bits;
+
+		static size_t segment_of(size_t index);
+		static size_t segment_base(size_t segment);
+		static size_t segment_size(size_t segment);
+
+		// Stands in for a segment whose allocation threw; never dereferenced
+		static T* failed_segment();
+
+		// Claim n indices and wait for their segments; error is set when one of them failed
+		size_t claim(size_t n, std::exception_ptr& error);
+		T* segment_at(size_t segment) const;
+		T* slot(size_t index) const;
+		// Slot of index, or nullptr when its segment failed
+		T* slot_or_null(size_t index) const;
+
+		memory_resource* _resource;
+		// Writers hammer the size; keep it away from the segment table readers load.
+		alignas(64) std::atomic<size_t> _size;
+		alignas(64) std::atomic<T*> _segments[segment_count];
+	};
+
+	/**
+	 * @brief Random-access iterator by index; valid across concurrent growth.
+	 */
+	template<class T>
+	template<class Vector, class Ref>
+	class concurrent_vector<T>::iterator_base {
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef ptrdiff_t difference_type;
+		typedef std::remove_reference_t<Ref>* pointer;
+		typedef Ref reference;
+
+		iterator_base() : _vector(nullptr), _index(0) {}
+		iterator_base(Vector* vector, size_t index) : _vector(vector), _index(index) {}
+
+		Ref operator*() const { return (*_vector)[_index]; }
+		pointer operator->() const { return &(*_vector)[_index]; }
+		Ref operator[](difference_type n) const { return (*_vector)[_index + n]; }
+
+		iterator_base& operator++() { ++_index; return *this; }
+		iterator_base operator++(int) { iterator_base temp(*this); ++_index; return temp; }
+		iterator_base& operator--() { --_index; return *this; }
+		iterator_base operator--(int) { iterator_base temp(*this); --_index; return temp; }
+		iterator_base& operator+=(difference_type n) { _index += n; return *this; }
+		iterator_base& operator-=(difference_type n) { _index -= n; return *this; }
+		iterator_base operator+(difference_type n) const { return iterator_base(_vector, _index + n); }
+		iterator_base operator-(difference_type n) const { return iterator_base(_vector, _index - n); }
+		difference_type operator-(const iterator_base& it) const {
+			return static_cast<difference_type>(_index) - static_cast<difference_type>(it._index);
+		}
+
+		bool operator==(const iterator_base& it) const { return _index == it._index; }
+		bool operator!=(const iterator_base& it) const { return _index != it._index; }
+		bool operator<(const iterator_base& it) const { return _index < it._index; }
+		bool operator>(const iterator_base& it) const { return _index > it._index; }
+		bool operator<=(const iterator_base& it) const { return _index <= it._index; }
+		bool operator>=(const iterator_base& it) const { return _index >= it._index; }
+
+	private:
+		Vector* _vector;
+		size_t _index;
+	};
+
+	template<class T>
+	inline concurrent_vector<T>::concurrent_vector(memory_resource* resource)
+		: _resource(resource), _size(0)
+	{
+		for (size_t segment = 0; segment < segment_count; segment++) {
+			_segments[segment].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	template<class T>
+	inline concurrent_vector<T>::~concurrent_vector()
+	{
+		clear();
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::segment_of(size_t index)
+	{
+		return 63 - __builtin_clzll(index + (size_t(1) << first_bits)) - first_bits;
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::segment_base(size_t segment)
+	{
+		return (size_t(1) << (segment + first_bits)) - (size_t(1) << first_bits);
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::segment_size(size_t segment)
+	{
+		return size_t(1) << (segment + first_bits);
+	}
+
+	template<class T>
+	inline T* concurrent_vector<T>::segment_at(size_t segment) const
+	{
+		return _segments[segment].load(std::memory_order_acquire);
+	}
+
+	template<class T>
+	inline T* concurrent_vector<T>::slot(size_t index) const
+	{
+		size_t segment = segment_of(index);
+		return segment_at(segment) + (index - segment_base(segment));
+	}
+
+	template<class T>
+	inline T* concurrent_vector<T>::failed_segment()
+	{
+		static char marker;
+		return reinterpret_cast<T*>(&marker);
+	}
+
+	template<class T>
+	inline T* concurrent_vector<T>::slot_or_null(size_t index) const
+	{
+		size_t segment = segment_of(index);
+		T* base = segment_at(segment);
+		return base == failed_segment() ? nullptr : base + (index - segment_base(segment));
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::claim(size_t n, std::exception_ptr& error)
+	{
+		size_t first = _size.fetch_add(n, std::memory_order_relaxed);
+		if (n == 0) {
+			return first;
+		}
+		size_t low = segment_of(first), high = segment_of(first + n - 1);
+		// Allocate the segments this range starts, then wait for the ones it
+		// only enters; owners never wait, and always publish either the
+		// segment or the failure marker, so the waits always end.
+		for (size_t segment = low; segment <= high; segment++) {
+			if (segment_base(segment) >= first) {
+				T* base;
+				try {
+					base = static_cast<T*>(_resource->allocate(segment_size(segment) * sizeof(T), alignof(T)));
+				}
+				catch (...) {
+					error = std::current_exception();
+					base = failed_segment();
+				}
+				_segments[segment].store(base, std::memory_order_release);
+			}
+		}
+		for (size_t segment = low; segment <= high; segment++) {
+			T* base;
+			while ((base = segment_at(segment)) == nullptr) {
+				std::this_thread::yield();
+			}
+			if (base == failed_segment() && !error) {
+				error = std::make_exception_ptr(std::bad_alloc());
+			}
+		}
+		return first;
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::push_back(const T& val)
+	{
+		return emplace_back(val);
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::push_back(T&& val)
+	{
+		return emplace_back(std::move(val));
+	}
+
+	template<class T>
+	template<class... Args>
+	inline size_t concurrent_vector<T>::emplace_back(Args&&... args)
+	{
+		static_assert(std::is_nothrow_constructible<T, Args&&...>::value,
+			"concurrent_vector counts an index before constructing its element");
+		std::exception_ptr error;
+		size_t index = claim(1, error);
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		new (slot(index)) T(std::forward<Args>(args)...);
+		return index;
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::grow_by(size_t n, const T& val)
+	{
+		static_assert(std::is_nothrow_copy_constructible<T>::value,
+			"concurrent_vector counts an index before constructing its element");
+		std::exception_ptr error;
+		size_t first = claim(n, error);
+		for (size_t index = first; index < first + n; index++) {
+			// After a failure, fill what exists so clear() only meets constructed elements
+			if (T* p = error ? slot_or_null(index) : slot(index)) {
+				new (p) T(val);
+			}
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		return first;
+	}
+
+	template<class T>
+	template<class ForwardIterator>
+	inline size_t concurrent_vector<T>::grow_by(ForwardIterator first, ForwardIterator last)
+	{
+		static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value,
+			"concurrent_vector counts an index before constructing its element");
+		std::exception_ptr error;
+		size_t start = claim(static_cast<size_t>(std::distance(first, last)), error);
+		for (size_t index = start; first != last; ++first, ++index) {
+			if (T* p = error ? slot_or_null(index) : slot(index)) {
+				new (p) T(*first);
+			}
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		return start;
+	}
+
+	template<class T>
+	inline T& concurrent_vector<T>::operator[](size_t index)
+	{
+		return *slot(index);
+	}
+
+	template<class T>
+	inline const T& concurrent_vector<T>::operator[](size_t index) const
+	{
+		return *slot(index);
+	}
+
+	template<class T>
+	inline T& concurrent_vector<T>::at(size_t index)
+	{
+		if (index >= size()) {
+			throw std::out_of_range("concurrent_vector::at");
+		}
+		return *slot(index);
+	}
+
+	template<class T>
+	inline const T& concurrent_vector<T>::at(size_t index) const
+	{
+		if (index >= size()) {
+			throw std::out_of_range("concurrent_vector::at");
+		}
+		return *slot(index);
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::size() const
+	{
+		return _size.load(std::memory_order_acquire);
+	}
+
+	template<class T>
+	inline bool concurrent_vector<T>::empty() const
+	{
+		return size() == 0;
+	}
+
+	template<class T>
+	inline size_t concurrent_vector<T>::capacity() const
+	{
+		size_t total = 0;
+		for (size_t segment = 0; segment < segment_count; segment++) {
+			T* base = segment_at(segment);
+			if (base != nullptr && base != failed_segment()) {
+				total += segment_size(segment);
+			}
+		}
+		return total;
+	}
+
+	template<class T>
+	inline void concurrent_vector<T>::clear()
+	{
+		size_t n = _size.load(std::memory_order_relaxed);
+		// A failed segment may sit between allocated ones, so visit them all
+		for (size_t segment = 0; segment < segment_count; segment++) {
+			T* base = _segments[segment].load(std::memory_order_relaxed);
+			if (base == nullptr) {
+				continue;
+			}
+			if (base == failed_segment()) {
+				_segments[segment].store(nullptr, std::memory_order_relaxed);
+				continue;
+			}
+			size_t begin = segment_base(segment);
+			for (size_t index = begin; index < n && index < begin + segment_size(segment); index++) {
+				base[index - begin].~T();
+			}
+			_resource->deallocate(base, segment_size(segment) * sizeof(T), alignof(T));
+			_segments[segment].store(nullptr, std::memory_order_relaxed);
+		}
+		_size.store(0, std::memory_order_relaxed);
+	}
+
+	template<class T>
+	inline typename concurrent_vector<T>::iterator concurrent_vector<T>::begin()
+	{
+		return iterator(this, 0);
+	}
+
+	template<class T>
+	inline typename concurrent_vector<T>::iterator concurrent_vector<T>::end()
+	{
+		return iterator(this, size());
+	}
+
+	template<class T>
+	inline typename concurrent_vector<T>::const_iterator concurrent_vector<T>::begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	template<class T>
+	inline typename concurrent_vector<T>::const_iterator concurrent_vector<T>::end() const
+	{
+		return const_iterator(this, size());
+	}
+
+}
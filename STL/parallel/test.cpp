@@ -0,0 +1,276 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "algorithm.h"
+#include "concurrent_vector.h"
+#include "../vector/myVector.h"
+#include "../vector/vector.h"
+
+void test_algorithms() {
+    using namespace Somn;
+
+    // Fill a myVector large enough to take the parallel path
+    myVector<long long> v;
+    for (long long i = 0; i < 1000000; ++i) {
+        v.push_back(i % 1000);
+    }
+
+    // Compare the parallel results against serial ones
+    long long serial = 0;
+    for (auto it = v.begin(); it != v.end(); ++it) {
+        serial += *it;
+    }
+    std::cout << "reduce: " << parallel_reduce(v.begin(), v.end(), 0LL) << " (serial " << serial << ")" << std::endl;
+
+    myVector<long long> scanned(v.size(), 0LL);
+    parallel_inclusive_scan(v.begin(), v.end(), scanned.begin());
+    std::cout << "inclusive scan last: " << scanned[scanned.size() - 1] << std::endl;
+
+    parallel_exclusive_scan(v.begin(), v.end(), scanned.begin(), 0LL);
+    std::cout << "exclusive scan last: " << scanned[scanned.size() - 1] + v[v.size() - 1] << std::endl;
+
+    parallel_for_each(v.begin(), v.end(), [](long long& x) { x = 999 - x; });
+    parallel_sort(v.begin(), v.end());
+    std::cout << "sorted: " << std::is_sorted(v.begin(), v.end()) << std::endl;
+
+    auto it = parallel_find(v.begin(), v.end(), 500LL);
+    std::cout << "first 500 at index " << (it - v.begin()) << std::endl;
+
+    // Track::vector works the same way, its iterators are pointers too
+    Track::vector<double> d(200000, 1.5);
+    Track::vector<double> out(200000, 0.0);
+    parallel_transform(d.begin(), d.end(), out.begin(), [](double x) { return x * 2; });
+    std::cout << "transform sum: " << parallel_reduce(out.begin(), out.end(), 0.0) << std::endl;
+}
+
+void bench_reduce() {
+    using namespace Somn;
+    typedef std::chrono::steady_clock clock;
+
+    myVector<double> v(20000000, 1.0);
+
+    auto start = clock::now();
+    double serial = 0;
+    for (auto it = v.begin(); it != v.end(); ++it) {
+        serial += *it;
+    }
+    auto middle = clock::now();
+    double parallel = parallel_reduce(v.begin(), v.end(), 0.0);
+    auto stop = clock::now();
+
+    std::cout << "serial reduce:   " << std::chrono::duration<double, std::milli>(middle - start).count()
+              << " ms (" << serial << ")" << std::endl;
+    std::cout << "parallel reduce: " << std::chrono::duration<double, std::milli>(stop - middle).count()
+              << " ms (" << parallel << ") on " << thread_pool::default_pool().size() << " workers" << std::endl;
+}
+
+// Fork-join: every call forks one child as a task and waits on it by helping
+long long fib(Somn::thread_pool& pool, int n) {
+    if (n < 20) {
+        return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    }
+    std::future<long long> left = pool.submit([&pool, n] { return fib(pool, n - 1); });
+    long long right = fib(pool, n - 2);
+    return pool.wait(left) + right;
+}
+
+void bench_thread_pool() {
+    using namespace Somn;
+    typedef std::chrono::steady_clock clock;
+
+    thread_pool pool;
+
+    auto start = clock::now();
+    long long result = fib(pool, 32);
+    auto stop = clock::now();
+    std::cout << "fork-join fib(32) = " << result << ": "
+              << std::chrono::duration<double, std::milli>(stop - start).count() << " ms" << std::endl;
+
+    // Many tiny tasks, submitted from outside the pool through the injection queue
+    const int tasks = 1000000;
+    std::atomic<int> counter(0);
+    start = clock::now();
+    for (int i = 0; i < tasks; ++i) {
+        pool.execute([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+    }
+    pool.help_while_waiting([&] { return counter.load() == tasks; });
+    stop = clock::now();
+    std::cout << tasks << " tiny external tasks: "
+              << std::chrono::duration<double, std::milli>(stop - start).count() << " ms" << std::endl;
+
+    // The same number of tiny tasks spawned from inside the pool by parallel_for
+    counter = 0;
+    start = clock::now();
+    pool.parallel_for(0, tasks, 1, [&counter](size_t) { counter.fetch_add(1, std::memory_order_relaxed); });
+    stop = clock::now();
+    std::cout << tasks << " tiny parallel_for tasks: "
+              << std::chrono::duration<double, std::milli>(stop - start).count() << " ms" << std::endl;
+}
+
+void test_concurrent_vector() {
+    using namespace Somn;
+
+    concurrent_vector<long long> v;
+    long long* first = &v[v.push_back(-1)];
+
+    // Writers append ids and publish the highest index they finished; a reader follows along
+    const int writers = 4, per_writer = 100000;
+    std::atomic<size_t> published(0);
+    std::atomic<bool> done(false);
+    size_t reader_errors = 0;
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            size_t seen = published.load(std::memory_order_acquire);
+            if (seen != 0 && v[seen] < 0) {
+                reader_errors++;
+            }
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < writers; ++t) {
+        threads.emplace_back([&v, &published, t] {
+            for (int i = 0; i < per_writer; ++i) {
+                size_t index = i % 100 == 0 ? v.grow_by(1, static_cast<long long>(t) * per_writer + i)
+                                            : v.push_back(static_cast<long long>(t) * per_writer + i);
+                size_t seen = published.load(std::memory_order_relaxed);
+                while (seen < index && !published.compare_exchange_weak(seen, index, std::memory_order_release)) {
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    // Every id exactly once, the first element never moved
+    std::vector<int> counts(writers * per_writer, 0);
+    for (auto it = v.begin() + 1; it != v.end(); ++it) {
+        counts[*it]++;
+    }
+    size_t wrong = 0;
+    for (int count : counts) {
+        wrong += count != 1;
+    }
+    std::cout << "concurrent_vector: size " << v.size() << ", wrong counts " << wrong << ", first element stable " << (first == &v[0])
+              << ", capacity " << v.capacity() << ", reader errors " << reader_errors << std::endl;
+
+    // grow_by hands out one contiguous range
+    int values[] = {7, 8, 9};
+    size_t start = v.grow_by(values, values + 3);
+    bool threw = false;
+    try {
+        v.at(v.size());
+    }
+    catch (const std::out_of_range&) {
+        threw = true;
+    }
+    std::cout << "grow_by range: " << v[start] << " " << v[start + 1] << " " << v[start + 2] << ", at(size) throws " << threw << std::endl;
+}
+
+// Throws on one chosen allocation, forwards the rest
+class failing_resource : public Somn::memory_resource {
+public:
+    explicit failing_resource(int fail_at) : _fail_at(fail_at), _count(0) {}
+
+    void* allocate(size_t bytes, size_t alignment) override {
+        if (++_count == _fail_at) {
+            throw std::bad_alloc();
+        }
+        return Somn::default_resource()->allocate(bytes, alignment);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) override {
+        Somn::default_resource()->deallocate(p, bytes, alignment);
+    }
+
+private:
+    int _fail_at, _count;
+};
+
+struct counted {
+    static int live;
+    int value;
+    counted(int v) noexcept : value(v) { live++; }
+    counted(const counted& other) noexcept : value(other.value) { live++; }
+    ~counted() { live--; }
+};
+int counted::live = 0;
+
+void test_concurrent_vector_bad_alloc() {
+    // Segment 0 holds 16 elements, segment 1 (the second allocation) fails
+    failing_resource resource(2);
+    Somn::concurrent_vector<counted> v(&resource);
+    for (int i = 0; i < 16; ++i) {
+        v.push_back(counted(i));
+    }
+    int throws = 0;
+    for (int i = 0; i < 2; ++i) {
+        try {
+            v.push_back(counted(i));
+        }
+        catch (const std::bad_alloc&) {
+            throws++;
+        }
+    }
+    // Spans the failed segment 1 into segment 2, which is built before the throw
+    try {
+        v.grow_by(80, counted(7));
+    }
+    catch (const std::bad_alloc&) {
+        throws++;
+    }
+    int live = counted::live;
+    v.clear();
+    std::cout << "concurrent_vector bad_alloc: throws " << throws << ", live before clear " << live
+              << ", after clear " << counted::live << ", reusable " << (v[v.push_back(counted(5))].value == 5) << std::endl;
+}
+
+template<class Append>
+double time_appends(int threads, size_t total, Append append) {
+    typedef std::chrono::steady_clock clock;
+    auto start = clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&append, t, threads, total] {
+            for (size_t i = t; i < total; i += threads) {
+                append(i);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+}
+
+void bench_concurrent_vector() {
+    const size_t total = 8000000;
+    std::cout << total << " appends, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    for (int threads : {1, 2, 4, 8}) {
+        Somn::concurrent_vector<size_t> lock_free;
+        double lock_free_ms = time_appends(threads, total, [&lock_free](size_t i) { lock_free.push_back(i); });
+
+        std::vector<size_t> locked;
+        std::mutex mutex;
+        double locked_ms = time_appends(threads, total, [&locked, &mutex](size_t i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            locked.push_back(i);
+        });
+        std::cout << "  " << threads << " threads: concurrent_vector " << lock_free_ms << " ms, std::vector + mutex "
+                  << locked_ms << " ms" << std::endl;
+    }
+}
+
+int main() {
+    test_algorithms();
+    test_concurrent_vector();
+    test_concurrent_vector_bad_alloc();
+    bench_reduce();
+    bench_thread_pool();
+    bench_concurrent_vector();
+    return 0;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file thread_pool.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{thread_pool}
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "chase_lev_deque.h"
+#include "../queue/queue.cpp"
+
+namespace Somn {
+
+	/**
+	 * @brief Fixed-size work-stealing thread pool.
+	 *
+	 * Every worker owns a chase_lev_deque: it pushes and pops tasks on the bottom
+	 * end, idle workers steal from the top end. Tasks submitted by threads that
+	 * are not workers of the pool go through a global injection queue.
+	 */
+	class thread_pool {
+	public:
+		typedef std::function<void()> task;
+
+		/**
+		 * @brief Start a pool with the given number of workers.
+		 * @param threads Number of worker threads, 0 means hardware_concurrency().
+		 */
+		explicit thread_pool(size_t threads = 0);
+
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		/**
+		 * @brief Stop all workers; tasks still queued are dropped.
+		 */
+		~thread_pool();
+
+		/**
+		 * @brief Queue a task for execution, without a way to wait for it.
+		 * @param t The task to run. Called on a worker thread, or on a thread
+		 *          helping through run_pending_task().
+		 */
+		void execute(task t);
+
+		/**
+		 * @brief Queue a callable and get a future for its result.
+		 * @param f The callable, invoked without arguments.
+		 * @return A future that becomes ready when f returned or threw.
+		 */
+		template<class Function>
+		auto submit(Function f) -> std::future<decltype(f())>;
+
+		/**
+		 * @brief Wait for a future, running queued tasks while it is not ready.
+		 * Workers must wait this way on their children, a blocking get() inside a
+		 * task can deadlock the pool.
+		 * @param fut The future to wait for.
+		 * @return The value of fut.get().
+		 */
+		template<class R>
+		R wait(std::future<R>& fut);
+
+		/**
+		 * @brief Call f(i) for every i in [first, last) and return when all calls finished.
+		 *
+		 * The range is split in halves recursively: one half is pushed for
+		 * stealing, the other half is split further, down to 'grain' indices.
+		 * @param first The first index.
+		 * @param last One past the last index.
+		 * @param grain Number of indices below which a range is not split any more.
+		 * @param f The function to call; must be safe to call concurrently.
+		 */
+		template<class Function>
+		void parallel_for(size_t first, size_t last, size_t grain, Function f);
+
+		/**
+		 * @brief Run one queued task on the calling thread, if there is one.
+		 * @return True if a task was run.
+		 */
+		bool run_pending_task();
+
+		/**
+		 * @brief Keep running queued tasks until done() returns true.
+		 * Lets a thread that waits on child tasks help instead of blocking.
+		 */
+		template<class Predicate>
+		void help_while_waiting(Predicate done);
+
+		/**
+		 * @brief Get the number of worker threads.
+		 */
+		size_t size() const;
+
+		/**
+		 * @brief Get the process-wide pool used by the parallel algorithms.
+		 */
+		static thread_pool& default_pool();
+
+	private:
+		bool take(task*& t);
+		void worker_loop(size_t index);
+		void notify();
+
+		size_t current_index() const;
+
+		struct worker_identity {
+			const thread_pool* _pool;
+			size_t _index;
+		};
+		static worker_identity& identity();
+
+		std::vector<chase_lev_deque<task*>*> _deques; /**< One deque per worker */
+		std::vector<std::thread> _threads;            /**< Worker threads */
+		Queue<task*> _injector;                        /**< Tasks from outside the pool */
+		std::mutex _injector_lock;
+		std::atomic<size_t> _pending;                  /**< Number of queued but not started tasks */
+		std::atomic<bool> _stop;
+		std::mutex _sleep_lock;
+		std::condition_variable _wake;
+	};
+
+	inline thread_pool::thread_pool(size_t threads)
+		: _pending(0), _stop(false)
+	{
+		if (threads == 0) {
+			threads = std::thread::hardware_concurrency();
+			if (threads == 0) {
+				threads = 1;
+			}
+		}
+		for (size_t index = 0; index < threads; index++) {
+			_deques.push_back(new chase_lev_deque<task*>());
+		}
+		for (size_t index = 0; index < threads; index++) {
+			_threads.emplace_back(&thread_pool::worker_loop, this, index);
+		}
+	}
+
+	inline thread_pool::~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(_sleep_lock);
+			_stop = true;
+		}
+		_wake.notify_all();
+		for (size_t index = 0; index < _threads.size(); index++) {
+			_threads[index].join();
+		}
+		task* t;
+		for (size_t index = 0; index < _deques.size(); index++) {
+			while (_deques[index]->steal(t)) {
+				delete t;
+			}
+			delete _deques[index];
+		}
+		while (!_injector.empty()) {
+			delete _injector.front();
+			_injector.pop();
+		}
+	}
+
+	// Each thread remembers which worker of which pool it is, so that tasks
+	// spawned by a worker go to its own deque and stay cache-warm.
+	inline thread_pool::worker_identity& thread_pool::identity()
+	{
+		static thread_local worker_identity id = { nullptr, 0 };
+		return id;
+	}
+
+	// Index of the calling worker, or size() for threads outside this pool.
+	inline size_t thread_pool::current_index() const
+	{
+		const worker_identity& id = identity();
+		return id._pool == this ? id._index : _deques.size();
+	}
+
+	inline void thread_pool::notify()
+	{
+		_pending.fetch_add(1, std::memory_order_seq_cst);
+		{
+			// Taking the lock orders the notify after a sleeper's predicate check.
+			std::lock_guard<std::mutex> guard(_sleep_lock);
+		}
+		_wake.notify_one();
+	}
+
+	inline void thread_pool::execute(task t)
+	{
+		task* heap_task = new task(std::move(t));
+		size_t index = current_index();
+		if (index < _deques.size()) {
+			_deques[index]->push(heap_task);
+		}
+		else {
+			std::lock_guard<std::mutex> guard(_injector_lock);
+			_injector.push(heap_task);
+		}
+		notify();
+	}
+
+	template<class Function>
+	inline auto thread_pool::submit(Function f) -> std::future<decltype(f())>
+	{
+		typedef decltype(f()) result_type;
+		// std::function needs a copyable target, so the packaged_task is shared.
+		std::shared_ptr<std::packaged_task<result_type()>> job =
+			std::make_shared<std::packaged_task<result_type()>>(std::move(f));
+		std::future<result_type> fut = job->get_future();
+		execute([job] { (*job)(); });
+		return fut;
+	}
+
+	template<class R>
+	inline R thread_pool::wait(std::future<R>& fut)
+	{
+		help_while_waiting([&fut] {
+			return fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		});
+		return fut.get();
+	}
+
+	template<class Function>
+	inline void thread_pool::parallel_for(size_t first, size_t last, size_t grain, Function f)
+	{
+		if (first >= last) {
+			return;
+		}
+		if (grain == 0) {
+			grain = 1;
+		}
+		std::atomic<size_t> done(0);
+		size_t total = last - first;
+
+		// Runs [low, high): forks off the upper half until the rest fits the grain.
+		std::function<void(size_t, size_t)> split = [&](size_t low, size_t high) {
+			while (high - low > grain) {
+				size_t mid = low + (high - low) / 2;
+				execute([&split, mid, high] { split(mid, high); });
+				high = mid;
+			}
+			for (size_t index = low; index < high; index++) {
+				f(index);
+			}
+			done.fetch_add(high - low, std::memory_order_release);
+		};
+		split(first, last);
+		help_while_waiting([&] {
+			return done.load(std::memory_order_acquire) == total;
+		});
+	}
+
+	inline bool thread_pool::take(task*& t)
+	{
+		size_t index = current_index();
+		if (index < _deques.size() && _deques[index]->pop(t)) {
+			return true;
+		}
+		{
+			std::unique_lock<std::mutex> guard(_injector_lock, std::try_to_lock);
+			if (guard.owns_lock() && !_injector.empty()) {
+				t = _injector.front();
+				_injector.pop();
+				return true;
+			}
+		}
+		size_t count = _deques.size();
+		size_t start = index < count ? index : 0;
+		for (size_t offset = 1; offset <= count; offset++) {
+			if (_deques[(start + offset) % count]->steal(t)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline bool thread_pool::run_pending_task()
+	{
+		task* t;
+		if (!take(t)) {
+			return false;
+		}
+		_pending.fetch_sub(1, std::memory_order_relaxed);
+		(*t)();
+		delete t;
+		return true;
+	}
+
+	template<class Predicate>
+	inline void thread_pool::help_while_waiting(Predicate done)
+	{
+		while (!done()) {
+			if (!run_pending_task()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	inline void thread_pool::worker_loop(size_t index)
+	{
+		identity()._pool = this;
+		identity()._index = index;
+		while (true) {
+			if (run_pending_task()) {
+				continue;
+			}
+			std::unique_lock<std::mutex> guard(_sleep_lock);
+			_wake.wait(guard, [this] {
+				return _stop.load() || _pending.load(std::memory_order_seq_cst) > 0;
+			});
+			if (_stop.load()) {
+				return;
+			}
+		}
+	}
+
+	inline size_t thread_pool::size() const
+	{
+		return _threads.size();
+	}
+
+	inline thread_pool& thread_pool::default_pool()
+	{
+		static thread_pool pool;
+		return pool;
+	}
+
+}
@@ -5,6 +5,8 @@
 using namespace std;
 
 #include <vector>
+#include "../parallel/algorithm.h"
+#include "../memory/arena.h"
 
 namespace moon {
     // 小于比较器
@@ -23,22 +25,112 @@ namespace moon {
         }
     };
 
+    // 向下调整：将first[parent]下沉到以parent为根、大小为n的堆中
+    template<class RandomIt, class Compare>
+    void adjust_down(RandomIt first, size_t n, size_t parent, Compare comp) {
+        size_t child = parent * 2 + 1;
+        while (child < n) {
+            // 找以parent为根的较大的孩子
+            if (child + 1 < n && comp(first[child], first[child + 1]))
+                child += 1;
+
+            // 检测双亲是否满足情况
+            if (comp(first[parent], first[child])) {
+                std::swap(first[child], first[parent]);
+                parent = child;
+                child = parent * 2 + 1;
+            } else
+                return;
+        }
+    }
+
+    // 自底向上建堆（单线程）
+    template<class RandomIt, class Compare>
+    void make_heap(RandomIt first, RandomIt last, Compare comp) {
+        size_t n = last - first;
+        for (size_t root = n / 2; root > 0; root--)
+            moon::adjust_down(first, n, root - 1, comp);
+    }
+
+    // 自底向上并行建堆
+    // 同一层的结点的子树互不相交：先选出一层足够多的子树根，各子树在线程池中并发建堆，
+    // 再在调用线程上调整这一层之上的少量结点
+    template<class RandomIt, class Compare>
+    void parallel_make_heap(RandomIt first, RandomIt last, Compare comp) {
+        size_t n = last - first;
+        Somn::thread_pool &pool = Somn::thread_pool::default_pool();
+        if (n < Somn::parallel_threshold || pool.size() == 1) {
+            moon::make_heap(first, last, comp);
+            return;
+        }
+
+        // 第level层的结点下标为[2^level - 1, 2^(level+1) - 1)，每个线程分到若干棵子树
+        size_t level_begin = 0, level_size = 1;
+        while (level_size < pool.size() * 8 && (level_begin + level_size) * 2 + 1 < n) {
+            level_begin += level_size;
+            level_size *= 2;
+        }
+
+        pool.parallel_for(level_begin, level_begin + level_size, 1, [&](size_t root) {
+            // 子树第d层的结点下标为[(root + 1) * 2^d - 1, (root + 2) * 2^d - 1)
+            // 先找到子树最深的非叶子层，再逐层向上调整
+            size_t width = 1;
+            while (((root + 1) * width * 2 - 1) * 2 + 1 < n)
+                width *= 2;
+            for (; width > 0; width /= 2) {
+                size_t low = (root + 1) * width - 1;
+                size_t high = low + width;
+                for (size_t node = high; node > low; node--) {
+                    if (node - 1 < n)
+                        moon::adjust_down(first, n, node - 1, comp);
+                }
+            }
+        });
+
+        for (size_t root = level_begin; root > 0; root--)
+            moon::adjust_down(first, n, root - 1, comp);
+    }
+
+    // 将堆[first, last)排成升序（comp为less时），堆顶依次交换到末尾
+    template<class RandomIt, class Compare>
+    void sort_heap(RandomIt first, RandomIt last, Compare comp) {
+        size_t n = last - first;
+        while (n > 1) {
+            --n;
+            std::swap(first[0], first[n]);
+            moon::adjust_down(first, n, 0, comp);
+        }
+    }
+
+    // 堆排序：并行建堆后再排序
+    template<class RandomIt, class Compare>
+    void heap_sort(RandomIt first, RandomIt last, Compare comp) {
+        moon::parallel_make_heap(first, last, comp);
+        moon::sort_heap(first, last, comp);
+    }
+
+    template<class RandomIt>
+    void heap_sort(RandomIt first, RandomIt last) {
+        moon::heap_sort(first, last, less<typename std::iterator_traits<RandomIt>::value_type>());
+    }
+
     // 优先级队列类模板
-    template<class T, class Container = std::vector<T>, class Compare = less<T>>
+    // 默认容器的分配器带有内存资源，不指定时使用new/delete
+    template<class T, class Container = std::vector<T, Somn::resource_allocator<T>>, class Compare = less<T>>
     class priority_queue {
     public:
         // 创建空的优先级队列
         priority_queue() : c() {}
 
+        // 创建空的优先级队列，容器的内存从resource分配（例如arena）
+        explicit priority_queue(Somn::memory_resource *resource) : c(typename Container::allocator_type(resource)) {}
+
         // 通过迭代器范围创建优先级队列
         template<class Iterator>
         priority_queue(Iterator first, Iterator last)
                 : c(first, last) {
-            // 将c中的元素调整成堆的结构
-            int count = c.size();
-            int root = ((count - 2) >> 1);
-            for (; root >= 0; root--)
-                AdjustDown(root);
+            // 将c中的元素调整成堆的结构，元素较多时并行建堆
+            moon::parallel_make_heap(c.begin(), c.end(), Compare());
         }
 
         // 入队操作
@@ -72,6 +164,24 @@ namespace moon {
             return c.front();
         }
 
+        // 取出全部元素并按优先级从低到高排序，队列随之清空
+        Container sorted() {
+            moon::sort_heap(c.begin(), c.end(), Compare());
+            Container result;
+            std::swap(result, c);
+            return result;
+        }
+
+        // 按堆序返回底层容器，用于快照等需要原样保存的场合
+        [[nodiscard]] const Container &container() const {
+            return c;
+        }
+
+        // 接管一个已满足堆序的容器，不重新建堆（例如从快照加载）
+        void assign_heap(Container heap) {
+            c = std::move(heap);
+        }
+
     private:
         // 向上调整
         void AdjustUP(int child) {
@@ -88,53 +198,11 @@ namespace moon {
         }
 
         // 向下调整
-        void AdjustDown(int parent) {
-            size_t child = parent * 2 + 1;
-            while (child < c.size()) {
-                // 找以parent为根的较大的孩子
-                if (child + 1 < c.size() && Compare()(c[child], c[child + 1]))
-                    child += 1;
-
-                // 检测双亲是否满足情况
-                if (Compare()(c[parent], c[child])) {
-                    swap(c[child], c[parent]);
-                    parent = child;
-                    child = parent * 2 + 1;
-                } else
-                    return;
-            }
+        void AdjustDown(size_t parent) {
+            moon::adjust_down(c.begin(), c.size(), parent, Compare());
         }
 
     private:
         Container c; // 存储元素的容器
     };
 }
-
-// 测试优先级队列
-void TestQueuePriority() {
-    moon::priority_queue<int> q1;
-    q1.push(5);
-    q1.push(1);
-    q1.push(4);
-    q1.push(2);
-    q1.push(3);
-    q1.push(6);
-    cout << q1.top() << endl;
-
-    q1.pop();
-    q1.pop();
-    cout << q1.top() << endl;
-
-    vector<int> v{5, 1, 4, 2, 3, 6};
-    moon::priority_queue<int, vector<int>, moon::greater<int>> q2(v.begin(), v.end());
-    cout << q2.top() << endl;
-
-    q2.pop();
-    q2.pop();
-    cout << q2.top() << endl;
-}
-
-int main() {
-    TestQueuePriority();
-    return 0;
-}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <random>
+#include "priority_queue.h"
+
+// 测试优先级队列
+void TestQueuePriority() {
+    moon::priority_queue<int> q1;
+    q1.push(5);
+    q1.push(1);
+    q1.push(4);
+    q1.push(2);
+    q1.push(3);
+    q1.push(6);
+    cout << q1.top() << endl;
+
+    q1.pop();
+    q1.pop();
+    cout << q1.top() << endl;
+
+    vector<int> v{5, 1, 4, 2, 3, 6};
+    moon::priority_queue<int, vector<int>, moon::greater<int>> q2(v.begin(), v.end());
+    cout << q2.top() << endl;
+
+    q2.pop();
+    q2.pop();
+    cout << q2.top() << endl;
+}
+
+// 测试堆排序
+void TestHeapSort() {
+    vector<int> v{5, 1, 4, 2, 3, 6, 9, 7, 8, 0};
+    moon::heap_sort(v.begin(), v.end());
+    for (int x : v)
+        cout << x << " ";
+    cout << endl;
+
+    moon::priority_queue<int, vector<int>, moon::greater<int>> q(v.begin(), v.end());
+    vector<int> sorted = q.sorted();
+    for (int x : sorted)
+        cout << x << " ";
+    cout << endl;
+}
+
+// 重建大队列的耗时：逐个push、单线程建堆、并行建堆
+void BenchRebuild() {
+    typedef chrono::steady_clock clock;
+    const size_t count = 20000000;
+
+    vector<unsigned> data(count);
+    mt19937 gen(42);
+    for (size_t i = 0; i < count; i++)
+        data[i] = gen();
+
+    auto start = clock::now();
+    moon::priority_queue<unsigned> pushed;
+    for (size_t i = 0; i < count; i++)
+        pushed.push(data[i]);
+    auto stop = clock::now();
+    cout << "push one by one:   " << chrono::duration<double, milli>(stop - start).count() << " ms" << endl;
+
+    vector<unsigned> serial(data);
+    start = clock::now();
+    moon::make_heap(serial.begin(), serial.end(), moon::less<unsigned>());
+    stop = clock::now();
+    cout << "serial heapify:    " << chrono::duration<double, milli>(stop - start).count() << " ms" << endl;
+
+    start = clock::now();
+    moon::priority_queue<unsigned> rebuilt(data.begin(), data.end());
+    stop = clock::now();
+    cout << "range constructor: " << chrono::duration<double, milli>(stop - start).count() << " ms on "
+         << Somn::thread_pool::default_pool().size() << " workers, top " << rebuilt.top() << endl;
+}
+
+int main() {
+    TestQueuePriority();
+    TestHeapSort();
+    BenchRebuild();
+    return 0;
+}
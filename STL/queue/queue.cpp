@@ -1,10 +1,18 @@
 #pragma once
 #include <deque>
+#include <stdexcept>
+#include "../memory/arena.h"
 
 // 定义一个通用队列（queue）模板类
-template <class T, class Container = std::deque<T>>
+// 默认容器的分配器带有内存资源，不指定时使用new/delete
+template <class T, class Container = std::deque<T, Somn::resource_allocator<T>>>
 class Queue {
 public:
+    Queue() = default;
+
+    // 构造空队列，容器的内存从resource分配（例如arena）
+    explicit Queue(Somn::memory_resource* resource) : _con(typename Container::allocator_type(resource)) {}
+
     // 将元素推入队列的函数
     void push(const T& x) {
         _con.push_back(x);
@@ -0,0 +1,385 @@
+/**
+ * @file snapshot.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{snapshot}
+ */
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "../vector/myVector.h"
+#include "../string/myString.h"
+#include "../list/list.h"
+#include "../priority_queue/priority_queue.h"
+
+namespace Somn {
+
+	/**
+	 * @brief Kind of container stored in a snapshot record.
+	 */
+	enum class snapshot_kind : uint32_t {
+		vector = 1,   /**< myVector<T>, elements in order */
+		string = 2,   /**< cocoon::myString, bytes without the terminator */
+		list = 3,     /**< beat::list<T>, elements front to back */
+		heap = 4      /**< moon::priority_queue, elements in heap order */
+	};
+
+	namespace detail {
+		namespace snapshot {
+			const char magic[8] = {'S', 'O', 'M', 'N', 'S', 'N', 'A', 'P'};
+			const uint32_t version = 1;
+			const uint32_t byte_order = 0x01020304;
+			// Headers and payloads start on this boundary, so viewed elements are aligned
+			const size_t alignment = 64;
+
+			struct file_header {
+				char magic[8];
+				uint32_t version;
+				uint32_t byte_order;
+				char reserved[48];
+			};
+
+			struct record_header {
+				uint32_t kind;
+				uint32_t element_size;
+				uint64_t count;
+				uint64_t bytes;
+				char reserved[40];
+			};
+
+			static_assert(sizeof(file_header) == alignment && sizeof(record_header) == alignment,
+			              "headers are one alignment unit each");
+
+			inline size_t padding(size_t bytes) {
+				return (alignment - bytes % alignment) % alignment;
+			}
+		}
+	}
+
+	/**
+	 * @brief Read-only view of elements stored in a snapshot; points into the mapped file.
+	 */
+	template<class T>
+	class snapshot_view {
+	public:
+		typedef const T* iterator;
+		typedef const T* const_iterator;
+
+		snapshot_view() : _data(nullptr), _size(0) {}
+		snapshot_view(const T* data, size_t size) : _data(data), _size(size) {}
+
+		const T* data() const { return _data; }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		const T& operator[](size_t pos) const { return _data[pos]; }
+		const T* begin() const { return _data; }
+		const T* end() const { return _data + _size; }
+
+	private:
+		const T* _data;
+		size_t _size;
+	};
+
+	/**
+	 * @brief Writes containers to a versioned binary snapshot file.
+	 *
+	 * The file is a 64-byte file header followed by records. Each record is a
+	 * 64-byte record header (kind, element size, count, payload bytes) and the
+	 * payload, padded to 64 bytes. Contiguous containers go out with a single
+	 * writev of header, payload and padding; a beat::list is first gathered
+	 * into one buffer. Elements are stored as raw bytes, so T must be
+	 * trivially copyable and the snapshot is read back on a machine with the
+	 * same byte order, which snapshot_reader checks.
+	 */
+	class snapshot_writer {
+	public:
+		/**
+		 * @brief Create or truncate the snapshot at path and write the file header.
+		 * @throws std::system_error when the file cannot be created or written.
+		 */
+		explicit snapshot_writer(const char* path) : _fd(::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) {
+			if (_fd < 0) {
+				fail("snapshot_writer: open");
+			}
+			detail::snapshot::file_header header = {};
+			std::memcpy(header.magic, detail::snapshot::magic, sizeof(header.magic));
+			header.version = detail::snapshot::version;
+			header.byte_order = detail::snapshot::byte_order;
+			write_all(&header, sizeof(header), nullptr, 0);
+		}
+
+		snapshot_writer(const snapshot_writer&) = delete;
+		snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+		~snapshot_writer() {
+			if (_fd >= 0) {
+				::close(_fd);
+			}
+		}
+
+		template<class T>
+		void write(const myVector<T>& v) {
+			record(snapshot_kind::vector, v.begin(), v.size());
+		}
+
+		void write(const cocoon::myString& str) {
+			record(snapshot_kind::string, str.c_str(), str.size());
+		}
+
+		template<class T>
+		void write(const beat::list<T>& lt) {
+			myVector<T> gathered;
+			gathered.reserve(lt.size());
+			for (const T& val : lt) {
+				gathered.push_back(val);
+			}
+			record(snapshot_kind::list, gathered.begin(), gathered.size());
+		}
+
+		template<class T, class Container, class Compare>
+		void write(const moon::priority_queue<T, Container, Compare>& q) {
+			const Container& heap = q.container();
+			record(snapshot_kind::heap, heap.data(), heap.size());
+		}
+
+		/**
+		 * @brief Flush to disk with fsync and close; the destructor closes without fsync.
+		 * @throws std::system_error when fsync fails.
+		 */
+		void close() {
+			if (_fd >= 0) {
+				int result = ::fsync(_fd);
+				::close(_fd);
+				_fd = -1;
+				if (result != 0) {
+					fail("snapshot_writer: fsync");
+				}
+			}
+		}
+
+	private:
+		static void fail(const char* what) {
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+
+		template<class T>
+		void record(snapshot_kind kind, const T* data, size_t count) {
+			static_assert(std::is_trivially_copyable<T>::value, "snapshots store raw bytes of T");
+			static_assert(alignof(T) <= detail::snapshot::alignment, "payloads are 64-byte aligned");
+			detail::snapshot::record_header header = {};
+			header.kind = static_cast<uint32_t>(kind);
+			header.element_size = sizeof(T);
+			header.count = count;
+			header.bytes = count * sizeof(T);
+			write_all(&header, sizeof(header), data, count * sizeof(T));
+		}
+
+		// Header, payload and padding in one writev, repeated only after a short write
+		void write_all(const void* header, size_t header_bytes, const void* payload, size_t payload_bytes) {
+			static const char zeros[detail::snapshot::alignment] = {};
+			iovec parts[3] = {
+				{const_cast<void*>(header), header_bytes},
+				{const_cast<void*>(payload), payload_bytes},
+				{const_cast<char*>(zeros), detail::snapshot::padding(payload_bytes)}
+			};
+			iovec* part = parts;
+			int left = 3;
+			while (left > 0) {
+				ssize_t written = ::writev(_fd, part, left);
+				if (written < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					fail("snapshot_writer: writev");
+				}
+				size_t done = static_cast<size_t>(written);
+				while (left > 0 && done >= part->iov_len) {
+					done -= part->iov_len;
+					part++;
+					left--;
+				}
+				if (left > 0) {
+					part->iov_base = static_cast<char*>(part->iov_base) + done;
+					part->iov_len -= done;
+				}
+			}
+		}
+
+		int _fd;
+	};
+
+	/**
+	 * @brief Reads a snapshot written by snapshot_writer, record by record.
+	 *
+	 * The file is mapped read-only. view() and view_string() return the
+	 * next record in place, without copying or parsing; the views stay valid
+	 * as long as the reader. read() copies the next record into a container;
+	 * a priority queue gets its elements back in heap order without
+	 * re-heapifying.
+	 */
+	class snapshot_reader {
+	public:
+		/**
+		 * @brief Map the snapshot at path and check its file header.
+		 * @throws std::system_error when the file cannot be opened or mapped.
+		 * @throws std::runtime_error when the file is not a snapshot this version can read.
+		 */
+		explicit snapshot_reader(const char* path) : _map(nullptr), _bytes(0), _offset(0) {
+			int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				throw std::system_error(errno, std::generic_category(), "snapshot_reader: open");
+			}
+			struct stat st;
+			if (::fstat(fd, &st) != 0) {
+				int saved = errno;
+				::close(fd);
+				throw std::system_error(saved, std::generic_category(), "snapshot_reader: fstat");
+			}
+			_bytes = static_cast<size_t>(st.st_size);
+			if (_bytes < sizeof(detail::snapshot::file_header)) {
+				::close(fd);
+				throw std::runtime_error("snapshot_reader: file too short");
+			}
+			void* map = ::mmap(nullptr, _bytes, PROT_READ, MAP_SHARED, fd, 0);
+			int saved = errno;
+			::close(fd);
+			if (map == MAP_FAILED) {
+				throw std::system_error(saved, std::generic_category(), "snapshot_reader: mmap");
+			}
+			_map = static_cast<const char*>(map);
+			const detail::snapshot::file_header* header = reinterpret_cast<const detail::snapshot::file_header*>(_map);
+			if (std::memcmp(header->magic, detail::snapshot::magic, sizeof(header->magic)) != 0
+				|| header->version > detail::snapshot::version || header->byte_order != detail::snapshot::byte_order) {
+				::munmap(const_cast<char*>(_map), _bytes);
+				throw std::runtime_error("snapshot_reader: not a snapshot, a newer version or another byte order");
+			}
+			_offset = sizeof(detail::snapshot::file_header);
+		}
+
+		snapshot_reader(const snapshot_reader&) = delete;
+		snapshot_reader& operator=(const snapshot_reader&) = delete;
+
+		~snapshot_reader() {
+			if (_map) {
+				::munmap(const_cast<char*>(_map), _bytes);
+			}
+		}
+
+		/**
+		 * @brief Check whether records are left.
+		 */
+		bool more() const { return _offset < _bytes; }
+
+		/**
+		 * @brief Kind of the next record.
+		 * @throws std::runtime_error when no record is left.
+		 */
+		snapshot_kind next_kind() const { return static_cast<snapshot_kind>(peek().kind); }
+
+		/**
+		 * @brief View the elements of the next record of any element-array kind in place.
+		 * @throws std::runtime_error when the record is a string or its element size differs.
+		 */
+		template<class T>
+		snapshot_view<T> view() {
+			static_assert(std::is_trivially_copyable<T>::value, "snapshots store raw bytes of T");
+			const detail::snapshot::record_header& header = peek();
+			if (header.kind == static_cast<uint32_t>(snapshot_kind::string) || header.element_size != sizeof(T)) {
+				throw std::runtime_error("snapshot_reader: record does not hold elements of this type");
+			}
+			return snapshot_view<T>(reinterpret_cast<const T*>(take(header)), header.count);
+		}
+
+		/**
+		 * @brief View the next record, which must be a string, in place.
+		 */
+		cocoon::myString_view view_string() {
+			const detail::snapshot::record_header& header = expect(snapshot_kind::string, 1);
+			return cocoon::myString_view(take(header), header.count);
+		}
+
+		template<class T>
+		void read(myVector<T>& v) {
+			snapshot_view<T> elements = typed<T>(snapshot_kind::vector);
+			// One allocation and one memcpy; the range constructor would push_back element by element
+			myVector<T> loaded(v.resource());
+			loaded.assign(elements.data(), elements.size());
+			v.swap(loaded);
+		}
+
+		void read(cocoon::myString& str) {
+			cocoon::myString_view chars = view_string();
+			str.clear();
+			str.append(chars.data(), chars.size());
+		}
+
+		template<class T>
+		void read(beat::list<T>& lt) {
+			snapshot_view<T> elements = typed<T>(snapshot_kind::list);
+			lt.clear();
+			for (const T& val : elements) {
+				lt.push_back(val);
+			}
+		}
+
+		template<class T, class Container, class Compare>
+		void read(moon::priority_queue<T, Container, Compare>& q) {
+			snapshot_view<T> elements = typed<T>(snapshot_kind::heap);
+			q.assign_heap(Container(elements.begin(), elements.end()));
+		}
+
+	private:
+		const detail::snapshot::record_header& peek() const {
+			if (_bytes - _offset < sizeof(detail::snapshot::record_header)) {
+				throw std::runtime_error("snapshot_reader: no record left");
+			}
+			const detail::snapshot::record_header& header =
+				*reinterpret_cast<const detail::snapshot::record_header*>(_map + _offset);
+			// Bound count by the bytes actually left before multiplying, so a corrupt count cannot wrap
+			size_t remaining = _bytes - _offset - sizeof(detail::snapshot::record_header);
+			if (header.element_size == 0 || header.count > remaining / header.element_size
+				|| header.bytes != header.count * header.element_size) {
+				throw std::runtime_error("snapshot_reader: truncated record");
+			}
+			return header;
+		}
+
+		const detail::snapshot::record_header& expect(snapshot_kind kind, size_t element_size) const {
+			const detail::snapshot::record_header& header = peek();
+			if (header.kind != static_cast<uint32_t>(kind) || header.element_size != element_size) {
+				throw std::runtime_error("snapshot_reader: record does not hold the requested container");
+			}
+			return header;
+		}
+
+		template<class T>
+		snapshot_view<T> typed(snapshot_kind kind) {
+			static_assert(std::is_trivially_copyable<T>::value, "snapshots store raw bytes of T");
+			const detail::snapshot::record_header& header = expect(kind, sizeof(T));
+			return snapshot_view<T>(reinterpret_cast<const T*>(take(header)), header.count);
+		}
+
+		// Payload of the record at the cursor; moves the cursor past it
+		const char* take(const detail::snapshot::record_header& header) {
+			const char* payload = _map + _offset + sizeof(header);
+			size_t advance = sizeof(header) + header.bytes + detail::snapshot::padding(header.bytes);
+			_offset = advance < _bytes - _offset ? _offset + advance : _bytes;
+			return payload;
+		}
+
+		const char* _map;   /**< Read-only mapping of the whole file */
+		size_t _bytes;      /**< Length of the file */
+		size_t _offset;     /**< Start of the next record */
+	};
+
+}
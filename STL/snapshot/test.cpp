@@ -0,0 +1,262 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include "snapshot.h"
+#include "../vector/myVector.h"
+#include "../string/myString.h"
+#include "../list/list.h"
+#include "../priority_queue/priority_queue.h"
+
+struct Point {
+    int x;
+    int y;
+    double weight;
+};
+
+void test_snapshot() {
+    using namespace Somn;
+    const char* path = "/tmp/somn_snapshot_test.bin";
+
+    myVector<Point> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.push_back(Point{i, -i, i * 0.25});
+    }
+    cocoon::myString text("snapshot\0with a zero", 20);
+    beat::list<double> numbers;
+    for (int i = 0; i < 37; ++i) {
+        numbers.push_back(i * 1.5);
+    }
+    moon::priority_queue<int> heap;
+    moon::priority_queue<int, std::vector<int, resource_allocator<int>>, moon::greater<int>> min_heap;
+    std::mt19937 gen(47);
+    for (int i = 0; i < 500; ++i) {
+        int val = static_cast<int>(gen() % 10000);
+        heap.push(val);
+        min_heap.push(val);
+    }
+    myVector<int> empty;
+    {
+        snapshot_writer out(path);
+        out.write(points);
+        out.write(text);
+        out.write(numbers);
+        out.write(heap);
+        out.write(min_heap);
+        out.write(empty);
+        out.close();
+    }
+
+    snapshot_reader in(path);
+    myVector<Point> points2;
+    cocoon::myString text2;
+    beat::list<double> numbers2;
+    moon::priority_queue<int> heap2;
+    moon::priority_queue<int, std::vector<int, resource_allocator<int>>, moon::greater<int>> min_heap2;
+    myVector<int> empty2(3, 1);
+    in.read(points2);
+    in.read(text2);
+    in.read(numbers2);
+    bool heap_kind = in.next_kind() == snapshot_kind::heap;
+    in.read(heap2);
+    in.read(min_heap2);
+    in.read(empty2);
+
+    bool points_equal = points2.size() == points.size();
+    for (size_t i = 0; points_equal && i < points.size(); ++i) {
+        points_equal = points2[i].x == points[i].x && points2[i].y == points[i].y && points2[i].weight == points[i].weight;
+    }
+    bool text_equal = text2.size() == text.size() && std::memcmp(text2.c_str(), text.c_str(), text.size()) == 0;
+    bool numbers_equal = numbers2.size() == numbers.size();
+    for (auto a = numbers.begin(), b = numbers2.begin(); numbers_equal && a != numbers.end(); ++a, ++b) {
+        numbers_equal = *a == *b;
+    }
+    // Same layout as the saved heap, so it was not rebuilt; then pops agree
+    bool layout_equal = heap2.container() == heap.container() && min_heap2.container() == min_heap.container();
+    bool pops_equal = true;
+    while (!heap.empty()) {
+        pops_equal = pops_equal && heap.top() == heap2.top() && min_heap.top() == min_heap2.top();
+        heap.pop();
+        heap2.pop();
+        min_heap.pop();
+        min_heap2.pop();
+    }
+    std::cout << "round trip: points " << points_equal << ", text " << text_equal << ", list " << numbers_equal
+              << ", heap kind " << heap_kind << ", heap layout " << layout_equal << ", heap pops " << pops_equal
+              << ", empty " << empty2.empty() << ", more " << in.more() << std::endl;
+
+    // In place: views point into the mapping
+    snapshot_reader again(path);
+    snapshot_view<Point> view = again.view<Point>();
+    cocoon::myString_view chars = again.view_string();
+    snapshot_view<double> list_view = again.view<double>();
+    std::cout << "views: " << view.size() << " points, [999].y " << view[999].y << ", aligned "
+              << (reinterpret_cast<uintptr_t>(view.data()) % 64 == 0) << ", string " << chars.size() << " bytes, list back "
+              << list_view[list_view.size() - 1] << std::endl;
+
+    // Wrong element type, wrong kind and a truncated file are rejected
+    bool wrong_type = false, wrong_kind = false, truncated = false;
+    try {
+        snapshot_reader bad(path);
+        myVector<int> ints;
+        bad.read(ints);
+    }
+    catch (const std::runtime_error&) {
+        wrong_type = true;
+    }
+    try {
+        snapshot_reader bad(path);
+        cocoon::myString str;
+        bad.read(str);
+    }
+    catch (const std::runtime_error&) {
+        wrong_kind = true;
+    }
+    if (truncate(path, 64 + 64 + 100) == 0) {
+        try {
+            snapshot_reader bad(path);
+            bad.view<Point>();
+        }
+        catch (const std::runtime_error&) {
+            truncated = true;
+        }
+    }
+    // A corrupt count whose product with the element size wraps to the payload size
+    bool overflow = false;
+    {
+        myVector<long long> one;
+        one.push_back(7);
+        snapshot_writer out(path);
+        out.write(one);
+        out.close();
+    }
+    if (FILE* file = std::fopen(path, "r+b")) {
+        uint64_t count = (uint64_t(1) << 61) + 1;
+        std::fseek(file, 64 + 8, SEEK_SET);
+        std::fwrite(&count, sizeof(count), 1, file);
+        std::fclose(file);
+        try {
+            snapshot_reader bad(path);
+            bad.view<long long>();
+        }
+        catch (const std::runtime_error&) {
+            overflow = true;
+        }
+    }
+    std::cout << "rejects: wrong type " << wrong_type << ", wrong kind " << wrong_kind << ", truncated " << truncated
+              << ", overflowing count " << overflow << std::endl;
+    std::remove(path);
+}
+
+void bench_snapshot() {
+    using namespace Somn;
+    typedef std::chrono::steady_clock clock;
+    const char* path = "/tmp/somn_snapshot_bench.bin";
+    const size_t n = 32 * 1024 * 1024;     // 256 MiB of longs
+    const double mib = n * sizeof(long long) / (1024.0 * 1024.0);
+
+    myVector<long long> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<long long>(i * 2654435761u));
+    }
+
+    auto start = clock::now();
+    {
+        snapshot_writer out(path);
+        out.write(v);
+    }
+    double save_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    start = clock::now();
+    unsigned long long sum = 0;   // Checksum; wraps instead of overflowing
+    {
+        snapshot_reader in(path);
+        snapshot_view<long long> view = in.view<long long>();
+        for (long long x : view) {
+            sum += static_cast<unsigned long long>(x);
+        }
+    }
+    double view_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    start = clock::now();
+    myVector<long long> loaded;
+    {
+        snapshot_reader in(path);
+        in.read(loaded);
+    }
+    double load_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    // The hand-rolled loop this replaces: one fwrite / fread per element
+    start = clock::now();
+    {
+        FILE* file = std::fopen(path, "wb");
+        for (long long x : v) {
+            std::fwrite(&x, sizeof(x), 1, file);
+        }
+        std::fclose(file);
+    }
+    double loop_save_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    start = clock::now();
+    myVector<long long> looped;
+    {
+        FILE* file = std::fopen(path, "rb");
+        long long x;
+        while (std::fread(&x, sizeof(x), 1, file) == 1) {
+            looped.push_back(x);
+        }
+        std::fclose(file);
+    }
+    double loop_load_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    std::cout << "myVector<long long>, " << mib << " MiB (sum " << sum << ", " << loaded.size() << "/" << looped.size() << " loaded)" << std::endl;
+    std::cout << "  snapshot save " << save_ms << " ms (" << mib / save_ms * 1000 << " MiB/s), load " << load_ms
+              << " ms (" << mib / load_ms * 1000 << " MiB/s), view + scan " << view_ms << " ms" << std::endl;
+    std::cout << "  per-element loop save " << loop_save_ms << " ms, load " << loop_load_ms << " ms" << std::endl;
+
+    // Heap: loading in heap order vs rebuilding the heap from the same elements
+    moon::priority_queue<long long> heap(v.begin(), v.begin() + n / 4);
+    {
+        snapshot_writer out(path);
+        out.write(heap);
+    }
+    start = clock::now();
+    moon::priority_queue<long long> heap2;
+    {
+        snapshot_reader in(path);
+        in.read(heap2);
+    }
+    double heap_load_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    start = clock::now();
+    moon::priority_queue<long long> rebuilt(heap.container().begin(), heap.container().end());
+    double heapify_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << "  priority_queue of " << n / 4 << ": load in heap order " << heap_load_ms << " ms, copy + make_heap "
+              << heapify_ms << " ms (top " << (heap2.top() == rebuilt.top()) << ")" << std::endl;
+
+    // beat::list is gathered into one buffer before its single write
+    beat::list<long long> lt;
+    for (size_t i = 0; i < n / 8; ++i) {
+        lt.push_back(v[i]);
+    }
+    start = clock::now();
+    {
+        snapshot_writer out(path);
+        out.write(lt);
+    }
+    double list_save_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    start = clock::now();
+    beat::list<long long> lt2;
+    {
+        snapshot_reader in(path);
+        in.read(lt2);
+    }
+    double list_load_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << "  beat::list of " << lt2.size() << ": save " << list_save_ms << " ms, load " << list_load_ms << " ms" << std::endl;
+    std::remove(path);
+}
+
+int main() {
+    test_snapshot();
+    bench_snapshot();
+    return 0;
+}
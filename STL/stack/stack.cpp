@@ -1,10 +1,18 @@
 #pragma once
 #include <deque> // 包含 <deque> 头文件，以支持默认容器类型 std::deque
+#include <stdexcept>
+#include "../memory/arena.h"
 
 // 定义一个通用堆栈（stack）模板类
-template <class T, class Container = std::deque<T>> 
+// 默认容器的分配器带有内存资源，不指定时使用new/delete
+template <class T, class Container = std::deque<T, Somn::resource_allocator<T>>>
 class Stack {
 public:
+    Stack() = default;
+
+    // 构造空堆栈，容器的内存从resource分配（例如arena）
+    explicit Stack(Somn::memory_resource* resource) : _con(typename Container::allocator_type(resource)) {}
+
     // 将元素推入堆栈的函数
     void push(const T& x) {
         _con.push_back(x);
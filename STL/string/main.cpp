@@ -1,8 +1,818 @@
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 #include"myString.h"
+#include"myRope.h"
+#include"mySharedString.h"
+#include"myInternPool.h"
+#include"myStringBuilder.h"
+#include"myNumeric.h"
+#include"myUtf8.h"
+#include"myMappedFile.h"
+#include"myTokenizer.h"
+#include"myHash.h"
 
 using namespace cocoon;
 
+void test_rope() {
+    myRope rope("hello world");
+    rope.insert(5, ",");
+    rope.append("!");
+    std::cout << rope << std::endl;
+
+    myRope sub = rope.substr(7, 5);
+    std::cout << sub << " " << sub.size() << std::endl;
+
+    rope.erase(0, 7);
+    std::cout << rope.flatten() << std::endl;
+}
+
+void test_view() {
+    myString request("GET /index.html HTTP/1.1");
+
+    // 切分出的每一段都是视图，不分配内存
+    Somn::myVector<myString_view> parts = request.view().split(' ');
+    for (auto it = parts.begin(); it != parts.end(); ++it) {
+        std::cout << "[" << *it << "] ";
+    }
+    std::cout << std::endl;
+
+    myString_view path = request.substr(4, 11);
+    std::cout << path << " " << path.starts_with("/") << " " << path.ends_with(".html") << std::endl;
+    std::cout << request.find(myString_view("HTTP")) << " " << (parts[2] == "HTTP/1.1") << std::endl;
+}
+
+void test_shared_string() {
+    mySharedString payload("large immutable payload");
+    mySharedString hop1 = payload;   // 只增加引用计数
+    mySharedString hop2 = hop1;
+    std::cout << payload.use_count() << " " << (hop2.c_str() == payload.c_str()) << std::endl;
+
+    hop2 += " (edited)";             // 修改时才拷贝
+    std::cout << hop2 << " " << payload << " " << payload.use_count() << std::endl;
+
+    // 交出可写引用后再拷贝：拷贝是独立的一份，之后通过引用的写入不会泄漏过去
+    mySharedString edited("abc");
+    char &first = edited[0];
+    mySharedString snapshot = edited;
+    first = 'x';
+    std::cout << edited << " " << snapshot << " " << (snapshot.c_str() != edited.c_str()) << std::endl;
+
+    // 拷贝构造与myString的逐层拷贝对比
+    typedef std::chrono::steady_clock clock;
+    myString big;
+    big.resize(1 << 20, 'x');
+    mySharedString shared(big);
+    const int hops = 10000;
+
+    auto start = clock::now();
+    for (int i = 0; i < hops; i++) {
+        myString copy(big);
+    }
+    auto middle = clock::now();
+    for (int i = 0; i < hops; i++) {
+        mySharedString copy(shared);
+    }
+    auto stop = clock::now();
+    std::cout << "1MB copy: myString " << std::chrono::duration<double, std::micro>(middle - start).count() / hops
+              << " us, mySharedString " << std::chrono::duration<double, std::micro>(stop - middle).count() / hops
+              << " us" << std::endl;
+}
+
+void test_intern_pool() {
+    myInternPool pool;
+
+    // 大量重复的主机名只保存一份
+    const char *hosts[] = {"api.example.com", "db-01.internal", "cache-02.internal", "api.example.com"};
+    Somn::myVector<myInterned> handles;
+    for (int i = 0; i < 100000; i++) {
+        myString name(hosts[i % 4]);
+        handles.push_back(pool.intern(name));
+    }
+    std::cout << handles[0] << " " << (handles[0] == handles[3]) << " " << (handles[0] == handles[1]) << std::endl;
+
+    myInternPool::statistics stats = pool.stats();
+    std::cout << "unique " << stats.unique_strings << ", hit ratio " << stats.hit_ratio()
+              << ", bytes saved " << stats.bytes_saved << ", arena " << stats.arena_bytes << std::endl;
+}
+
+void test_string_builder() {
+    myStringBuilder builder(64);
+    builder += "{\"id\": ";
+    builder.append_int(-42);
+    builder += ", \"ratio\": ";
+    builder.append_double(0.1);
+    builder += "}";
+    std::cout << builder.finish() << " in " << builder.chunk_count() << " chunk(s)" << std::endl;
+
+    // 拼接大量小片段：myString的+=与构建器对比
+    typedef std::chrono::steady_clock clock;
+    const int fields = 1000000;
+
+    auto start = clock::now();
+    myString flat;
+    for (int i = 0; i < fields; i++) {
+        flat += "field=";
+        flat += 'x';
+        flat += ';';
+    }
+    auto middle = clock::now();
+    myStringBuilder chunked;
+    for (int i = 0; i < fields; i++) {
+        chunked += "field=";
+        chunked += 'x';
+        chunked += ';';
+    }
+    myString finished = chunked.finish();
+    auto stop = clock::now();
+    std::cout << "myString += " << std::chrono::duration<double, std::milli>(middle - start).count()
+              << " ms, builder + finish " << std::chrono::duration<double, std::milli>(stop - middle).count()
+              << " ms, same " << (flat.view() == finished.view()) << ", exact capacity "
+              << (finished.capacity() == finished.size()) << std::endl;
+}
+
+// 数值格式化与解析：直接写入myString与iostream、snprintf对比
+void bench_numeric() {
+    typedef std::chrono::steady_clock clock;
+    const int count = 1000000;
+    std::mt19937_64 gen(3);
+    Somn::myVector<long long> ints;
+    Somn::myVector<double> doubles;
+    for (int i = 0; i < count; i++) {
+        ints.push_back(static_cast<long long>(gen()) >> (gen() % 60));
+        doubles.push_back(static_cast<double>(gen()) / 3.0e7);
+    }
+
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    auto start = clock::now();
+    myString direct;
+    for (int i = 0; i < count; i++) {
+        direct.append_int(ints[i]);
+        direct.push_back(',');
+    }
+    auto t1 = clock::now();
+    myString via_snprintf;
+    char buffer[32];
+    for (int i = 0; i < count; i++) {
+        snprintf(buffer, sizeof(buffer), "%lld,", ints[i]);
+        via_snprintf.append(buffer);
+    }
+    auto t2 = clock::now();
+    std::ostringstream stream;
+    for (int i = 0; i < count; i++) {
+        stream << ints[i] << ',';
+    }
+    myString via_stream(stream.str().c_str());
+    auto t3 = clock::now();
+    std::cout << "int:    append_int " << ms(start, t1) << " ms, snprintf " << ms(t1, t2)
+              << " ms, ostringstream " << ms(t2, t3) << " ms, same " << (direct.view() == via_stream.view()) << std::endl;
+
+    start = clock::now();
+    myString shortest;
+    for (int i = 0; i < count; i++) {
+        shortest.append_double(doubles[i]);
+        shortest.push_back(',');
+    }
+    t1 = clock::now();
+    myString printed;
+    for (int i = 0; i < count; i++) {
+        snprintf(buffer, sizeof(buffer), "%.17g,", doubles[i]);
+        printed.append(buffer);
+    }
+    t2 = clock::now();
+    std::ostringstream double_stream;
+    double_stream.precision(17);
+    for (int i = 0; i < count; i++) {
+        double_stream << doubles[i] << ',';
+    }
+    t3 = clock::now();
+    std::cout << "double: append_double " << ms(start, t1) << " ms, snprintf " << ms(t1, t2)
+              << " ms, ostringstream " << ms(t2, t3) << " ms" << std::endl;
+
+    // 解析：按','切分后在视图上解析，不分配内存
+    start = clock::now();
+    double sum = 0;
+    bool ok = true;
+    shortest.view().split(',', [&](myString_view field) {
+        double val;
+        if (!field.empty()) {
+            ok = parse_double(field, val) && ok;
+            sum += val;
+        }
+    });
+    t1 = clock::now();
+    double strtod_sum = 0;
+    const char *cur = printed.c_str();
+    for (int i = 0; i < count; i++) {
+        char *next;
+        strtod_sum += strtod(cur, &next);
+        cur = next + 1;
+    }
+    t2 = clock::now();
+    std::istringstream in(double_stream.str());
+    double stream_sum = 0, val;
+    char comma;
+    while (in >> val >> comma) {
+        stream_sum += val;
+    }
+    t3 = clock::now();
+    std::cout << "parse:  parse_double " << ms(start, t1) << " ms, strtod " << ms(t1, t2)
+              << " ms, istringstream " << ms(t2, t3) << " ms, round trip " << (ok && sum == strtod_sum) << std::endl;
+}
+
+// 随机位置小编辑：myRope与myString对比
+void test_utf8() {
+    myString text("Hello, 世界! Grüße 🙂");
+    std::cout << text.valid_utf8() << " " << text.size() << " bytes, " << text.utf8_size() << " code points" << std::endl;
+    for_each_code_point(text, [](char32_t ch) {
+        std::cout << std::hex << static_cast<unsigned long>(ch) << std::dec << " ";
+    });
+    std::cout << std::endl;
+    text.to_upper();
+    std::cout << text << std::endl;
+
+    // 过长编码、代理项、超出范围、截断、单独的续字节
+    const char *invalid[] = {"\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+                             "abc\xE4\xB8", "\x80", "\xE4\xB8\xAD\xBF"};
+    for (const char *str: invalid) {
+        std::cout << utf8_valid(str) << utf8_valid_scalar(str) << " ";
+    }
+    std::cout << std::endl;
+
+    // 随机改坏合法文本的若干字节，SIMD和标量实现的结论必须一致
+    std::mt19937 gen(5);
+    const char *pieces[] = {"a", "ü", "中", "🙂", "\xE0\xA0\x80", "\xF4\x8F\xBF\xBF", "\xED\x9F\xBF"};
+    int mismatches = 0, invalid_count = 0;
+    for (int round = 0; round < 20000; round++) {
+        myString sample;
+        size_t count = gen() % 40;
+        for (size_t i = 0; i < count; i++) {
+            sample.append(pieces[gen() % 7]);
+        }
+        if (!sample.empty() && gen() % 2) {
+            sample[gen() % sample.size()] = static_cast<char>(gen());
+        }
+        bool valid = utf8_valid(sample);
+        mismatches += valid != utf8_valid_scalar(sample);
+        invalid_count += !valid;
+        if (valid) {
+            size_t decoded = 0;
+            for_each_code_point(sample, [&decoded](char32_t) { decoded++; });
+            mismatches += decoded != sample.utf8_size();
+        }
+    }
+    std::cout << "random: " << invalid_count << " invalid, " << mismatches << " mismatches" << std::endl;
+}
+
+void bench_utf8() {
+    typedef std::chrono::steady_clock clock;
+    const size_t target = 64 << 20;
+    myString ascii, mixed;
+    std::mt19937 gen(9);
+    const char *words[] = {"request ", "Header: ", "value=42 ", "中文内容", "日志", "émoji 🙂 "};
+    while (ascii.size() < target) {
+        ascii.append(words[gen() % 3]);
+    }
+    while (mixed.size() < target) {
+        mixed.append(words[gen() % 6]);
+    }
+
+    auto gbps = [](size_t bytes, clock::time_point from, clock::time_point to) {
+        return double(bytes) / std::chrono::duration<double>(to - from).count() / 1e9;
+    };
+    for (myString *text: {&ascii, &mixed}) {
+        auto start = clock::now();
+        bool simd = text->valid_utf8();
+        auto t1 = clock::now();
+        bool scalar = utf8_valid_scalar(*text);
+        auto t2 = clock::now();
+        size_t length = text->utf8_size();
+        auto t3 = clock::now();
+        text->to_lower();
+        auto t4 = clock::now();
+        std::cout << (text == &ascii ? "ascii: " : "mixed: ") << "validate " << gbps(text->size(), start, t1)
+                  << " GB/s, scalar " << gbps(text->size(), t1, t2) << " GB/s, count " << gbps(text->size(), t2, t3)
+                  << " GB/s, to_lower " << gbps(text->size(), t3, t4) << " GB/s, "
+                  << length << " code points, agree " << (simd == scalar) << std::endl;
+    }
+}
+
+void bench_rope() {
+    typedef std::chrono::steady_clock clock;
+    std::mt19937 gen(7);
+
+    for (size_t size : {1u << 20, 10u << 20, 100u << 20}) {
+        myString text;
+        text.resize(size, 'a');
+
+        myRope rope(text);
+        const int rope_edits = 100000;
+        auto start = clock::now();
+        for (int i = 0; i < rope_edits; i++) {
+            size_t pos = gen() % rope.size();
+            if (i % 2 == 0) {
+                rope.insert(pos, "edit");
+            } else {
+                rope.erase(pos, 4);
+            }
+        }
+        auto stop = clock::now();
+        double rope_us = std::chrono::duration<double, std::micro>(stop - start).count() / rope_edits;
+
+        // myString每次编辑都要移动后面的全部数据，编辑次数少一些
+        const int string_edits = 200;
+        start = clock::now();
+        for (int i = 0; i < string_edits; i++) {
+            size_t pos = gen() % text.size();
+            if (i % 2 == 0) {
+                text.insert(pos, "edit");
+            } else {
+                text.erase(pos, 4);
+            }
+        }
+        stop = clock::now();
+        double string_us = std::chrono::duration<double, std::micro>(stop - start).count() / string_edits;
+
+        start = clock::now();
+        myString flat = rope.flatten();
+        stop = clock::now();
+
+        std::cout << (size >> 20) << "MB: myRope " << rope_us << " us/edit, myString " << string_us
+                  << " us/edit, flatten " << std::chrono::duration<double, std::milli>(stop - start).count()
+                  << " ms" << std::endl;
+    }
+}
+
+void test_mapped_file() {
+    const char *path = "/tmp/cocoon_mapped_test.txt";
+    FILE *out = std::fopen(path, "wb");
+    std::fputs("first line\r\nERROR disk full\n\nlast line without newline", out);
+    std::fclose(out);
+
+    myMappedFile file(path);
+    std::cout << "mapped " << file.size() << " bytes, find ERROR " << file.find(myString_view("ERROR"))
+              << ", find '!' " << (file.find('!') == myMappedFile::npos) << std::endl;
+    file.for_each_line([](myString_view line) {
+        std::cout << "[" << line << "] ";
+    });
+    std::cout << std::endl;
+
+    FILE *empty = std::fopen(path, "wb");
+    std::fclose(empty);
+    myMappedFile nothing(path);
+    size_t lines = 0;
+    nothing.for_each_line([&lines](myString_view) { lines++; });
+    std::cout << "empty file: size " << nothing.size() << ", lines " << lines << std::endl;
+    std::remove(path);
+
+    bool threw = false;
+    try {
+        myMappedFile missing("/tmp/cocoon_mapped_missing.txt");
+    } catch (const std::system_error &) {
+        threw = true;
+    }
+    std::cout << "missing file throws " << threw << std::endl;
+}
+
+// 在512 MiB的日志里统计含ERROR的行：读进myString后扫描，对比直接映射后扫描
+void bench_mapped_file() {
+    const char *path = "/tmp/cocoon_mapped_bench.log";
+    const size_t target = size_t(512) << 20;
+    {
+        FILE *out = std::fopen(path, "wb");
+        std::mt19937 gen(48);
+        const char *levels[] = {"INFO", "DEBUG", "WARN", "ERROR"};
+        char line[160];
+        size_t written = 0;
+        for (unsigned long long i = 0; written < target; i++) {
+            int level = gen() % 100 == 0 ? 3 : static_cast<int>(gen() % 3);
+            int n = std::snprintf(line, sizeof(line), "2024-05-%02d 12:%02d:%02d.%06llu [%s] worker-%u request %llu handled in %u us\n",
+                                  static_cast<int>(i % 28 + 1), static_cast<int>(i / 60 % 60), static_cast<int>(i % 60),
+                                  i % 1000000, levels[level], static_cast<unsigned>(gen() % 64), i, static_cast<unsigned>(gen() % 100000));
+            std::fwrite(line, 1, n, out);
+            written += n;
+        }
+        std::fclose(out);
+    }
+    myString_view needle("ERROR");
+    auto count_errors = [&needle](myString_view text) {
+        size_t hits = 0, lines = 0;
+        text.split('\n', [&](myString_view line) {
+            lines++;
+            hits += line.find(needle) != myString_view::npos;
+        });
+        return std::make_pair(hits, lines);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    myString loaded;
+    {
+        FILE *in = std::fopen(path, "rb");
+        char buffer[1 << 16];
+        size_t got;
+        while ((got = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            loaded.append(buffer, got);
+        }
+        std::fclose(in);
+    }
+    auto read_hits = count_errors(loaded.view());
+    double read_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::pair<size_t, size_t> map_hits;
+    {
+        myMappedFile file(path);
+        map_hits = count_errors(file.view());
+    }
+    double map_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::pair<size_t, size_t> huge_hits;
+    bool huge;
+    {
+        myMappedFile file(path, myMappedFile::access::sequential, true);
+        huge = file.huge_pages();
+        huge_hits = count_errors(file.view());
+    }
+    double huge_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double mib = static_cast<double>(loaded.size()) / (1 << 20);
+    std::cout << "scan " << mib << " MiB for ERROR lines (" << read_hits.first << "/" << read_hits.second << ", "
+              << map_hits.first << "/" << map_hits.second << ", " << huge_hits.first << "/" << huge_hits.second << ")" << std::endl;
+    std::cout << "  fread + append into myString: " << read_ms << " ms (" << mib / read_ms * 1000 << " MiB/s)" << std::endl;
+    std::cout << "  myMappedFile, sequential:      " << map_ms << " ms (" << mib / map_ms * 1000 << " MiB/s)" << std::endl;
+    std::cout << "  myMappedFile, huge pages " << huge << ":    " << huge_ms << " ms (" << mib / huge_ms * 1000 << " MiB/s)" << std::endl;
+    std::remove(path);
+}
+
+// 逐字节的状态机，作为切分结果的对照
+Somn::myVector<myString> tokenize_reference(myString_view text, char delim, char quote) {
+    Somn::myVector<myString> records;
+    myString record, field;
+    bool in_quote = false;
+    auto end_field = [&](bool last) {
+        size_t n = field.size();
+        if (n > 0 && last && field[n - 1] == '\r') {
+            n--;
+        }
+        const char *data = field.c_str();
+        if (quote && n >= 2 && data[0] == quote && data[n - 1] == quote) {
+            data++;
+            n -= 2;
+        }
+        record.append(data, n);
+        record.push_back(last ? '\n' : '|');
+        field.clear();
+    };
+    for (size_t i = 0; i < text.size(); i++) {
+        char ch = text[i];
+        if (quote && ch == quote) {
+            in_quote = !in_quote;
+        }
+        if (!in_quote && ch == delim) {
+            end_field(false);
+        } else if (!in_quote && ch == '\n') {
+            end_field(true);
+            records.push_back(record);
+            record.clear();
+        } else {
+            field.push_back(ch);
+        }
+    }
+    if (!field.empty() || !record.empty()) {
+        end_field(true);
+        records.push_back(record);
+    }
+    return records;
+}
+
+void test_tokenizer() {
+    myString csv("id,name,comment\r\n"
+                 "1,\"Smith, John\",\"said \"\"hi\"\"\"\n"
+                 "2,,\"multi\nline, quoted\"\n"
+                 "\n"
+                 "3,plain,last line without newline");
+
+    // 每种块大小都得到同样的记录，包括跨块的字段、引号和"\r\n"
+    Somn::myVector<myString> expected = tokenize_reference(csv.view(), ',', '"');
+    size_t mismatches = 0;
+    for (size_t block = 1; block <= csv.size(); block++) {
+        myTokenizer tokenizer;
+        Somn::myVector<myString> got;
+        auto collect = [&got](const myRecord &fields) {
+            myString record;
+            for (size_t i = 0; i < fields.size(); i++) {
+                record.append(fields[i].data(), fields[i].size());
+                record.push_back(i + 1 == fields.size() ? '\n' : '|');
+            }
+            got.push_back(record);
+        };
+        for (size_t pos = 0; pos < csv.size(); pos += block) {
+            tokenizer.feed(csv.substr(pos, block), collect);
+        }
+        tokenizer.finish(collect);
+        bool same = got.size() == expected.size();
+        for (size_t i = 0; same && i < got.size(); i++) {
+            same = got[i].view() == expected[i].view();
+        }
+        mismatches += !same;
+    }
+
+    myTokenizer tokenizer;
+    tokenizer.feed(csv.view(), [&tokenizer](const myRecord &fields) {
+        std::cout << fields.size() << " fields:";
+        for (size_t i = 0; i < fields.size(); i++) {
+            myString unescaped;
+            tokenizer.unescape(fields[i], unescaped);
+            std::cout << " [" << unescaped << "]";
+        }
+        std::cout << std::endl;
+    });
+    tokenizer.finish([](const myRecord &fields) {
+        std::cout << "finish: " << fields.size() << " fields, last [" << fields[fields.size() - 1] << "]" << std::endl;
+    });
+    std::cout << "records " << tokenizer.records() << ", block size mismatches " << mismatches << std::endl;
+
+    // 随机的引号、分隔符和换行，与逐字节状态机对照
+    std::mt19937 gen(49);
+    const char alphabet[] = {'a', 'b', ',', '"', '\n', '\r', ' '};
+    size_t random_mismatches = 0;
+    for (int round = 0; round < 200; round++) {
+        myString text;
+        size_t len = gen() % 400;
+        for (size_t i = 0; i < len; i++) {
+            text.push_back(alphabet[gen() % sizeof(alphabet)]);
+        }
+        char quote = round % 2 ? '"' : '\0';
+        Somn::myVector<myString> want = tokenize_reference(text.view(), ',', quote);
+        Somn::myVector<myString> got;
+        auto collect = [&got](const myRecord &fields) {
+            myString record;
+            for (size_t i = 0; i < fields.size(); i++) {
+                record.append(fields[i].data(), fields[i].size());
+                record.push_back(i + 1 == fields.size() ? '\n' : '|');
+            }
+            got.push_back(record);
+        };
+        myTokenizer random_tokenizer(',', quote);
+        size_t block = gen() % 100 + 1;
+        for (size_t pos = 0; pos < text.size(); pos += block) {
+            random_tokenizer.feed(text.substr(pos, block), collect);
+        }
+        random_tokenizer.finish(collect);
+        bool same = got.size() == want.size();
+        for (size_t i = 0; same && i < got.size(); i++) {
+            same = got[i].view() == want[i].view();
+        }
+        random_mismatches += !same;
+    }
+    std::cout << "random inputs: mismatches " << random_mismatches << std::endl;
+}
+
+// 在内存中的大CSV和日志上比较：find('\n')逐行再按分隔符切分，和按块喂给myTokenizer
+void bench_tokenizer() {
+    std::mt19937 gen(2049);
+    myString csv, log;
+    csv.reserve(size_t(256) << 20);
+    log.reserve(size_t(256) << 20);
+    const char *words[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta"};
+    for (unsigned long long i = 0; csv.size() < (size_t(256) << 20); i++) {
+        csv.append_uint(i);
+        csv.push_back(',');
+        csv.append(words[gen() % 6]);
+        csv.push_back(',');
+        if (gen() % 8 == 0) {
+            csv.append("\"quoted, with \"\"escapes\"\"\"");
+        } else {
+            csv.append_double(static_cast<double>(gen() % 100000) / 100);
+        }
+        csv.push_back(',');
+        csv.append_uint(gen() % 1000);
+        csv.push_back('\n');
+    }
+    for (unsigned long long i = 0; log.size() < (size_t(256) << 20); i++) {
+        log.append("2024-05-17 12:00:00.");
+        log.append_uint(i % 1000000);
+        log.append(i % 100 == 0 ? " [ERROR] worker-" : " [INFO] worker-");
+        log.append_uint(gen() % 64);
+        log.append(" request ");
+        log.append_uint(i);
+        log.append(" handled in ");
+        log.append_uint(gen() % 100000);
+        log.append(" us\n");
+    }
+
+    auto bench = [](const char *name, const myString &text, char delim, char quote) {
+        auto start = std::chrono::steady_clock::now();
+        size_t fields = 0, records = 0;
+        myString_view all = text.view();
+        size_t pos = 0;
+        while (pos < all.size()) {
+            size_t end = all.find('\n', pos);
+            if (end == myString_view::npos) {
+                end = all.size();
+            }
+            all.substr(pos, end - pos).split(delim, [&fields](myString_view) { fields++; });
+            records++;
+            pos = end + 1;
+        }
+        double find_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        myTokenizer tokenizer(delim, quote);
+        size_t simd_fields = 0;
+        auto count = [&simd_fields](const myRecord &record) { simd_fields += record.size(); };
+        const size_t block = 1 << 16;
+        for (size_t offset = 0; offset < text.size(); offset += block) {
+            tokenizer.feed(text.substr(offset, block), count);
+        }
+        tokenizer.finish(count);
+        double simd_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        double mib = static_cast<double>(text.size()) / (1 << 20);
+        std::cout << name << " " << mib << " MiB, " << tokenizer.records() << " records (" << records << "), "
+                  << simd_fields << " fields (" << fields << " unquoted)" << std::endl;
+        std::cout << "  find + split:            " << find_ms << " ms (" << mib / find_ms * 1000 << " MiB/s)" << std::endl;
+        std::cout << "  myTokenizer, 64 KiB blocks: " << simd_ms << " ms (" << mib / simd_ms * 1000 << " MiB/s)" << std::endl;
+    };
+    bench("csv", csv, ',', '"');
+    bench("log", log, ' ', '\0');
+}
+
+// 原来std::hash<myString_view>使用的FNV-1a，作为对照
+uint64_t fnv1a(myString_view str) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t index = 0; index < str.size(); index++) {
+        h ^= static_cast<unsigned char>(str[index]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void test_hash() {
+    // 视图、myString、C风格字符串和缓存哈希的字符串得到相同的结果
+    myString owned("the quick brown fox jumps over the lazy dog");
+    myHashedString cached(owned.view());
+    uint64_t h = hash_bytes(owned.view());
+    std::cout << "same hash: " << (std::hash<myString_view>()(owned.view()) == h) << (std::hash<myString>()(owned) == h)
+              << (std::hash<myString_view>()("the quick brown fox jumps over the lazy dog") == h)
+              << (std::hash<myHashedString>()(cached) == h) << ", seeded differs " << (hash_bytes(owned.view(), 1) != h)
+              << std::endl;
+
+    // 同一缓冲区的所有前缀（覆盖每个长度分支）和所有单比特翻转都不碰撞
+    std::mt19937_64 gen(50);
+    myString data;
+    for (int i = 0; i < 1024; i++) {
+        data.push_back(static_cast<char>(gen()));
+    }
+    std::unordered_set<uint64_t> seen;
+    size_t inputs = 0;
+    for (size_t len = 0; len <= data.size(); len++) {
+        seen.insert(hash_bytes(data.substr(0, len)));
+        inputs++;
+    }
+    // 每个输入位平均应翻转一半的输出位
+    double flipped = 0;
+    size_t flips = 0;
+    const size_t lengths[] = {3, 8, 13, 16, 40, 100};
+    for (size_t len: lengths) {
+        myString key(data.c_str(), len);
+        uint64_t base = hash_bytes(key.view());
+        for (size_t bit = 0; bit < len * 8; bit++) {
+            key[bit / 8] = static_cast<char>(key[bit / 8] ^ (1 << (bit % 8)));
+            uint64_t changed = hash_bytes(key.view());
+            key[bit / 8] = static_cast<char>(key[bit / 8] ^ (1 << (bit % 8)));
+            seen.insert(changed);
+            inputs++;
+            flipped += __builtin_popcountll(base ^ changed);
+            flips++;
+        }
+    }
+    std::cout << "hash inputs " << inputs << ", distinct " << seen.size() << ", avalanche "
+              << flipped / static_cast<double>(flips) << " of 64 bits" << std::endl;
+
+    // 缓存在第一次hash()时建立，任何修改都会失效
+    myHashedString key("alpha");
+    bool before = key.hashed();
+    uint64_t first = key.hash();
+    bool after = key.hashed();
+    key.push_back('!');
+    bool pushed = key.hashed();
+    uint64_t second = key.hash();
+    key.modify([](myString &str) { str[0] = 'A'; });
+    bool modified = key.hashed();
+    std::cout << "cache: " << before << after << pushed << modified << ", rehashed " << (first != second)
+              << (key.hash() == hash_bytes("Alpha!")) << ", assign self " ;
+    key.assign(key.view().substr(1));
+    std::cout << key << " " << (key.hash() == hash_bytes("lpha!")) << std::endl;
+
+    myHashedString a("same"), b("same"), c("diff");
+    bool differ = a.hash() != c.hash();
+    std::unordered_set<myHashedString> set;
+    set.insert(a);
+    set.insert(c);
+    std::cout << "equal " << differ << (a == b) << (a != c) << (a == myString_view("same")) << ", set finds "
+              << set.count(b) << set.count(myHashedString("none")) << std::endl;
+}
+
+void bench_hash() {
+    using clock = std::chrono::steady_clock;
+    std::mt19937_64 gen(2050);
+    myString data;
+    data.resize(1 << 20, ' ');
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>('a' + gen() % 26);
+    }
+
+    // 每种长度都哈希约256 MiB，从缓冲区的不同位置取键
+    std::cout << "hash throughput by key length (ns/key, GiB/s):" << std::endl;
+    uint64_t checksum = 0;
+    const size_t lengths[] = {4, 8, 16, 32, 64, 128, 256, 1024, 4096, 65536};
+    for (size_t len: lengths) {
+        size_t keys = (size_t(256) << 20) / len;
+        size_t slots = data.size() - len;
+        auto run = [&](auto hash) {
+            auto start = clock::now();
+            for (size_t i = 0; i < keys; i++) {
+                checksum += hash(data.substr((i * 4099) % slots, len));
+            }
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            return ns;
+        };
+        double fnv = run([](myString_view key) { return fnv1a(key); });
+        double wy = run([](myString_view key) { return hash_bytes(key); });
+        double stl = run([](myString_view key) { return std::hash<std::string_view>()(std::string_view(key.data(), key.size())); });
+        auto report = [&](const char *name, double ns) {
+            std::cout << " " << name << " " << ns / keys << " ns " << static_cast<double>(len) * keys / ns * 1e9 / (1 << 30) << " GiB/s";
+        };
+        std::cout << "  len " << len << ":";
+        report("FNV-1a", fnv);
+        report("| hash_bytes", wy);
+        report("| std::hash<string_view>", stl);
+        std::cout << std::endl;
+    }
+    std::cout << "  (checksum " << checksum << ")" << std::endl;
+
+    // 同一批键反复查找：myString每次重新扫描，myHashedString只在第一次计算
+    const size_t count = 100000, key_len = 256;
+    Somn::myVector<myString> plain;
+    Somn::myVector<myHashedString> hashed;
+    std::unordered_set<myString> plain_set;
+    std::unordered_set<myHashedString> hashed_set;
+    for (size_t i = 0; i < count; i++) {
+        myString_view key = data.substr((i * 7919) % (data.size() - key_len), key_len);
+        plain.push_back(myString(key.data(), key.size()));
+        hashed.push_back(myHashedString(key));
+        plain_set.insert(plain[i]);
+        hashed_set.insert(hashed[i]);
+    }
+    const int rounds = 20;
+    size_t found = 0;
+    auto start = clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < count; i++) {
+            found += plain_set.count(plain[(i * 31) % count]);
+        }
+    }
+    auto middle = clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < count; i++) {
+            found += hashed_set.count(hashed[(i * 31) % count]);
+        }
+    }
+    auto stop = clock::now();
+    std::cout << "repeated lookups of " << count << " " << key_len << "-byte keys x " << rounds << " (found " << found
+              << "): myString " << std::chrono::duration<double, std::milli>(middle - start).count()
+              << " ms, myHashedString " << std::chrono::duration<double, std::milli>(stop - middle).count() << " ms"
+              << std::endl;
+}
+
 int main() {
+    test_view();
+    test_shared_string();
+    test_intern_pool();
+    test_string_builder();
+    bench_numeric();
+    test_utf8();
+    bench_utf8();
+    test_rope();
+    bench_rope();
+    test_mapped_file();
+    bench_mapped_file();
+    test_tokenizer();
+    bench_tokenizer();
+    test_hash();
+    bench_hash();
+
     myString str;
     str.push_back('c');
     str.append("aaaaddd");
@@ -0,0 +1,202 @@
+#include <cstdint>
+#include <cstring>
+#include "myHash.h"
+
+namespace cocoon {
+    namespace {
+        // wyhash的默认密钥：四个奇数，每字节恰好4个1
+        const uint64_t secret0 = 0x2d358dccaa6c78a5ull;
+        const uint64_t secret1 = 0x8bb84b93962eacc9ull;
+        const uint64_t secret2 = 0x4b33a62ed433d4a3ull;
+        const uint64_t secret3 = 0x4d5a2da51de1aa47ull;
+
+        // 128位乘积的低64位放回a，高64位放回b
+        inline void multiply(uint64_t &a, uint64_t &b) {
+#ifdef __SIZEOF_INT128__
+            unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            a = static_cast<uint64_t>(product);
+            b = static_cast<uint64_t>(product >> 64);
+#else
+            uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            uint64_t hi = ha * hb, mid1 = ha * lb, mid2 = la * hb, lo = la * lb;
+            uint64_t t = lo + (mid1 << 32);
+            uint64_t carry = t < lo;
+            uint64_t low = t + (mid2 << 32);
+            carry += low < t;
+            b = hi + (mid1 >> 32) + (mid2 >> 32) + carry;
+            a = low;
+#endif
+        }
+
+        inline uint64_t mix(uint64_t a, uint64_t b) {
+            multiply(a, b);
+            return a ^ b;
+        }
+
+        // 按本机字节序读取，memcpy编译成一条不对齐的load
+        inline uint64_t read8(const unsigned char *p) {
+            uint64_t v;
+            memcpy(&v, p, 8);
+            return v;
+        }
+
+        inline uint64_t read4(const unsigned char *p) {
+            uint32_t v;
+            memcpy(&v, p, 4);
+            return v;
+        }
+
+        // 1到3个字节：首、中、尾三个字节拼在一起
+        inline uint64_t read_small(const unsigned char *p, size_t n) {
+            return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[n >> 1]) << 8) | p[n - 1];
+        }
+    }
+
+    uint64_t hash_bytes(myString_view str, uint64_t seed) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(str.data());
+        size_t n = str.size();
+        uint64_t a, b;
+        seed ^= mix(seed ^ secret0, secret1);
+        if (n <= 16) {
+            if (n >= 4) {
+                // 4到16个字节：头尾各取两个可能重叠的4字节
+                size_t shift = (n >> 3) << 2;
+                a = (read4(p) << 32) | read4(p + shift);
+                b = (read4(p + n - 4) << 32) | read4(p + n - 4 - shift);
+            } else if (n > 0) {
+                a = read_small(p, n);
+                b = 0;
+            } else {
+                a = b = 0;
+            }
+        } else {
+            size_t left = n;
+            if (left > 48) {
+                // 三条互不依赖的乘法链，让乘法器流水起来
+                uint64_t seed1 = seed, seed2 = seed;
+                do {
+                    seed = mix(read8(p) ^ secret1, read8(p + 8) ^ seed);
+                    seed1 = mix(read8(p + 16) ^ secret2, read8(p + 24) ^ seed1);
+                    seed2 = mix(read8(p + 32) ^ secret3, read8(p + 40) ^ seed2);
+                    p += 48;
+                    left -= 48;
+                } while (left > 48);
+                seed ^= seed1 ^ seed2;
+            }
+            while (left > 16) {
+                seed = mix(read8(p) ^ secret1, read8(p + 8) ^ seed);
+                p += 16;
+                left -= 16;
+            }
+            // 最后16个字节，可能与已处理的部分重叠
+            a = read8(p + left - 16);
+            b = read8(p + left - 8);
+        }
+        a ^= secret1;
+        b ^= seed;
+        multiply(a, b);
+        return mix(a ^ secret0 ^ n, b ^ secret1);
+    }
+
+    // 构造函数（创建空字符串）
+    myHashedString::myHashedString() : _hash(0), _hashed(false) {}
+
+    // 构造函数（使用C风格字符串构造）
+    myHashedString::myHashedString(const char *str) : _str(str), _hash(0), _hashed(false) {}
+
+    // 构造函数（使用字符序列的前n个字符构造）
+    myHashedString::myHashedString(const char *str, size_t n) : _str(str, n), _hash(0), _hashed(false) {}
+
+    // 构造函数（拷贝视图的数据）
+    myHashedString::myHashedString(myString_view str) : _str(str.data(), str.size()), _hash(0), _hashed(false) {}
+
+    const char *myHashedString::c_str() const {
+        return _str.c_str();
+    }
+
+    size_t myHashedString::size() const {
+        return _str.size();
+    }
+
+    bool myHashedString::empty() const {
+        return _str.empty();
+    }
+
+    const char &myHashedString::operator[](size_t pos) const {
+        return _str[pos];
+    }
+
+    myHashedString::const_iterator myHashedString::begin() const {
+        return _str.begin();
+    }
+
+    myHashedString::const_iterator myHashedString::end() const {
+        return _str.end();
+    }
+
+    const myString &myHashedString::str() const {
+        return _str;
+    }
+
+    myString_view myHashedString::view() const {
+        return _str.view();
+    }
+
+    myHashedString::operator myString_view() const {
+        return _str.view();
+    }
+
+    uint64_t myHashedString::hash() const {
+        if (!_hashed) {
+            _hash = hash_bytes(_str.view());
+            _hashed = true;
+        }
+        return _hash;
+    }
+
+    bool myHashedString::hashed() const {
+        return _hashed;
+    }
+
+    void myHashedString::push_back(char ch) {
+        _hashed = false;
+        _str.push_back(ch);
+    }
+
+    void myHashedString::append(myString_view str) {
+        _hashed = false;
+        _str.append(str.data(), str.size());
+    }
+
+    myHashedString &myHashedString::operator+=(myString_view str) {
+        append(str);
+        return *this;
+    }
+
+    // 先拷贝再交换，str可以引用本对象的数据
+    void myHashedString::assign(myString_view str) {
+        _hashed = false;
+        myString copy(str.data(), str.size(), _str.resource());
+        _str.swap(copy);
+    }
+
+    void myHashedString::clear() {
+        _hashed = false;
+        _str.clear();
+    }
+
+    bool operator==(const myHashedString &left, const myHashedString &right) {
+        if (left.hashed() && right.hashed() && left.hash() != right.hash()) {
+            return false;
+        }
+        return left.view() == right.view();
+    }
+
+    bool operator!=(const myHashedString &left, const myHashedString &right) {
+        return !(left == right);
+    }
+
+    std::ostream &operator<<(std::ostream &out, const myHashedString &str) {
+        return out << str.view();
+    }
+}
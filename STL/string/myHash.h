@@ -0,0 +1,115 @@
+// Fast non-cryptographic string hash and a string that caches its hash.
+
+#ifndef STRING_MYHASH_H
+#define STRING_MYHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include "myString.h"
+#include "myString_view.h"
+
+namespace cocoon {
+    // wyhash（final4）：每次读8字节，用64×64→128位乘法把两半异或在一起混合，
+    // 长输入三路并行，每轮吃48字节。不是密码学哈希，不能抵御刻意构造的碰撞。
+    // 结果与平台字节序有关，不要写进文件或在机器之间传递。
+    [[nodiscard]] uint64_t hash_bytes(myString_view str, uint64_t seed = 0);
+
+    // 缓存哈希值的字符串：第一次调用hash()时计算并保存，之后直接返回，所以同一个键反复查找、
+    // 插入或随哈希表重排时不再扫描数据；任何修改都会让缓存失效。
+    // 只提供只读访问和少量修改接口，其他修改通过modify进行，保证不会绕过失效。
+    // hash()会写入缓存，多个线程共享同一对象时先在一个线程里调用一次。
+    class myHashedString {
+    private:
+        myString _str;
+        mutable uint64_t _hash;     // _hashed为true时有效
+        mutable bool _hashed;
+
+    public:
+        typedef const char *const_iterator;
+
+        // 构造函数（创建空字符串）
+        myHashedString();
+
+        // 构造函数（使用C风格字符串构造）
+        explicit myHashedString(const char *str);
+
+        // 构造函数（使用字符序列的前n个字符构造）
+        myHashedString(const char *str, size_t n);
+
+        // 构造函数（拷贝视图的数据）
+        explicit myHashedString(myString_view str);
+
+        // 返回C风格字符串
+        [[nodiscard]] const char *c_str() const;
+
+        // 返回字符串长度
+        [[nodiscard]] size_t size() const;
+
+        // 判空
+        [[nodiscard]] bool empty() const;
+
+        const char &operator[](size_t pos) const;
+
+        [[nodiscard]] const_iterator begin() const;
+
+        [[nodiscard]] const_iterator end() const;
+
+        // 底层字符串，只读
+        [[nodiscard]] const myString &str() const;
+
+        // 转换为视图，修改本对象后视图失效
+        [[nodiscard]] myString_view view() const;
+
+        operator myString_view() const;
+
+        // 哈希值，与hash_bytes和std::hash<myString_view>相同
+        [[nodiscard]] uint64_t hash() const;
+
+        // 缓存是否有效
+        [[nodiscard]] bool hashed() const;
+
+        // 修改：都会让缓存失效
+        void push_back(char ch);
+
+        void append(myString_view str);
+
+        myHashedString &operator+=(myString_view str);
+
+        void assign(myString_view str);
+
+        void clear();
+
+        // 其他修改：f(myString &)直接修改底层字符串
+        template<class Function>
+        void modify(Function f);
+    };
+
+    // 两边都缓存了哈希值时先比较哈希，不同就不必比较数据
+    bool operator==(const myHashedString &left, const myHashedString &right);
+
+    bool operator!=(const myHashedString &left, const myHashedString &right);
+
+    std::ostream &operator<<(std::ostream &out, const myHashedString &str);
+
+    template<class Function>
+    void myHashedString::modify(Function f) {
+        _hashed = false;
+        f(_str);
+    }
+}
+
+namespace std {
+    // 直接返回缓存的哈希值；与视图的哈希一致，可以用视图或C风格字符串查找
+    template<>
+    struct hash<cocoon::myHashedString> : hash<cocoon::myString_view> {
+        using hash<cocoon::myString_view>::operator();
+
+        size_t operator()(const cocoon::myHashedString &str) const {
+            return static_cast<size_t>(str.hash());
+        }
+    };
+}
+
+#endif //STRING_MYHASH_H
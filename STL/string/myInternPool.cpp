@@ -0,0 +1,222 @@
+#include <new>
+#include "myInternPool.h"
+
+namespace cocoon {
+    myInterned::myInterned() : _entry(nullptr) {}
+
+    // 返回C风格字符串
+    const char *myInterned::c_str() const {
+        return _entry ? _entry->_data : "";
+    }
+
+    // 返回字符串长度
+    size_t myInterned::size() const {
+        return _entry ? _entry->_size : 0;
+    }
+
+    // 判空
+    bool myInterned::empty() const {
+        return size() == 0;
+    }
+
+    uint64_t myInterned::hash() const {
+        return _entry ? _entry->_hash : myInternPool::hash(myString_view());
+    }
+
+    // 转换为视图，不拷贝数据
+    myString_view myInterned::view() const {
+        return {c_str(), size()};
+    }
+
+    myInterned::operator myString_view() const {
+        return view();
+    }
+
+    // 内存块：驻留的字符串依次存放，块用完后再申请新块，已有数据从不移动
+    struct myInternPool::block {
+        block *_next;
+        size_t _used;
+        size_t _capacity;
+        alignas(myInterned::entry) char _data[1];
+    };
+
+    // 分片：开放寻址（线性探测）表，槽中存放指向内存块中数据的指针
+    struct myInternPool::shard {
+        mutable std::shared_mutex _lock;
+        const myInterned::entry **_slots = nullptr;
+        size_t _mask = 0;
+        size_t _count = 0;
+        block *_blocks = nullptr;
+
+        // 命中路径只持有共享锁，计数器用原子变量
+        std::atomic<size_t> _lookups{0};
+        std::atomic<size_t> _hits{0};
+        std::atomic<size_t> _bytes_saved{0};
+        size_t _unique_bytes = 0;
+        size_t _arena_bytes = 0;
+    };
+
+    // 每个内存块的默认大小
+    static const size_t block_size = 64 * 1024;
+
+    // 构造函数
+    myInternPool::myInternPool(size_t shards) {
+        size_t count = 1;
+        while (count < shards) {
+            count *= 2;
+        }
+        _shards = new shard[count];
+        _shard_mask = count - 1;
+        for (size_t index = 0; index < count; index++) {
+            _shards[index]._slots = new const myInterned::entry *[16]();
+            _shards[index]._mask = 15;
+        }
+    }
+
+    // 析构函数
+    myInternPool::~myInternPool() {
+        for (size_t index = 0; index <= _shard_mask; index++) {
+            delete[] _shards[index]._slots;
+            block *cur = _shards[index]._blocks;
+            while (cur) {
+                block *next = cur->_next;
+                ::operator delete(cur);
+                cur = next;
+            }
+        }
+        delete[] _shards;
+    }
+
+    // 与std::hash<myString_view>相同，驻留的句柄可以和其他容器共用哈希值
+    uint64_t myInternPool::hash(myString_view str) {
+        return std::hash<myString_view>()(str);
+    }
+
+    // 在分片中查找str，调用者需持有锁
+    const myInterned::entry *myInternPool::probe(const shard &s, myString_view str, uint64_t h) {
+        size_t index = h & s._mask;
+        while (const myInterned::entry *e = s._slots[index]) {
+            if (e->_hash == h && e->_size == str.size() &&
+                memcmp(e->_data, str.data(), str.size()) == 0) {
+                return e;
+            }
+            index = (index + 1) & s._mask;
+        }
+        return nullptr;
+    }
+
+    // 表扩容为两倍，只搬动指针，不搬动数据
+    void myInternPool::grow(shard &s) {
+        size_t capacity = (s._mask + 1) * 2;
+        const myInterned::entry **slots = new const myInterned::entry *[capacity]();
+        for (size_t index = 0; index <= s._mask; index++) {
+            const myInterned::entry *e = s._slots[index];
+            if (e) {
+                size_t pos = e->_hash & (capacity - 1);
+                while (slots[pos]) {
+                    pos = (pos + 1) & (capacity - 1);
+                }
+                slots[pos] = e;
+            }
+        }
+        delete[] s._slots;
+        s._slots = slots;
+        s._mask = capacity - 1;
+    }
+
+    // 把str拷贝进分片的内存块
+    myInterned::entry *myInternPool::store(shard &s, myString_view str, uint64_t h) {
+        const size_t align = alignof(myInterned::entry);
+        size_t bytes = (offsetof(myInterned::entry, _data) + str.size() + 1 + align - 1) / align * align;
+        block *cur = s._blocks;
+        if (!cur || cur->_used + bytes > cur->_capacity) {
+            // 超长字符串单独占一个块
+            size_t capacity = bytes > block_size ? bytes : block_size;
+            cur = static_cast<block *>(::operator new(offsetof(block, _data) + capacity));
+            cur->_next = s._blocks;
+            cur->_used = 0;
+            cur->_capacity = capacity;
+            s._blocks = cur;
+            s._arena_bytes += offsetof(block, _data) + capacity;
+        }
+        auto *e = reinterpret_cast<myInterned::entry *>(cur->_data + cur->_used);
+        cur->_used += bytes;
+        e->_size = str.size();
+        e->_hash = h;
+        memcpy(e->_data, str.data(), str.size());
+        e->_data[str.size()] = '\0';
+        s._unique_bytes += str.size();
+        return e;
+    }
+
+    // 驻留str，返回它的唯一句柄
+    myInterned myInternPool::intern(myString_view str) {
+        if (str.empty()) {
+            return myInterned();
+        }
+        uint64_t h = hash(str);
+        shard &s = _shards[(h >> 48) & _shard_mask];
+        s._lookups.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::shared_lock<std::shared_mutex> guard(s._lock);
+            if (const myInterned::entry *e = probe(s, str, h)) {
+                s._hits.fetch_add(1, std::memory_order_relaxed);
+                s._bytes_saved.fetch_add(str.size(), std::memory_order_relaxed);
+                return myInterned(e);
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> guard(s._lock);
+        // 释放共享锁后其他线程可能已经插入
+        if (const myInterned::entry *e = probe(s, str, h)) {
+            s._hits.fetch_add(1, std::memory_order_relaxed);
+            s._bytes_saved.fetch_add(str.size(), std::memory_order_relaxed);
+            return myInterned(e);
+        }
+        // 装载因子不超过3/4
+        if ((s._count + 1) * 4 > (s._mask + 1) * 3) {
+            grow(s);
+        }
+        myInterned::entry *e = store(s, str, h);
+        size_t index = h & s._mask;
+        while (s._slots[index]) {
+            index = (index + 1) & s._mask;
+        }
+        s._slots[index] = e;
+        s._count++;
+        return myInterned(e);
+    }
+
+    // 只查找不驻留
+    myInterned myInternPool::find(myString_view str) const {
+        if (str.empty()) {
+            return myInterned();
+        }
+        uint64_t h = hash(str);
+        const shard &s = _shards[(h >> 48) & _shard_mask];
+        std::shared_lock<std::shared_mutex> guard(s._lock);
+        return myInterned(probe(s, str, h));
+    }
+
+    // 返回统计信息
+    myInternPool::statistics myInternPool::stats() const {
+        statistics result = {0, 0, 0, 0, 0, 0};
+        for (size_t index = 0; index <= _shard_mask; index++) {
+            const shard &s = _shards[index];
+            std::shared_lock<std::shared_mutex> guard(s._lock);
+            result.lookups += s._lookups.load(std::memory_order_relaxed);
+            result.hits += s._hits.load(std::memory_order_relaxed);
+            result.bytes_saved += s._bytes_saved.load(std::memory_order_relaxed);
+            result.unique_strings += s._count;
+            result.unique_bytes += s._unique_bytes;
+            result.arena_bytes += s._arena_bytes;
+        }
+        return result;
+    }
+
+    // 重载输出运算符，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, const myInterned &str) {
+        out.write(str.c_str(), static_cast<std::streamsize>(str.size()));
+        return out;
+    }
+}
@@ -0,0 +1,128 @@
+// String interning pool for myString keys.
+
+#ifndef STRING_MYINTERNPOOL_H
+#define STRING_MYINTERNPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include "myString_view.h"
+
+namespace cocoon {
+    class myInternPool;
+
+    // 驻留字符串的句柄：只有一个指针大小，指向池中唯一的一份不可变数据。
+    // 同一个池中内容相同的字符串句柄相同，所以比较只比指针，哈希值在驻留时就已算好。
+    class myInterned {
+    public:
+        // 构造函数（空句柄，表示空字符串；驻留空字符串得到的也是空句柄）
+        myInterned();
+
+        // 返回C风格字符串
+        [[nodiscard]] const char *c_str() const;
+
+        // 返回字符串长度
+        [[nodiscard]] size_t size() const;
+
+        // 判空
+        [[nodiscard]] bool empty() const;
+
+        // 驻留时算好的哈希值，O(1)
+        [[nodiscard]] uint64_t hash() const;
+
+        // 转换为视图，不拷贝数据
+        [[nodiscard]] myString_view view() const;
+
+        operator myString_view() const;
+
+        bool operator==(const myInterned &other) const { return _entry == other._entry; }
+
+        bool operator!=(const myInterned &other) const { return _entry != other._entry; }
+
+    private:
+        friend class myInternPool;
+
+        // 池中每个字符串的存储：长度、哈希值和以'\0'结尾的数据连续存放
+        struct entry {
+            size_t _size;
+            uint64_t _hash;
+            char _data[1];
+        };
+
+        explicit myInterned(const entry *e) : _entry(e) {}
+
+        const entry *_entry;
+    };
+
+    // 字符串驻留池：把内容相同的字符串映射到同一份存放在内存块（arena）里的数据。
+    // 按哈希值分成若干分片，每个分片一张开放寻址表和一把读写锁：
+    // 查找命中只加共享锁，多个线程可以同时查找；未命中才加独占锁插入。
+    // 驻留的数据直到池析构才释放，句柄在此之前一直有效。
+    class myInternPool {
+    public:
+        // 统计信息
+        struct statistics {
+            size_t lookups;         // intern()调用次数
+            size_t hits;            // 其中已驻留的次数
+            size_t unique_strings;  // 不同字符串的个数
+            size_t unique_bytes;    // 不同字符串的字符总数
+            size_t bytes_saved;     // 命中时少存的字符数
+            size_t arena_bytes;     // 内存块占用的字节数
+
+            [[nodiscard]] double hit_ratio() const { return lookups ? double(hits) / double(lookups) : 0.0; }
+        };
+
+        // 构造函数，shards会向上取整为2的幂
+        explicit myInternPool(size_t shards = 16);
+
+        myInternPool(const myInternPool &) = delete;
+
+        myInternPool &operator=(const myInternPool &) = delete;
+
+        // 析构函数，释放全部驻留数据
+        ~myInternPool();
+
+        // 驻留str，返回它的唯一句柄
+        myInterned intern(myString_view str);
+
+        // 只查找不驻留，没有驻留过时返回空句柄
+        [[nodiscard]] myInterned find(myString_view str) const;
+
+        // 返回统计信息
+        [[nodiscard]] statistics stats() const;
+
+        // 计算驻留使用的哈希值
+        static uint64_t hash(myString_view str);
+
+    private:
+        struct block;
+        struct shard;
+
+        static const myInterned::entry *probe(const shard &s, myString_view str, uint64_t h);
+
+        static void grow(shard &s);
+
+        static myInterned::entry *store(shard &s, myString_view str, uint64_t h);
+
+        shard *_shards;
+        size_t _shard_mask;
+    };
+
+    // 重载输出运算符，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, const myInterned &str);
+}
+
+namespace std {
+    template<>
+    struct hash<cocoon::myInterned> {
+        size_t operator()(const cocoon::myInterned &str) const {
+            return static_cast<size_t>(str.hash());
+        }
+    };
+}
+
+#endif //STRING_MYINTERNPOOL_H
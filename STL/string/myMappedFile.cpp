@@ -0,0 +1,135 @@
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "myMappedFile.h"
+
+namespace cocoon {
+    namespace {
+        // 透明大页的大小，映射按它对齐内核才能用大页
+        const size_t huge_page_size = 2 * 1024 * 1024;
+
+        int advice_of(myMappedFile::access pattern) {
+            switch (pattern) {
+                case myMappedFile::access::sequential:
+                    return MADV_SEQUENTIAL;
+                case myMappedFile::access::random:
+                    return MADV_RANDOM;
+                default:
+                    return MADV_NORMAL;
+            }
+        }
+    }
+
+    // 打开并映射文件
+    myMappedFile::myMappedFile(const char *path, access pattern, bool huge_pages)
+            : _data(""), _size(0), _length(0), _huge(false) {
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "myMappedFile: open");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int saved = errno;
+            ::close(fd);
+            throw std::system_error(saved, std::generic_category(), "myMappedFile: fstat");
+        }
+        _size = static_cast<size_t>(st.st_size);
+        if (_size == 0) {
+            // 长度为0的映射不合法，空文件直接用空串
+            ::close(fd);
+            return;
+        }
+
+        void *addr = nullptr;
+        _length = _size;
+        if (huge_pages && _size >= huge_page_size) {
+            // 先预留多出一个大页的地址空间，再把文件映射到其中按大页对齐的位置
+            void *reserved = ::mmap(nullptr, _size + huge_page_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (reserved != MAP_FAILED) {
+                size_t base = reinterpret_cast<size_t>(reserved);
+                size_t aligned = (base + huge_page_size - 1) & ~(huge_page_size - 1);
+                ::munmap(reserved, _size + huge_page_size);
+                addr = reinterpret_cast<void *>(aligned);
+            }
+        }
+        // addr只是提示：对齐的地址被其他线程抢占时，内核另选地址，只是用不上大页
+        void *map = ::mmap(addr, _length, PROT_READ, MAP_SHARED, fd, 0);
+        int saved = errno;
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            throw std::system_error(saved, std::generic_category(), "myMappedFile: mmap");
+        }
+        _data = static_cast<const char *>(map);
+
+        advise(pattern);
+#ifdef MADV_HUGEPAGE
+        if (huge_pages) {
+            _huge = ::madvise(map, _length, MADV_HUGEPAGE) == 0;
+        }
+#endif
+    }
+
+    myMappedFile::myMappedFile(myMappedFile &&file) noexcept
+            : _data(file._data), _size(file._size), _length(file._length), _huge(file._huge) {
+        file._data = "";
+        file._size = 0;
+        file._length = 0;
+        file._huge = false;
+    }
+
+    myMappedFile::~myMappedFile() {
+        if (_length) {
+            ::munmap(const_cast<char *>(_data), _length);
+        }
+    }
+
+    const char *myMappedFile::data() const {
+        return _data;
+    }
+
+    size_t myMappedFile::size() const {
+        return _size;
+    }
+
+    bool myMappedFile::empty() const {
+        return _size == 0;
+    }
+
+    myMappedFile::const_iterator myMappedFile::begin() const {
+        return _data;
+    }
+
+    myMappedFile::const_iterator myMappedFile::end() const {
+        return _data + _size;
+    }
+
+    myString_view myMappedFile::view() const {
+        return {_data, _size};
+    }
+
+    myMappedFile::operator myString_view() const {
+        return view();
+    }
+
+    size_t myMappedFile::find(char ch, size_t pos) const {
+        return view().find(ch, pos);
+    }
+
+    size_t myMappedFile::find(myString_view str, size_t pos) const {
+        return view().find(str, pos);
+    }
+
+    // 建议失败只影响预读，不影响正确性，忽略错误
+    void myMappedFile::advise(access pattern) const {
+        if (_length) {
+            ::madvise(const_cast<char *>(_data), _length, advice_of(pattern));
+        }
+    }
+
+    bool myMappedFile::huge_pages() const {
+        return _huge;
+    }
+}
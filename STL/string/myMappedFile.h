@@ -0,0 +1,99 @@
+// Read-only memory-mapped file exposed as a string view.
+
+#ifndef STRING_MYMAPPEDFILE_H
+#define STRING_MYMAPPEDFILE_H
+
+#include <cstddef>
+#include "myString_view.h"
+
+namespace cocoon {
+    // 只读映射整个文件，通过myString_view的查找、遍历和切分接口直接访问文件内容，不拷贝数据。
+    // 页面在第一次访问时由内核读入，所以打开大文件几乎不花时间，扫描速度取决于页缓存。
+    // 映射期间文件被其他进程截断时，访问被截掉的部分会收到SIGBUS。
+    class myMappedFile {
+    public:
+        const static size_t npos = -1;
+
+        typedef const char *iterator;
+        typedef const char *const_iterator;
+
+        // 访问模式，用madvise告诉内核如何预读
+        enum class access {
+            sequential,     // 从头到尾扫描：加大预读，读过的页面可以尽早回收
+            random,         // 随机查找：关闭预读
+            normal          // 内核默认策略
+        };
+
+        // 打开并映射文件；huge_pages为true时请求透明大页（尽力而为，不支持时退回普通页面）
+        // 打开或映射失败时抛出std::system_error
+        explicit myMappedFile(const char *path, access pattern = access::sequential, bool huge_pages = false);
+
+        myMappedFile(const myMappedFile &) = delete;
+
+        myMappedFile &operator=(const myMappedFile &) = delete;
+
+        myMappedFile(myMappedFile &&file) noexcept;
+
+        ~myMappedFile();
+
+        // 返回文件内容的指针，不以'\0'结尾
+        [[nodiscard]] const char *data() const;
+
+        // 返回文件大小
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] bool empty() const;
+
+        [[nodiscard]] const_iterator begin() const;
+
+        [[nodiscard]] const_iterator end() const;
+
+        // 转换为视图，与文件映射同生命周期
+        [[nodiscard]] myString_view view() const;
+
+        operator myString_view() const;
+
+        // 查找
+        [[nodiscard]] size_t find(char ch, size_t pos = 0) const;
+
+        [[nodiscard]] size_t find(myString_view str, size_t pos = 0) const;
+
+        // 修改访问模式，例如先顺序扫描建立索引，再随机查找
+        void advise(access pattern) const;
+
+        // 是否拿到了大页（请求了大页且内核接受了MADV_HUGEPAGE）
+        [[nodiscard]] bool huge_pages() const;
+
+        // 按行遍历，依次把每一行（不含'\n'和行尾的'\r'）交给f(myString_view)
+        // 文件以'\n'结尾时不会多出一个空行
+        template<class Function>
+        void for_each_line(Function f) const;
+
+    private:
+        const char *_data;  // 映射的起始地址，空文件时指向""
+        size_t _size;       // 文件大小
+        size_t _length;     // 映射长度，空文件时为0
+        bool _huge;         // 内核是否接受了大页请求
+    };
+
+    template<class Function>
+    void myMappedFile::for_each_line(Function f) const {
+        size_t start = 0;
+        myString_view text = view();
+        while (start < _size) {
+            size_t pos = text.find('\n', start);
+            size_t stop = pos == npos ? _size : pos;
+            size_t len = stop - start;
+            if (len > 0 && _data[stop - 1] == '\r') {
+                len--;
+            }
+            f(myString_view(_data + start, len));
+            if (pos == npos) {
+                return;
+            }
+            start = pos + 1;
+        }
+    }
+}
+
+#endif //STRING_MYMAPPEDFILE_H
@@ -0,0 +1,49 @@
+#include <charconv>
+#include "myNumeric.h"
+
+namespace cocoon {
+    size_t format_int(char *buffer, long long val) {
+        return std::to_chars(buffer, buffer + max_int_chars, val).ptr - buffer;
+    }
+
+    size_t format_uint(char *buffer, unsigned long long val) {
+        return std::to_chars(buffer, buffer + max_int_chars, val).ptr - buffer;
+    }
+
+    // to_chars不指定格式和精度时，输出的是能还原原值的最短表示
+    size_t format_double(char *buffer, double val) {
+        return std::to_chars(buffer, buffer + max_double_chars, val).ptr - buffer;
+    }
+
+    // from_chars不接受'+'，这里先去掉
+    static myString_view skip_plus(myString_view str) {
+        if (str.size() > 1 && str[0] == '+' && str[1] != '-') {
+            str.remove_prefix(1);
+        }
+        return str;
+    }
+
+    template<class T>
+    static bool parse_all(myString_view str, T &val) {
+        str = skip_plus(str);
+        T result;
+        std::from_chars_result parsed = std::from_chars(str.begin(), str.end(), result);
+        if (parsed.ec != std::errc() || parsed.ptr != str.end()) {
+            return false;
+        }
+        val = result;
+        return true;
+    }
+
+    bool parse_int(myString_view str, long long &val) {
+        return parse_all(str, val);
+    }
+
+    bool parse_uint(myString_view str, unsigned long long &val) {
+        return parse_all(str, val);
+    }
+
+    bool parse_double(myString_view str, double &val) {
+        return parse_all(str, val);
+    }
+}
@@ -0,0 +1,31 @@
+// Numeric formatting and parsing without iostreams.
+
+#ifndef STRING_MYNUMERIC_H
+#define STRING_MYNUMERIC_H
+
+#include <cstddef>
+#include "myString_view.h"
+
+namespace cocoon {
+    // 各种数值格式化后最多占用的字符数
+    const size_t max_int_chars = 20;       // -9223372036854775808
+    const size_t max_double_chars = 24;    // -2.2250738585072014e-308
+
+    // 把val写到buffer，返回写入的字符数，不写'\0'。buffer至少要有对应的max_*_chars个字节
+    size_t format_int(char *buffer, long long val);
+
+    size_t format_uint(char *buffer, unsigned long long val);
+
+    // 输出能精确还原val的最短表示（基于std::to_chars）
+    size_t format_double(char *buffer, double val);
+
+    // 把整个str解析为数值，允许开头的'+'或'-'；有多余字符、为空或溢出时返回false且不修改val
+    bool parse_int(myString_view str, long long &val);
+
+    bool parse_uint(myString_view str, unsigned long long &val);
+
+    // 接受十进制和科学计数法，以及inf和nan
+    bool parse_double(myString_view str, double &val);
+}
+
+#endif //STRING_MYNUMERIC_H
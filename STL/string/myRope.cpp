@@ -0,0 +1,232 @@
+#include "myRope.h"
+
+namespace cocoon {
+    // 叶子结点
+    myRope::node::node(const char *str, size_t n)
+            : _text(str, n), _length(n), _height(0) {}
+
+    // 内部结点
+    myRope::node::node(node_ptr left, node_ptr right)
+            : _left(std::move(left)), _right(std::move(right)) {
+        _length = _left->_length + _right->_length;
+        _height = (_left->_height > _right->_height ? _left->_height : _right->_height) + 1;
+    }
+
+    // 构造函数（创建空字符串）
+    myRope::myRope() = default;
+
+    // 构造函数（使用C风格字符串构造）
+    myRope::myRope(const char *str) : _root(build(str, strlen(str))) {}
+
+    // 构造函数（使用字符序列的前n个字符构造）
+    myRope::myRope(const char *str, size_t n) : _root(build(str, n)) {}
+
+    // 构造函数（使用myString构造）
+    myRope::myRope(const myString &str) : _root(build(str.c_str(), str.size())) {}
+
+    myRope::myRope(node_ptr root) : _root(std::move(root)) {}
+
+    int myRope::height(const node_ptr &t) {
+        return t ? t->_height : -1;
+    }
+
+    // 把字符序列切成叶子并自底向上建成完全平衡的树
+    myRope::node_ptr myRope::build(const char *str, size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        if (n <= max_leaf) {
+            return std::make_shared<const node>(str, n);
+        }
+        // 按叶子个数对半分，保证左右两边都是整叶子
+        size_t leaves = (n + max_leaf - 1) / max_leaf;
+        size_t half = leaves / 2 * max_leaf;
+        return make(build(str, half), build(str + half, n - half));
+    }
+
+    myRope::node_ptr myRope::make(const node_ptr &left, const node_ptr &right) {
+        return std::make_shared<const node>(left, right);
+    }
+
+    // 连接高度差不超过2的两棵树，必要时做一次单旋或双旋
+    myRope::node_ptr myRope::balance(const node_ptr &left, const node_ptr &right) {
+        if (height(left) > height(right) + 1) {
+            if (height(left->_left) >= height(left->_right)) {
+                return make(left->_left, make(left->_right, right));
+            }
+            return make(make(left->_left, left->_right->_left),
+                        make(left->_right->_right, right));
+        }
+        if (height(right) > height(left) + 1) {
+            if (height(right->_right) >= height(right->_left)) {
+                return make(make(left, right->_left), right->_right);
+            }
+            return make(make(left, right->_left->_left),
+                        make(right->_left->_right, right->_right));
+        }
+        return make(left, right);
+    }
+
+    // 连接两棵任意高度的树：沿较高一棵的边缘下降到高度相近处再连接，O(高度差)
+    myRope::node_ptr myRope::join(const node_ptr &left, const node_ptr &right) {
+        if (!left) {
+            return right;
+        }
+        if (!right) {
+            return left;
+        }
+        // 两个小叶子合并成一个，避免编辑后留下大量碎片
+        if (left->is_leaf() && right->is_leaf() && left->_length + right->_length <= max_leaf) {
+            auto merged = std::make_shared<node>(left->_text.c_str(), left->_length);
+            merged->_text.append(right->_text.c_str(), right->_length);
+            merged->_length += right->_length;
+            return merged;
+        }
+        if (left->_height > right->_height + 1) {
+            return balance(left->_left, join(left->_right, right));
+        }
+        if (right->_height > left->_height + 1) {
+            return balance(join(left, right->_left), right->_right);
+        }
+        return make(left, right);
+    }
+
+    // 把t分成前pos个字符和其余字符两棵树
+    void myRope::split(node_ptr t, size_t pos, node_ptr &left, node_ptr &right) {
+        if (!t || pos == 0) {
+            left = nullptr;
+            right = t;
+            return;
+        }
+        if (pos >= t->_length) {
+            left = t;
+            right = nullptr;
+            return;
+        }
+        if (t->is_leaf()) {
+            // 只有被切开的叶子需要拷贝数据
+            const char *text = t->_text.c_str();
+            left = std::make_shared<const node>(text, pos);
+            right = std::make_shared<const node>(text + pos, t->_length - pos);
+            return;
+        }
+        size_t left_length = t->_left->_length;
+        if (pos < left_length) {
+            node_ptr rest;
+            split(t->_left, pos, left, rest);
+            right = join(rest, t->_right);
+        } else {
+            node_ptr rest;
+            split(t->_right, pos - left_length, rest, right);
+            left = join(t->_left, rest);
+        }
+    }
+
+    // 返回字符串长度
+    size_t myRope::size() const {
+        return _root ? _root->_length : 0;
+    }
+
+    // 判空
+    bool myRope::empty() const {
+        return !_root;
+    }
+
+    // 访问pos位置的字符
+    char myRope::operator[](size_t pos) const {
+        assert(pos < size());
+        const node *cur = _root.get();
+        while (!cur->is_leaf()) {
+            if (pos < cur->_left->_length) {
+                cur = cur->_left.get();
+            } else {
+                pos -= cur->_left->_length;
+                cur = cur->_right.get();
+            }
+        }
+        return cur->_text[pos];
+    }
+
+    // 在指定位置插入字符串
+    myRope &myRope::insert(size_t pos, const char *str) {
+        return insert(pos, myRope(str));
+    }
+
+    // 在指定位置插入另一个rope
+    myRope &myRope::insert(size_t pos, const myRope &rope) {
+        assert(pos <= size());
+        node_ptr left, right;
+        split(_root, pos, left, right);
+        _root = join(join(left, rope._root), right);
+        return *this;
+    }
+
+    // 尾部插入字符串
+    myRope &myRope::append(const char *str) {
+        _root = join(_root, build(str, strlen(str)));
+        return *this;
+    }
+
+    myRope &myRope::append(const myRope &rope) {
+        _root = join(_root, rope._root);
+        return *this;
+    }
+
+    // +=运算符重载
+    myRope &myRope::operator+=(const char *str) {
+        return append(str);
+    }
+
+    // 删除
+    myRope &myRope::erase(size_t pos, size_t len) {
+        assert(pos <= size());
+        node_ptr left, middle, right;
+        split(_root, pos, left, right);
+        if (len != npos) {
+            split(right, len, middle, right);
+        } else {
+            right = nullptr;
+        }
+        _root = join(left, right);
+        return *this;
+    }
+
+    // 取子串
+    myRope myRope::substr(size_t pos, size_t len) const {
+        assert(pos <= size());
+        node_ptr left, middle, right;
+        split(_root, pos, left, middle);
+        if (len != npos) {
+            split(middle, len, middle, right);
+        }
+        return myRope(middle);
+    }
+
+    // 拼接成一个连续的myString
+    myString myRope::flatten() const {
+        myString result;
+        result.reserve(size());
+        for_each_chunk([&result](const char *data, size_t len) {
+            result.append(data, len);
+        });
+        return result;
+    }
+
+    // 清空字符串
+    void myRope::clear() {
+        _root = nullptr;
+    }
+
+    // 交换对象函数
+    void myRope::swap(myRope &rope) {
+        std::swap(_root, rope._root);
+    }
+
+    // 重载输出运算符，每个叶子一次写出
+    std::ostream &operator<<(std::ostream &out, const myRope &rope) {
+        rope.for_each_chunk([&out](const char *data, size_t len) {
+            out.write(data, static_cast<std::streamsize>(len));
+        });
+        return out;
+    }
+}
@@ -0,0 +1,135 @@
+// Rope string built from myString chunks.
+
+#ifndef STRING_MYROPE_H
+#define STRING_MYROPE_H
+
+#include <cstddef>
+#include <memory>
+#include <iostream>
+#include "myString.h"
+
+namespace cocoon {
+    // 绳索（rope）字符串：叶子结点是不超过max_leaf个字符的myString，内部结点按AVL规则保持平衡。
+    // 结点创建后不再修改，可以被多个rope共享，所以插入、删除、取子串都只需新建O(log n)个结点。
+    class myRope {
+    public:
+        const static size_t npos = -1;
+
+        // 叶子结点最多存放的字符数
+        const static size_t max_leaf = 1024;
+
+        // 构造函数（创建空字符串）
+        myRope();
+
+        // 构造函数（使用C风格字符串构造）
+        explicit myRope(const char *str);
+
+        // 构造函数（使用字符序列的前n个字符构造）
+        myRope(const char *str, size_t n);
+
+        // 构造函数（使用myString构造）
+        explicit myRope(const myString &str);
+
+        // 返回字符串长度
+        [[nodiscard]] size_t size() const;
+
+        // 判空
+        [[nodiscard]] bool empty() const;
+
+        // 访问pos位置的字符，O(log n)
+        char operator[](size_t pos) const;
+
+        // 在指定位置插入字符串
+        myRope &insert(size_t pos, const char *str);
+
+        // 在指定位置插入另一个rope，结点共享不拷贝
+        myRope &insert(size_t pos, const myRope &rope);
+
+        // 尾部插入字符串
+        myRope &append(const char *str);
+
+        myRope &append(const myRope &rope);
+
+        // +=运算符重载
+        myRope &operator+=(const char *str);
+
+        // 删除
+        myRope &erase(size_t pos, size_t len = npos);
+
+        // 取子串，与原rope共享结点
+        [[nodiscard]] myRope substr(size_t pos, size_t len = npos) const;
+
+        // 拼接成一个连续的myString，只分配一次内存
+        [[nodiscard]] myString flatten() const;
+
+        // 按顺序把每个叶子的数据交给f(const char *data, size_t len)
+        template<class Function>
+        void for_each_chunk(Function f) const;
+
+        // 清空字符串
+        void clear();
+
+        // 交换对象函数
+        void swap(myRope &rope);
+
+    private:
+        struct node;
+        typedef std::shared_ptr<const node> node_ptr;
+
+        struct node {
+            node_ptr _left;         // 左子树，叶子结点为空
+            node_ptr _right;        // 右子树，叶子结点为空
+            myString _text;         // 叶子结点的数据
+            size_t _length;         // 子树中的字符个数
+            int _height;            // 子树高度，叶子为0
+
+            explicit node(const char *str, size_t n);
+
+            node(node_ptr left, node_ptr right);
+
+            [[nodiscard]] bool is_leaf() const { return !_left; }
+        };
+
+        explicit myRope(node_ptr root);
+
+        static int height(const node_ptr &t);
+
+        static node_ptr build(const char *str, size_t n);
+
+        static node_ptr make(const node_ptr &left, const node_ptr &right);
+
+        static node_ptr balance(const node_ptr &left, const node_ptr &right);
+
+        static node_ptr join(const node_ptr &left, const node_ptr &right);
+
+        static void split(node_ptr t, size_t pos, node_ptr &left, node_ptr &right);
+
+        template<class Function>
+        static void visit(const node *t, Function &f);
+
+        node_ptr _root;     // 根结点，空字符串为空指针
+    };
+
+    template<class Function>
+    void myRope::visit(const node *t, Function &f) {
+        // 左子树递归、右子树循环，递归深度不超过树高
+        while (t) {
+            if (t->is_leaf()) {
+                f(t->_text.c_str(), t->_text.size());
+                return;
+            }
+            visit(t->_left.get(), f);
+            t = t->_right.get();
+        }
+    }
+
+    template<class Function>
+    void myRope::for_each_chunk(Function f) const {
+        visit(_root.get(), f);
+    }
+
+    // 重载输出运算符，每个叶子一次写出
+    std::ostream &operator<<(std::ostream &out, const myRope &rope);
+}
+
+#endif //STRING_MYROPE_H
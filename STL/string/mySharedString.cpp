@@ -0,0 +1,220 @@
+#include <new>
+#include "mySharedString.h"
+
+namespace cocoon {
+    // 分配一块能放下capacity个字符和'\0'的缓冲区，引用计数为1
+    mySharedString::rep *mySharedString::allocate(size_t capacity) {
+        void *memory = ::operator new(sizeof(rep) + capacity);
+        rep *r = static_cast<rep *>(memory);
+        new(&r->_refs) std::atomic<size_t>(1);
+        r->_size = 0;
+        r->_capacity = capacity;
+        r->_shareable = true;
+        r->_data[0] = '\0';
+        return r;
+    }
+
+    // 放弃一个引用，最后一个引用负责释放
+    void mySharedString::release(rep *r) {
+        // acq_rel保证其他线程对缓冲区的读取都发生在释放之前
+        if (r && r->_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            r->_refs.~atomic();
+            ::operator delete(r);
+        }
+    }
+
+    void mySharedString::detach(size_t capacity) {
+        if (_rep && _rep->_refs.load(std::memory_order_acquire) == 1 && _rep->_capacity >= capacity) {
+            return;
+        }
+        size_t size = this->size();
+        if (_rep && capacity < _rep->_capacity) {
+            capacity = _rep->_capacity;
+        }
+        rep *fresh = allocate(capacity);
+        if (_rep) {
+            memcpy(fresh->_data, _rep->_data, size + 1);
+        }
+        fresh->_size = size;
+        release(_rep);
+        _rep = fresh;
+    }
+
+    // 构造函数（创建空字符串）
+    mySharedString::mySharedString() : _rep(nullptr) {}
+
+    // 构造函数（使用C风格字符串构造）
+    mySharedString::mySharedString(const char *str) : mySharedString(str, strlen(str)) {}
+
+    // 构造函数（使用字符序列的前n个字符构造）
+    mySharedString::mySharedString(const char *str, size_t n) : _rep(nullptr) {
+        if (n > 0) {
+            _rep = allocate(n);
+            memcpy(_rep->_data, str, n);
+            _rep->_data[n] = '\0';
+            _rep->_size = n;
+        }
+    }
+
+    // 构造函数（拷贝myString的数据）
+    mySharedString::mySharedString(const myString &str) : mySharedString(str.c_str(), str.size()) {}
+
+    // 拷贝构造函数：共享缓冲区；源对象交出过可写引用时深拷贝
+    mySharedString::mySharedString(const mySharedString &str) : _rep(str._rep) {
+        if (_rep && !_rep->_shareable) {
+            _rep = nullptr;
+            mySharedString copy(str.c_str(), str.size());
+            swap(copy);
+        } else if (_rep) {
+            // 拷贝源对象本身持有一个引用，这里不需要同步
+            _rep->_refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    mySharedString::mySharedString(mySharedString &&str) noexcept: _rep(str._rep) {
+        str._rep = nullptr;
+    }
+
+    // 析构函数
+    mySharedString::~mySharedString() {
+        release(_rep);
+        _rep = nullptr;
+    }
+
+    mySharedString &mySharedString::operator=(const mySharedString &str) {
+        if (_rep != str._rep) {
+            mySharedString temp(str);
+            swap(temp);
+        }
+        return *this;
+    }
+
+    mySharedString &mySharedString::operator=(mySharedString &&str) noexcept {
+        swap(str);
+        return *this;
+    }
+
+    // 交换对象函数
+    void mySharedString::swap(mySharedString &str) {
+        std::swap(_rep, str._rep);
+    }
+
+    // 返回C风格字符串
+    const char *mySharedString::c_str() const {
+        return _rep ? _rep->_data : "";
+    }
+
+    // 返回字符串长度
+    size_t mySharedString::size() const {
+        return _rep ? _rep->_size : 0;
+    }
+
+    // 判空
+    bool mySharedString::empty() const {
+        return size() == 0;
+    }
+
+    size_t mySharedString::use_count() const {
+        return _rep ? _rep->_refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    const char &mySharedString::operator[](size_t pos) const {
+        assert(pos < size());
+        return _rep->_data[pos];
+    }
+
+    char &mySharedString::operator[](size_t pos) {
+        assert(pos < size());
+        detach(_rep->_capacity);
+        _rep->_shareable = false;
+        return _rep->_data[pos];
+    }
+
+    mySharedString::const_iterator mySharedString::begin() const {
+        return c_str();
+    }
+
+    mySharedString::const_iterator mySharedString::end() const {
+        return c_str() + size();
+    }
+
+    // 尾部插入字符
+    void mySharedString::push_back(char ch) {
+        append(&ch, 1);
+    }
+
+    // 尾部插入字符序列的前n个字符
+    void mySharedString::append(const char *str, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        size_t size = this->size();
+        size_t capacity = _rep ? _rep->_capacity : 0;
+        if (size + n > capacity) {
+            // 按两倍扩容
+            capacity = size + n > capacity * 2 ? size + n : capacity * 2;
+        }
+        // str可能指向本对象的缓冲区，detach前先记下偏移
+        const char *old = _rep ? _rep->_data : nullptr;
+        bool inside = old && str >= old && str < old + size;
+        size_t offset = inside ? str - old : 0;
+        detach(capacity);
+        if (inside) {
+            str = _rep->_data + offset;
+        }
+        memcpy(_rep->_data + size, str, n);
+        _rep->_size = size + n;
+        _rep->_data[size + n] = '\0';
+    }
+
+    // 尾部插入字符串
+    void mySharedString::append(const char *str) {
+        append(str, strlen(str));
+    }
+
+    // +=运算符重载
+    mySharedString &mySharedString::operator+=(const char *str) {
+        append(str);
+        return *this;
+    }
+
+    mySharedString &mySharedString::operator+=(char ch) {
+        push_back(ch);
+        return *this;
+    }
+
+    // 清空字符串
+    void mySharedString::clear() {
+        release(_rep);
+        _rep = nullptr;
+    }
+
+    // 查找
+    size_t mySharedString::find(char ch, size_t pos) const {
+        return view().find(ch, pos);
+    }
+
+    size_t mySharedString::find(myString_view str, size_t pos) const {
+        return view().find(str, pos);
+    }
+
+    // 转换为视图，不拷贝数据
+    myString_view mySharedString::view() const {
+        return {c_str(), size()};
+    }
+
+    mySharedString::operator myString_view() const {
+        return view();
+    }
+
+    // 拷贝出一个独立的myString
+    myString mySharedString::to_myString() const {
+        return {c_str(), size()};
+    }
+
+    // 重载输出运算符，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, const mySharedString &str) {
+        out.write(str.c_str(), static_cast<std::streamsize>(str.size()));
+        return out;
+    }
+}
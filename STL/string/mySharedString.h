@@ -0,0 +1,127 @@
+// Reference-counted copy-on-write string.
+
+#ifndef STRING_MYSHAREDSTRING_H
+#define STRING_MYSHAREDSTRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include "myString.h"
+#include "myString_view.h"
+
+namespace cocoon {
+    // 写时拷贝字符串：拷贝只增加引用计数，O(1)；修改时若缓冲区被共享，先拷贝出独占的一份再改。
+    // 引用计数是原子的，所以同一缓冲区可以被多个线程的mySharedString对象只读共享；
+    // 但同一个mySharedString对象不能被多个线程同时修改。
+    // 可写的operator[]交出引用后缓冲区不再共享，之后的拷贝都会深拷贝，直到clear或重新赋值。
+    class mySharedString {
+    private:
+        // 缓冲区：引用计数、长度、容量和数据放在同一块内存里
+        struct rep {
+            std::atomic<size_t> _refs;
+            size_t _size;
+            size_t _capacity;
+            bool _shareable;    // 交出过可写引用后为false，拷贝时不再共享
+            char _data[1];
+        };
+
+        rep *_rep;          // 空字符串为空指针
+
+        static rep *allocate(size_t capacity);
+
+        static void release(rep *r);
+
+        // 保证缓冲区为本对象独占并且至少能放下capacity个字符
+        void detach(size_t capacity);
+
+    public:
+        const static size_t npos = -1;
+
+        typedef const char *const_iterator;
+
+        // 构造函数（创建空字符串）
+        mySharedString();
+
+        // 构造函数（使用C风格字符串构造）
+        explicit mySharedString(const char *str);
+
+        // 构造函数（使用字符序列的前n个字符构造）
+        mySharedString(const char *str, size_t n);
+
+        // 构造函数（拷贝myString的数据）
+        explicit mySharedString(const myString &str);
+
+        // 拷贝构造函数：共享缓冲区
+        mySharedString(const mySharedString &str);
+
+        mySharedString(mySharedString &&str) noexcept;
+
+        // 析构函数
+        ~mySharedString();
+
+        mySharedString &operator=(const mySharedString &str);
+
+        mySharedString &operator=(mySharedString &&str) noexcept;
+
+        // 交换对象函数
+        void swap(mySharedString &str);
+
+        // 返回C风格字符串
+        [[nodiscard]] const char *c_str() const;
+
+        // 返回字符串长度
+        [[nodiscard]] size_t size() const;
+
+        // 判空
+        [[nodiscard]] bool empty() const;
+
+        // 共享同一缓冲区的对象个数，空字符串为0
+        [[nodiscard]] size_t use_count() const;
+
+        // 只读访问不会拷贝
+        const char &operator[](size_t pos) const;
+
+        // 可写访问：缓冲区被共享时先拷贝，并把缓冲区标记为不可共享，
+        // 所以之后的拷贝不会看到通过返回的引用写入的字符
+        char &operator[](size_t pos);
+
+        [[nodiscard]] const_iterator begin() const;
+
+        [[nodiscard]] const_iterator end() const;
+
+        // 尾部插入字符
+        void push_back(char ch);
+
+        // 尾部插入字符序列的前n个字符
+        void append(const char *str, size_t n);
+
+        // 尾部插入字符串
+        void append(const char *str);
+
+        // +=运算符重载
+        mySharedString &operator+=(const char *str);
+
+        mySharedString &operator+=(char ch);
+
+        // 清空字符串，只放弃对缓冲区的引用
+        void clear();
+
+        // 查找
+        [[nodiscard]] size_t find(char ch, size_t pos = 0) const;
+
+        [[nodiscard]] size_t find(myString_view str, size_t pos = 0) const;
+
+        // 转换为视图，不拷贝数据
+        [[nodiscard]] myString_view view() const;
+
+        operator myString_view() const;
+
+        // 拷贝出一个独立的myString
+        [[nodiscard]] myString to_myString() const;
+    };
+
+    // 重载输出运算符，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, const mySharedString &str);
+}
+
+#endif //STRING_MYSHAREDSTRING_H
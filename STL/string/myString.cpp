@@ -1,21 +1,59 @@
 #include "myString.h"
+#include "myNumeric.h"
+#include "myUtf8.h"
 
 namespace cocoon {
+    char *myString::allocate(size_t capacity) {
+        return static_cast<char *>(_resource->allocate(capacity + 1, 1));
+    }
+
+    void myString::deallocate(char *str, size_t capacity) {
+        _resource->deallocate(str, capacity + 1, 1);
+    }
+
     // 构造函数（使用C风格字符串构造myString对象）
     myString::myString(const char *str) {
         _size = strlen(str);
         _capacity = _size;
-        _str = new char[_capacity + 1];
+        _str = allocate(_capacity);
         strcpy(_str, str);
     }
 
+    // 构造函数（使用字符序列的前n个字符构造myString对象）
+    myString::myString(const char *str, size_t n) : myString(str, n, Somn::default_resource()) {}
+
+    // 构造函数（创建空字符串，缓冲区从resource分配）
+    myString::myString(Somn::memory_resource *resource) : _resource(resource) {
+        _size = 0;
+        _capacity = 0;
+        _str = allocate(0);
+        _str[0] = '\0';
+    }
+
+    // 构造函数（使用字符序列的前n个字符构造，缓冲区从resource分配）
+    myString::myString(const char *str, size_t n, Somn::memory_resource *resource) : _resource(resource) {
+        _size = n;
+        _capacity = _size;
+        _str = allocate(_capacity);
+        memcpy(_str, str, n);
+        _str[_size] = '\0';
+    }
+
+    // 构造函数（创建空字符串，一次分配好能放下capacity个字符的缓冲区）
+    myString::myString(size_t capacity, Somn::memory_resource *resource) : _resource(resource) {
+        _size = 0;
+        _capacity = capacity;
+        _str = allocate(_capacity);
+        _str[0] = '\0';
+    }
+
     // 返回C风格字符串
-    const char *myString::c_str() {
+    const char *myString::c_str() const {
         return _str;
     }
 
     // 返回字符串长度
-    size_t myString::size() {
+    size_t myString::size() const {
         return _size;
     }
 
@@ -68,11 +106,15 @@ namespace cocoon {
 
     // 空间扩容
     void myString::reserve(size_t n) {
+        // 只扩容不缩容
+        if (n <= _capacity) {
+            return;
+        }
         // 开辟新空间
-        char *temp = new char[n + 1];
-        // 拷贝数据
-        strcpy(temp, _str);
-        delete[] _str;
+        char *temp = allocate(n);
+        // 拷贝数据（按长度拷贝，数据中可以含有'\0'）
+        memcpy(temp, _str, _size + 1);
+        deallocate(_str, _capacity);
         _str = temp;
         _capacity = n;
     }
@@ -93,12 +135,44 @@ namespace cocoon {
 
     // 尾部插入字符串
     void myString::append(const char *str) {
-        size_t len = strlen(str);
-        if (_size + len > _capacity) {
-            reserve(_size + len);
+        append(str, strlen(str));
+    }
+
+    // 尾部插入字符序列的前n个字符
+    void myString::append(const char *str, size_t n) {
+        if (_size + n > _capacity) {
+            // 按两倍扩容，避免多次追加时反复拷贝
+            reserve(_size + n > _capacity * 2 ? _size + n : _capacity * 2);
         }
-        strcpy(_str + _size, str);
-        _size += len;
+        memcpy(_str + _size, str, n);
+        _size += n;
+        _str[_size] = '\0';
+    }
+
+    // 尾部插入整数
+    void myString::append_int(long long val) {
+        if (_size + max_int_chars > _capacity) {
+            reserve(_size + max_int_chars > _capacity * 2 ? _size + max_int_chars : _capacity * 2);
+        }
+        _size += format_int(_str + _size, val);
+        _str[_size] = '\0';
+    }
+
+    void myString::append_uint(unsigned long long val) {
+        if (_size + max_int_chars > _capacity) {
+            reserve(_size + max_int_chars > _capacity * 2 ? _size + max_int_chars : _capacity * 2);
+        }
+        _size += format_uint(_str + _size, val);
+        _str[_size] = '\0';
+    }
+
+    // 尾部插入浮点数
+    void myString::append_double(double val) {
+        if (_size + max_double_chars > _capacity) {
+            reserve(_size + max_double_chars > _capacity * 2 ? _size + max_double_chars : _capacity * 2);
+        }
+        _size += format_double(_str + _size, val);
+        _str[_size] = '\0';
     }
 
     // +=运算符重载
@@ -117,27 +191,32 @@ namespace cocoon {
     myString::myString() {
         _size = 0;
         _capacity = 0;
-        _str = new char[1];
+        _str = allocate(0);
         _str[0] = '\0'; // 空字符串
     }
 
     // 析构函数
     myString::~myString() {
-        delete[] _str;
+        deallocate(_str, _capacity);
         _str = nullptr;
         _size = 0;
     }
 
     // 返回字符串容量
-    size_t myString::capacity() {
+    size_t myString::capacity() const {
         return _capacity;
     }
 
+    // 返回分配缓冲区所用的资源
+    Somn::memory_resource *myString::resource() const {
+        return _resource;
+    }
+
     // 拷贝构造函数
     myString::myString(const myString &str) {
         _size = str._size;
         _capacity = str._capacity;
-        _str = new char[_capacity + 1];
+        _str = allocate(_capacity);
         strcpy(_str, str._str);
     }
 
@@ -145,12 +224,12 @@ namespace cocoon {
     myString &myString::operator=(const myString &str) {
         if (this != &str) { // 检查自赋值
             // 释放当前对象的资源
-            delete[] _str;
+            deallocate(_str, _capacity);
 
             // 复制新字符串的内容
             _size = str._size;
             _capacity = _size;
-            _str = new char[_capacity + 1];
+            _str = allocate(_capacity);
             strcpy(_str, str._str);
         }
         return *this;
@@ -162,7 +241,7 @@ namespace cocoon {
     }
 
     // 判空
-    bool myString::empty() {
+    bool myString::empty() const {
         return _size == 0;
     }
 
@@ -188,12 +267,12 @@ namespace cocoon {
     // 缩容
     void myString::shrink_to_fit() {
         if (_size != _capacity) {
-            char *temp = new char[_size + 1];
+            char *temp = allocate(_size);
             for (size_t index = 0; index < _size; index++) {
                 temp[index] = _str[index];
             }
             temp[_size] = '\0'; // 添加null终止符
-            delete[] _str;
+            deallocate(_str, _capacity);
             _str = temp;
             _capacity = _size;
         }
@@ -283,13 +362,49 @@ namespace cocoon {
         std::swap(_str, str._str);
         std::swap(_size, str._size);
         std::swap(_capacity, str._capacity);
+        std::swap(_resource, str._resource);
     }
 
-    // 重载输出运算符以便于输出字符串
-    std::ostream &operator<<(std::ostream &out, cocoon::myString &str) {
-        for (size_t index = 0; index < str.size(); index++) {
-            out << str[index];
-        }
+    size_t myString::find(myString_view str, size_t pos) const {
+        return view().find(str, pos);
+    }
+
+    // 转换为视图，不拷贝数据
+    myString_view myString::view() const {
+        return {_str, _size};
+    }
+
+    myString::operator myString_view() const {
+        return view();
+    }
+
+    // 取子串，返回视图
+    myString_view myString::substr(size_t pos, size_t len) const {
+        return view().substr(pos, len);
+    }
+
+    // 是否为合法的UTF-8
+    bool myString::valid_utf8() const {
+        return utf8_valid(view());
+    }
+
+    // UTF-8码点个数
+    size_t myString::utf8_size() const {
+        return utf8_length(view());
+    }
+
+    // 原地转换ASCII字母的大小写
+    void myString::to_lower() {
+        ascii_to_lower(_str, _size);
+    }
+
+    void myString::to_upper() {
+        ascii_to_upper(_str, _size);
+    }
+
+    // 重载输出运算符以便于输出字符串，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, const cocoon::myString &str) {
+        out.write(str.c_str(), static_cast<std::streamsize>(str.size()));
         return out;
     }
 }
\ No newline at end of file
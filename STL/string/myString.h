@@ -8,6 +8,8 @@
 #include <cstring>
 #include <iterator>
 #include <iostream>
+#include "myString_view.h"
+#include "../memory/arena.h"
 
 namespace cocoon {
     class myString {
@@ -15,6 +17,12 @@ namespace cocoon {
         char *_str;         // 存储字符串数据的字符数组
         size_t _size;       // 有效字符个数
         size_t _capacity;   // 存储容量
+        Somn::memory_resource *_resource = Somn::default_resource();   // 分配缓冲区所用的资源
+
+        // 从_resource分配能放下capacity个字符和'\0'的缓冲区
+        char *allocate(size_t capacity);
+
+        void deallocate(char *str, size_t capacity);
 
     public:
         const static size_t npos = -1;
@@ -28,6 +36,18 @@ namespace cocoon {
         // 构造函数（使用C风格字符串构造myString对象）
         explicit myString(const char *str);
 
+        // 构造函数（使用字符序列的前n个字符构造myString对象）
+        myString(const char *str, size_t n);
+
+        // 构造函数（创建空字符串，缓冲区从resource分配，例如arena）
+        explicit myString(Somn::memory_resource *resource);
+
+        // 构造函数（使用字符序列的前n个字符构造，缓冲区从resource分配）
+        myString(const char *str, size_t n, Somn::memory_resource *resource);
+
+        // 构造函数（创建空字符串，一次分配好能放下capacity个字符的缓冲区）
+        myString(size_t capacity, Somn::memory_resource *resource);
+
         // 构造函数（创建空字符串）
         myString();
 
@@ -53,13 +73,16 @@ namespace cocoon {
         void swap(myString& str);
 
         // 返回C风格字符串
-        [[nodiscard]] const char *c_str();
+        [[nodiscard]] const char *c_str() const;
 
         // 返回字符串长度
-        size_t size();
+        [[nodiscard]] size_t size() const;
 
         // 返回字符串容量
-        size_t capacity();
+        [[nodiscard]] size_t capacity() const;
+
+        // 返回分配缓冲区所用的资源
+        [[nodiscard]] Somn::memory_resource *resource() const;
 
         // 运算符重载使其可使用[]访问字符串数据
         char &operator[](size_t pos);
@@ -95,6 +118,17 @@ namespace cocoon {
         // 尾部插入字符串
         void append(const char *str);
 
+        // 尾部插入字符序列的前n个字符
+        void append(const char *str, size_t n);
+
+        // 尾部插入整数，直接写入本对象的缓冲区，不经过临时字符串
+        void append_int(long long val);
+
+        void append_uint(unsigned long long val);
+
+        // 尾部插入浮点数，使用能精确还原的最短表示
+        void append_double(double val);
+
         // +=运算符重载
         myString &operator+=(const char *str);
 
@@ -107,7 +141,7 @@ namespace cocoon {
         void clear();
 
         // 判空
-        bool empty();
+        [[nodiscard]] bool empty() const;
 
         // 重新设置_size并填充字符c
         void resize(size_t n, char ch = '\0');
@@ -128,10 +162,38 @@ namespace cocoon {
         size_t find(char ch, size_t pos = 0);
 
         size_t find(const char *str, size_t pos = 0);
+
+        [[nodiscard]] size_t find(myString_view str, size_t pos = 0) const;
+
+        // 转换为视图，不拷贝数据
+        [[nodiscard]] myString_view view() const;
+
+        operator myString_view() const;
+
+        // 取子串，返回引用本对象数据的视图，修改本对象后视图失效
+        [[nodiscard]] myString_view substr(size_t pos, size_t len = npos) const;
+
+        // 是否为合法的UTF-8
+        [[nodiscard]] bool valid_utf8() const;
+
+        // UTF-8码点个数，只对合法的UTF-8有意义
+        [[nodiscard]] size_t utf8_size() const;
+
+        // 原地转换ASCII字母的大小写，非ASCII字节保持不变
+        void to_lower();
+
+        void to_upper();
     };
 
     // 重载输出运算符以便于输出字符串
-    std::ostream &operator<<(std::ostream &out, myString &str);
+    std::ostream &operator<<(std::ostream &out, const myString &str);
+}
+
+namespace std {
+    // 哈希容器的钩子：与myString_view的哈希一致，可以直接用视图或C风格字符串查找
+    template<>
+    struct hash<cocoon::myString> : hash<cocoon::myString_view> {
+    };
 }
 
 #endif //STRING_MYSTRING_H
@@ -0,0 +1,178 @@
+#include <cerrno>
+#include <climits>
+#include "myStringBuilder.h"
+#include "myNumeric.h"
+
+namespace cocoon {
+    // 构造函数
+    myStringBuilder::myStringBuilder(size_t chunk_size)
+            : _chunk_size(chunk_size ? chunk_size : 1), _last_used(0), _size(0) {
+        next_chunk();
+    }
+
+    // 析构函数
+    myStringBuilder::~myStringBuilder() {
+        for (size_t index = 0; index < _chunks.size(); index++) {
+            delete[] _chunks[index];
+        }
+    }
+
+    // 申请新块并设为当前块
+    void myStringBuilder::next_chunk() {
+        _current = new char[_chunk_size];
+        _chunks.push_back(_current);
+        _last_used = 0;
+    }
+
+    // 尾部插入字符
+    void myStringBuilder::push_back(char ch) {
+        if (_last_used == _chunk_size) {
+            next_chunk();
+        }
+        _current[_last_used++] = ch;
+        _size++;
+    }
+
+    // 尾部插入字符串，当前块放不下的部分写到新块
+    void myStringBuilder::append(myString_view str) {
+        const char *data = str.data();
+        size_t len = str.size();
+        _size += len;
+        while (len > 0) {
+            if (_last_used == _chunk_size) {
+                next_chunk();
+            }
+            size_t room = _chunk_size - _last_used;
+            size_t count = len < room ? len : room;
+            memcpy(_current + _last_used, data, count);
+            _last_used += count;
+            data += count;
+            len -= count;
+        }
+    }
+
+    // 尾部插入整数：当前块放得下时直接写进块里，否则先写到栈上再追加
+    void myStringBuilder::append_int(long long val) {
+        if (_chunk_size - _last_used >= max_int_chars) {
+            size_t len = format_int(_current + _last_used, val);
+            _last_used += len;
+            _size += len;
+            return;
+        }
+        char buffer[max_int_chars];
+        append(myString_view(buffer, format_int(buffer, val)));
+    }
+
+    void myStringBuilder::append_uint(unsigned long long val) {
+        if (_chunk_size - _last_used >= max_int_chars) {
+            size_t len = format_uint(_current + _last_used, val);
+            _last_used += len;
+            _size += len;
+            return;
+        }
+        char buffer[max_int_chars];
+        append(myString_view(buffer, format_uint(buffer, val)));
+    }
+
+    // 尾部插入浮点数
+    void myStringBuilder::append_double(double val) {
+        if (_chunk_size - _last_used >= max_double_chars) {
+            size_t len = format_double(_current + _last_used, val);
+            _last_used += len;
+            _size += len;
+            return;
+        }
+        char buffer[max_double_chars];
+        append(myString_view(buffer, format_double(buffer, val)));
+    }
+
+    // +=运算符重载
+    myStringBuilder &myStringBuilder::operator+=(myString_view str) {
+        append(str);
+        return *this;
+    }
+
+    myStringBuilder &myStringBuilder::operator+=(char ch) {
+        push_back(ch);
+        return *this;
+    }
+
+    size_t myStringBuilder::size() const {
+        return _size;
+    }
+
+    bool myStringBuilder::empty() const {
+        return _size == 0;
+    }
+
+    size_t myStringBuilder::chunk_count() const {
+        return _chunks.size();
+    }
+
+    // 清空内容，保留第一块
+    void myStringBuilder::clear() {
+        while (_chunks.size() > 1) {
+            delete[] _chunks[_chunks.size() - 1];
+            _chunks.pop_back();
+        }
+        _current = _chunks[0];
+        _last_used = 0;
+        _size = 0;
+    }
+
+    // 拼接成一个myString：按总长度一次分配，之后的追加不会再扩容
+    myString myStringBuilder::finish() const {
+        myString result(_size, Somn::default_resource());
+        for_each_chunk([&result](const char *data, size_t len) {
+            result.append(data, len);
+        });
+        return result;
+    }
+
+#ifdef MYSTRINGBUILDER_HAS_WRITEV
+    // 生成指向各块数据的iovec数组
+    Somn::myVector<iovec> myStringBuilder::to_iovec() const {
+        Somn::myVector<iovec> result;
+        result.reserve(_chunks.size());
+        for_each_chunk([&result](const char *data, size_t len) {
+            iovec vec;
+            vec.iov_base = const_cast<char *>(data);
+            vec.iov_len = len;
+            result.push_back(vec);
+        });
+        return result;
+    }
+
+    // 用writev把全部数据写到fd
+    ssize_t myStringBuilder::write_to(int fd) const {
+        Somn::myVector<iovec> vecs = to_iovec();
+        size_t first = 0;
+        size_t written = 0;
+        while (first < vecs.size()) {
+            size_t count = vecs.size() - first;
+            if (count > IOV_MAX) {
+                count = IOV_MAX;
+            }
+            ssize_t result = ::writev(fd, vecs.begin() + first, static_cast<int>(count));
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            written += result;
+            // 跳过已经完整写出的块，部分写出的块调整起点
+            size_t done = result;
+            while (first < vecs.size() && done >= vecs[first].iov_len) {
+                done -= vecs[first].iov_len;
+                first++;
+            }
+            if (done > 0) {
+                vecs[first].iov_base = static_cast<char *>(vecs[first].iov_base) + done;
+                vecs[first].iov_len -= done;
+            }
+        }
+        return static_cast<ssize_t>(written);
+    }
+#endif
+}
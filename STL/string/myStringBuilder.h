@@ -0,0 +1,102 @@
+// Chunked string builder with scatter-gather output.
+
+#ifndef STRING_MYSTRINGBUILDER_H
+#define STRING_MYSTRINGBUILDER_H
+
+#include <cstddef>
+#include "myString.h"
+#include "myString_view.h"
+#include "../vector/myVector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/uio.h>
+#define MYSTRINGBUILDER_HAS_WRITEV 1
+#endif
+
+namespace cocoon {
+    // 字符串构建器：数据追加到一串固定大小的块中，块满了就申请新块，已写入的数据从不搬动。
+    // 结束时可以用finish()一次性拼成myString，也可以把各块直接交给writev输出，不再拷贝。
+    class myStringBuilder {
+    public:
+        // 构造函数，chunk_size为每块的字节数
+        explicit myStringBuilder(size_t chunk_size = 4096);
+
+        myStringBuilder(const myStringBuilder &) = delete;
+
+        myStringBuilder &operator=(const myStringBuilder &) = delete;
+
+        // 析构函数
+        ~myStringBuilder();
+
+        // 尾部插入字符
+        void push_back(char ch);
+
+        // 尾部插入字符串
+        void append(myString_view str);
+
+        // 尾部插入整数，不经过iostream
+        void append_int(long long val);
+
+        void append_uint(unsigned long long val);
+
+        // 尾部插入浮点数，使用能精确还原的最短表示
+        void append_double(double val);
+
+        // +=运算符重载
+        myStringBuilder &operator+=(myString_view str);
+
+        myStringBuilder &operator+=(char ch);
+
+        // 已写入的字节数
+        [[nodiscard]] size_t size() const;
+
+        // 判空
+        [[nodiscard]] bool empty() const;
+
+        // 已使用的块数
+        [[nodiscard]] size_t chunk_count() const;
+
+        // 清空内容，保留第一块以便复用
+        void clear();
+
+        // 拼接成一个myString：只分配一次目标内存，每块只拷贝一次
+        [[nodiscard]] myString finish() const;
+
+        // 按顺序把每块的数据交给f(const char *data, size_t len)
+        template<class Function>
+        void for_each_chunk(Function f) const;
+
+#ifdef MYSTRINGBUILDER_HAS_WRITEV
+        // 生成指向各块数据的iovec数组，可直接传给writev
+        [[nodiscard]] Somn::myVector<iovec> to_iovec() const;
+
+        // 用writev把全部数据写到fd，处理部分写入和IOV_MAX限制
+        // 成功返回写入的字节数，失败返回-1并保留errno
+        ssize_t write_to(int fd) const;
+#endif
+
+    private:
+        // 申请新块并设为当前块
+        void next_chunk();
+
+        Somn::myVector<char *> _chunks;     // 所有块，最后一块是当前块
+        char *_current;                     // 当前块
+        size_t _chunk_size;                 // 每块的字节数
+        size_t _last_used;                  // 最后一块已使用的字节数
+        size_t _size;                       // 总字节数
+    };
+
+    template<class Function>
+    void myStringBuilder::for_each_chunk(Function f) const {
+        size_t count = _chunks.size();
+        for (size_t index = 0; index < count; index++) {
+            size_t len = index + 1 == count ? _last_used : _chunk_size;
+            if (len > 0) {
+                f(_chunks[index], len);
+            }
+        }
+    }
+}
+
+#endif //STRING_MYSTRINGBUILDER_H
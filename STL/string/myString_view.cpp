@@ -0,0 +1,141 @@
+#include <cstdint>
+#include "myString_view.h"
+#include "myHash.h"
+
+namespace cocoon {
+    // 构造函数（空视图）
+    myString_view::myString_view() : _str(""), _size(0) {}
+
+    // 构造函数（引用C风格字符串）
+    myString_view::myString_view(const char *str) : _str(str), _size(strlen(str)) {}
+
+    // 判空
+    bool myString_view::empty() const {
+        return _size == 0;
+    }
+
+    const char &myString_view::operator[](size_t pos) const {
+        assert(pos < _size);
+        return _str[pos];
+    }
+
+    myString_view::const_iterator myString_view::begin() const {
+        return _str;
+    }
+
+    myString_view::const_iterator myString_view::end() const {
+        return _str + _size;
+    }
+
+    // 去掉前n个字符
+    void myString_view::remove_prefix(size_t n) {
+        assert(n <= _size);
+        _str += n;
+        _size -= n;
+    }
+
+    // 去掉后n个字符
+    void myString_view::remove_suffix(size_t n) {
+        assert(n <= _size);
+        _size -= n;
+    }
+
+    // 取子串
+    myString_view myString_view::substr(size_t pos, size_t len) const {
+        assert(pos <= _size);
+        if (len > _size - pos) {
+            len = _size - pos;
+        }
+        return {_str + pos, len};
+    }
+
+    // 查找字符，memchr按字长扫描
+    size_t myString_view::find(char ch, size_t pos) const {
+        if (pos >= _size) {
+            return npos;
+        }
+        const void *ptr = memchr(_str + pos, ch, _size - pos);
+        return ptr ? static_cast<const char *>(ptr) - _str : npos;
+    }
+
+    // 查找子串：先用memchr定位首字符，再比较剩余部分
+    size_t myString_view::find(myString_view str, size_t pos) const {
+        if (str._size == 0) {
+            return pos <= _size ? pos : npos;
+        }
+        while (pos + str._size <= _size) {
+            pos = find(str._str[0], pos);
+            if (pos == npos || pos + str._size > _size) {
+                return npos;
+            }
+            if (memcmp(_str + pos + 1, str._str + 1, str._size - 1) == 0) {
+                return pos;
+            }
+            pos++;
+        }
+        return npos;
+    }
+
+    // 反向查找字符
+    size_t myString_view::rfind(char ch, size_t pos) const {
+        if (_size == 0) {
+            return npos;
+        }
+        size_t index = pos < _size ? pos + 1 : _size;
+        while (index > 0) {
+            if (_str[--index] == ch) {
+                return index;
+            }
+        }
+        return npos;
+    }
+
+    // 按字典序比较
+    int myString_view::compare(myString_view str) const {
+        size_t len = _size < str._size ? _size : str._size;
+        int result = len ? memcmp(_str, str._str, len) : 0;
+        if (result != 0) {
+            return result;
+        }
+        return _size < str._size ? -1 : (_size > str._size ? 1 : 0);
+    }
+
+    bool myString_view::starts_with(myString_view str) const {
+        return _size >= str._size && memcmp(_str, str._str, str._size) == 0;
+    }
+
+    bool myString_view::ends_with(myString_view str) const {
+        return _size >= str._size && memcmp(_str + _size - str._size, str._str, str._size) == 0;
+    }
+
+    // 按分隔符切分，返回所有段
+    Somn::myVector<myString_view> myString_view::split(char delim) const {
+        Somn::myVector<myString_view> result;
+        split(delim, [&result](myString_view part) {
+            result.push_back(part);
+        });
+        return result;
+    }
+
+    bool operator==(myString_view left, myString_view right) {
+        return left.size() == right.size() && memcmp(left.data(), right.data(), left.size()) == 0;
+    }
+
+    bool operator!=(myString_view left, myString_view right) {
+        return !(left == right);
+    }
+
+    bool operator<(myString_view left, myString_view right) {
+        return left.compare(right) < 0;
+    }
+
+    // 重载输出运算符，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, myString_view str) {
+        out.write(str.data(), static_cast<std::streamsize>(str.size()));
+        return out;
+    }
+}
+
+size_t std::hash<cocoon::myString_view>::operator()(cocoon::myString_view str) const {
+    return static_cast<size_t>(cocoon::hash_bytes(str));
+}
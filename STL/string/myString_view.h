@@ -0,0 +1,127 @@
+// Non-owning view over a character sequence.
+
+#ifndef STRING_MYSTRING_VIEW_H
+#define STRING_MYSTRING_VIEW_H
+
+#include <cstddef>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include "../vector/myVector.h"
+
+namespace cocoon {
+    // 字符串视图：只保存指针和长度，不拥有也不拷贝数据。
+    // 被引用的数据必须比视图活得更久，数据不要求以'\0'结尾。
+    class myString_view {
+    private:
+        const char *_str;   // 指向数据的首字符
+        size_t _size;       // 字符个数
+
+    public:
+        const static size_t npos = -1;
+
+        typedef const char *iterator;
+        typedef const char *const_iterator;
+
+        // 构造函数（空视图）
+        myString_view();
+
+        // 构造函数（引用C风格字符串）
+        myString_view(const char *str);
+
+        // 构造函数（引用字符序列的前n个字符）
+        myString_view(const char *str, size_t n);
+
+        // 返回数据指针，不保证以'\0'结尾
+        [[nodiscard]] const char *data() const;
+
+        // 返回字符串长度
+        [[nodiscard]] size_t size() const;
+
+        // 判空
+        [[nodiscard]] bool empty() const;
+
+        const char &operator[](size_t pos) const;
+
+        [[nodiscard]] const_iterator begin() const;
+
+        [[nodiscard]] const_iterator end() const;
+
+        // 去掉前n个字符 / 后n个字符
+        void remove_prefix(size_t n);
+
+        void remove_suffix(size_t n);
+
+        // 取子串，返回的仍是视图
+        [[nodiscard]] myString_view substr(size_t pos, size_t len = npos) const;
+
+        // 查找
+        [[nodiscard]] size_t find(char ch, size_t pos = 0) const;
+
+        [[nodiscard]] size_t find(myString_view str, size_t pos = 0) const;
+
+        // 反向查找
+        [[nodiscard]] size_t rfind(char ch, size_t pos = npos) const;
+
+        // 按字典序比较，小于、等于、大于分别返回负数、0、正数
+        [[nodiscard]] int compare(myString_view str) const;
+
+        [[nodiscard]] bool starts_with(myString_view str) const;
+
+        [[nodiscard]] bool ends_with(myString_view str) const;
+
+        // 按分隔符切分，依次把每一段交给f(myString_view)，相邻分隔符之间得到空段
+        template<class Function>
+        void split(char delim, Function f) const;
+
+        // 按分隔符切分，返回所有段
+        [[nodiscard]] Somn::myVector<myString_view> split(char delim) const;
+    };
+
+    // 以下三个在切分和查找的热路径上每个字段都要调用，定义在头文件中以便内联
+    inline myString_view::myString_view(const char *str, size_t n) : _str(str), _size(n) {}
+
+    inline const char *myString_view::data() const {
+        return _str;
+    }
+
+    inline size_t myString_view::size() const {
+        return _size;
+    }
+
+    template<class Function>
+    void myString_view::split(char delim, Function f) const {
+        size_t start = 0;
+        while (true) {
+            size_t pos = find(delim, start);
+            if (pos == npos) {
+                f(myString_view(_str + start, _size - start));
+                return;
+            }
+            f(myString_view(_str + start, pos - start));
+            start = pos + 1;
+        }
+    }
+
+    bool operator==(myString_view left, myString_view right);
+
+    bool operator!=(myString_view left, myString_view right);
+
+    bool operator<(myString_view left, myString_view right);
+
+    // 重载输出运算符，一次写出全部数据
+    std::ostream &operator<<(std::ostream &out, myString_view str);
+}
+
+namespace std {
+    // 按内容计算哈希值（hash_bytes，见myHash.h），相同内容的视图、myString和C风格字符串得到相同的结果
+    template<>
+    struct hash<cocoon::myString_view> {
+        typedef void is_transparent;
+
+        size_t operator()(cocoon::myString_view str) const;
+    };
+}
+
+#endif //STRING_MYSTRING_VIEW_H
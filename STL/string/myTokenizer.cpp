@@ -0,0 +1,150 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "myTokenizer.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MYTOKENIZER_HAS_SSE 1
+#endif
+
+namespace cocoon {
+    namespace {
+        // 每次计算掩码的64字节块数，掩码放在栈上
+        const size_t chunk_blocks = 512;
+
+        // 第i位为1当且仅当x的第0到i位中有奇数个1：引号之间（含开引号）的字节被置位
+        inline uint64_t prefix_xor(uint64_t x) {
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+        }
+
+#ifdef MYTOKENIZER_HAS_SSE
+        // 对blocks个64字节块，masks[2i]为分隔符或换行的位置，masks[2i+1]为引号的位置
+        // SSE2在x86-64上总是可用，每次比较16字节
+        void scan_sse2(const char *data, size_t blocks, char delim, char quote, uint64_t *masks) {
+            const __m128i delims = _mm_set1_epi8(delim);
+            const __m128i newlines = _mm_set1_epi8('\n');
+            const __m128i quotes = _mm_set1_epi8(quote);
+            for (size_t block = 0; block < blocks; block++) {
+                uint64_t structural = 0, quoted = 0;
+                for (size_t part = 0; part < 4; part++) {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + block * 64 + part * 16));
+                    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, delims), _mm_cmpeq_epi8(bytes, newlines));
+                    structural |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(hits))) << (part * 16);
+                    quoted |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quotes)))) << (part * 16);
+                }
+                masks[2 * block] = structural;
+                masks[2 * block + 1] = quoted;
+            }
+        }
+
+        // AVX2每次比较32字节，运行时检测CPU支持后才使用
+        __attribute__((target("avx2")))
+        void scan_avx2(const char *data, size_t blocks, char delim, char quote, uint64_t *masks) {
+            const __m256i delims = _mm256_set1_epi8(delim);
+            const __m256i newlines = _mm256_set1_epi8('\n');
+            const __m256i quotes = _mm256_set1_epi8(quote);
+            for (size_t block = 0; block < blocks; block++) {
+                const char *p = data + block * 64;
+                __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+                __m256i low_hits = _mm256_or_si256(_mm256_cmpeq_epi8(low, delims), _mm256_cmpeq_epi8(low, newlines));
+                __m256i high_hits = _mm256_or_si256(_mm256_cmpeq_epi8(high, delims), _mm256_cmpeq_epi8(high, newlines));
+                masks[2 * block] = static_cast<uint32_t>(_mm256_movemask_epi8(low_hits))
+                                   | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high_hits))) << 32;
+                masks[2 * block + 1] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quotes)))
+                                       | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quotes)))) << 32;
+            }
+        }
+#else
+        // 其他平台逐字节比较
+        void scan_scalar(const char *data, size_t blocks, char delim, char quote, uint64_t *masks) {
+            for (size_t block = 0; block < blocks; block++) {
+                uint64_t structural = 0, quotes = 0;
+                for (size_t i = 0; i < 64; i++) {
+                    char ch = data[block * 64 + i];
+                    structural |= static_cast<uint64_t>(ch == delim || ch == '\n') << i;
+                    quotes |= static_cast<uint64_t>(ch == quote) << i;
+                }
+                masks[2 * block] = structural;
+                masks[2 * block + 1] = quotes;
+            }
+        }
+#endif
+
+        void scan(const char *data, size_t blocks, char delim, char quote, uint64_t *masks) {
+#ifdef MYTOKENIZER_HAS_SSE
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            if (has_avx2) {
+                scan_avx2(data, blocks, delim, quote, masks);
+            } else {
+                scan_sse2(data, blocks, delim, quote, masks);
+            }
+#else
+            scan_scalar(data, blocks, delim, quote, masks);
+#endif
+        }
+    }
+
+    myTokenizer::myTokenizer(char delim, char quote)
+            : _delim(delim), _quote(quote), _in_quote(false), _records(0), _fields(16, myString_view()) {
+        assert(delim != '\0' && delim != '\n' && delim != quote);
+    }
+
+    size_t myTokenizer::records() const {
+        return _records;
+    }
+
+    size_t myTokenizer::index(const char *data, size_t n, uint32_t *out, bool &in_quote) const {
+        uint64_t masks[2 * chunk_blocks];
+        uint64_t inside_carry = in_quote ? ~0ULL : 0;
+        size_t count = 0;
+        size_t full = n / 64, total = (n + 63) / 64;
+        for (size_t block = 0; block < total;) {
+            size_t blocks = total - block < chunk_blocks ? total - block : chunk_blocks;
+            size_t whole = full - block < blocks ? full - block : blocks;
+            scan(data + block * 64, whole, _delim, _quote, masks);
+            if (whole < blocks) {
+                // 最后不足64字节的部分补'\0'，'\0'既不是分隔符也不是换行
+                char tail[64] = {};
+                memcpy(tail, data + (block + whole) * 64, n - (block + whole) * 64);
+                scan(tail, 1, _delim, _quote, masks + 2 * whole);
+            }
+            for (size_t i = 0; i < blocks; i++) {
+                uint64_t quotes = _quote ? masks[2 * i + 1] : 0;
+                uint64_t inside = prefix_xor(quotes) ^ inside_carry;
+                // 最高位决定下一块是否从引号内开始
+                inside_carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+                uint64_t structural = masks[2 * i] & ~inside;
+                uint32_t base = static_cast<uint32_t>((block + i) * 64);
+                while (structural) {
+                    out[count++] = base + __builtin_ctzll(structural);
+                    structural &= structural - 1;
+                }
+            }
+            block += blocks;
+        }
+        in_quote = inside_carry != 0;
+        return count;
+    }
+
+    void myTokenizer::unescape(myString_view field, myString &out) const {
+        size_t start = 0;
+        while (start < field.size()) {
+            size_t pos = _quote ? field.find(_quote, start) : myString_view::npos;
+            if (pos == myString_view::npos || pos + 1 >= field.size()) {
+                out.append(field.data() + start, field.size() - start);
+                return;
+            }
+            // 保留第一个引号，跳过紧跟的第二个
+            out.append(field.data() + start, pos + 1 - start);
+            start = field[pos + 1] == _quote ? pos + 2 : pos + 1;
+        }
+    }
+}
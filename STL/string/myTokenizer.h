@@ -0,0 +1,199 @@
+// Streaming CSV / line tokenizer with SIMD delimiter search.
+
+#ifndef STRING_MYTOKENIZER_H
+#define STRING_MYTOKENIZER_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include "myString.h"
+#include "myString_view.h"
+#include "../vector/myVector.h"
+
+namespace cocoon {
+    // 一条记录的字段：指向切分器内部的数组，只在回调期间有效
+    class myRecord {
+    public:
+        typedef const myString_view *iterator;
+        typedef const myString_view *const_iterator;
+
+        myRecord(const myString_view *fields, size_t size) : _fields(fields), _size(size) {}
+
+        [[nodiscard]] size_t size() const { return _size; }
+
+        [[nodiscard]] bool empty() const { return _size == 0; }
+
+        const myString_view &operator[](size_t pos) const {
+            assert(pos < _size);
+            return _fields[pos];
+        }
+
+        [[nodiscard]] const_iterator begin() const { return _fields; }
+
+        [[nodiscard]] const_iterator end() const { return _fields + _size; }
+
+    private:
+        const myString_view *_fields;
+        size_t _size;
+    };
+
+    // 流式记录切分器：按块接收输入，每得到一条完整的记录（以'\n'结束）就把它的字段交给回调。
+    // 每64字节用SIMD比较一次得到分隔符、换行和引号的位掩码，用前缀异或求出引号内的范围并屏蔽掉，
+    // 再逐个取出剩下的置位（simdjson / simdcsv的做法），所以扫描速度与字段长短无关。
+    // 字段是视图：一般指向调用者传入的块，跨块的记录先拼到内部缓冲区里，字段指向缓冲区；
+    // 视图只在回调期间有效。
+    // 引号字段去掉两端的引号，字段内转义的""保持原样，需要时用unescape还原；行尾的'\r'会被去掉。
+    class myTokenizer {
+    public:
+        // delim不能是'\0'；quote为'\0'时不识别引号，例如按空格切分日志
+        explicit myTokenizer(char delim = ',', char quote = '"');
+
+        // 喂入一块数据，对其中每条完整的记录调用f(const myRecord &fields)
+        template<class Function>
+        void feed(myString_view block, Function f);
+
+        // 输入结束：最后一条记录没有换行时在这里交出，然后回到初始状态
+        template<class Function>
+        void finish(Function f);
+
+        // 已交出的记录数
+        [[nodiscard]] size_t records() const;
+
+        // 把引号字段中转义的""还原为"，追加到out
+        void unescape(myString_view field, myString &out) const;
+
+    private:
+        // 每次建索引的最大字节数，位置用32位保存
+        const static size_t slice_size = 1 << 20;
+
+        // 求出data[0, n)中引号外的分隔符和换行的位置，写入out（至少n项），返回个数；
+        // in_quote传入开头是否在引号内，返回结尾是否在引号内
+        size_t index(const char *data, size_t n, uint32_t *out, bool &in_quote) const;
+
+        // 按positions[0, count)从start开始切分data，交出完整的记录，返回第一条不完整记录的起点
+        template<class Function>
+        size_t emit(const char *data, const uint32_t *positions, size_t count, size_t start, Function f);
+
+        template<class Function>
+        void feed_slice(const char *data, size_t n, Function f);
+
+        // 交出缓冲区中拼好的一条记录；at_end为true时即使引号没有闭合也在末尾结束记录
+        template<class Function>
+        void emit_carry(Function f, bool at_end = false);
+
+
+        char _delim;
+        char _quote;
+        bool _in_quote;                         // 已收到的输入是否停在引号内
+        size_t _records;
+        Somn::myVector<uint32_t> _index;        // 当前块中结构字符的位置
+        Somn::myVector<uint32_t> _carry_index;  // 缓冲区中结构字符的位置
+        Somn::myVector<myString_view> _fields;  // 当前记录的字段，按需加倍，反复使用
+        myString _carry;                        // 跨块记录已收到的部分
+    };
+
+    template<class Function>
+    void myTokenizer::feed(myString_view block, Function f) {
+        const char *data = block.data();
+        size_t n = block.size();
+        while (n > 0) {
+            size_t len = n < slice_size ? n : slice_size;
+            feed_slice(data, len, f);
+            data += len;
+            n -= len;
+        }
+    }
+
+    template<class Function>
+    void myTokenizer::finish(Function f) {
+        if (!_carry.empty()) {
+            _carry.push_back('\n');
+            emit_carry(f, true);
+        }
+        _in_quote = false;
+    }
+
+    template<class Function>
+    void myTokenizer::feed_slice(const char *data, size_t n, Function f) {
+        if (_index.size() < n) {
+            _index.resize(slice_size);
+        }
+        size_t count = index(data, n, _index.begin(), _in_quote);
+        size_t k = 0, start = 0;
+        if (!_carry.empty()) {
+            // 上一块留下了半条记录：找到它的换行，拼完整后交出
+            while (k < count && data[_index[k]] != '\n') {
+                k++;
+            }
+            if (k == count) {
+                _carry.append(data, n);
+                return;
+            }
+            start = _index[k] + 1;
+            _carry.append(data, start);
+            emit_carry(f);
+            k++;
+        }
+        size_t tail = emit(data, _index.begin() + k, count - k, start, f);
+        if (tail < n) {
+            _carry.append(data + tail, n - tail);
+        }
+    }
+
+    template<class Function>
+    void myTokenizer::emit_carry(Function f, bool at_end) {
+        if (_carry_index.size() < _carry.size()) {
+            _carry_index.resize(_carry.size());
+        }
+        // 记录总是从引号外开始
+        bool in_quote = false;
+        size_t count = index(_carry.c_str(), _carry.size(), _carry_index.begin(), in_quote);
+        if (at_end && in_quote) {
+            // 未闭合的引号吞掉了补上的换行
+            _carry_index[count++] = static_cast<uint32_t>(_carry.size() - 1);
+        }
+        emit(_carry.c_str(), _carry_index.begin(), count, 0, f);
+        _carry.clear();
+    }
+
+    template<class Function>
+    size_t myTokenizer::emit(const char *data, const uint32_t *positions, size_t count, size_t start, Function f) {
+        // 状态放在局部变量里：data是char指针，写入它可能改动任何成员，编译器不敢把成员留在寄存器中
+        myString_view *fields = _fields.begin();
+        size_t capacity = _fields.size(), n = 0, records = 0;
+        size_t record_start = start, field_start = start;
+        const char quote = _quote;
+        for (size_t k = 0; k < count; k++) {
+            size_t pos = positions[k];
+            const char *first = data + field_start;
+            size_t len = pos - field_start;
+            bool newline = data[pos] == '\n';
+            if (newline && len > 0 && data[pos - 1] == '\r') {
+                len--;
+            }
+            if (n == capacity) {
+                _fields.resize(capacity * 2);
+                fields = _fields.begin();
+                capacity = _fields.size();
+            }
+            // 去掉引号字段两端的引号
+            if (quote && len >= 2 && first[0] == quote && first[len - 1] == quote) {
+                fields[n++] = myString_view(first + 1, len - 2);
+            } else {
+                fields[n++] = myString_view(first, len);
+            }
+            field_start = pos + 1;
+            if (newline) {
+                f(myRecord(fields, n));
+                records++;
+                n = 0;
+                record_start = field_start;
+            }
+        }
+        // 不完整记录的字段会在拼好后重新切分
+        _records += records;
+        return record_start;
+    }
+}
+
+#endif //STRING_MYTOKENIZER_H
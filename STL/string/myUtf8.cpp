@@ -0,0 +1,328 @@
+#include <cstdint>
+#include <cstring>
+#include "myUtf8.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MYUTF8_HAS_SSE 1
+#endif
+
+namespace cocoon {
+    // 续字节：10xxxxxx
+    static inline bool is_continuation(unsigned char byte) {
+        return (byte & 0xC0) == 0x80;
+    }
+
+    // 返回从s开始的合法序列的字节数，非法或截断时返回0。
+    // 第二个字节的范围按首字节收紧，用来排除过长编码、代理项和超过U+10FFFF的码点
+    static size_t sequence_length(const unsigned char *s, size_t n) {
+        unsigned char lead = s[0];
+        if (lead < 0x80) {
+            return 1;
+        }
+        if (lead < 0xC2) {
+            // 单独的续字节，或者C0、C1开头的过长编码
+            return 0;
+        }
+        if (lead < 0xE0) {
+            return n >= 2 && is_continuation(s[1]) ? 2 : 0;
+        }
+        if (lead < 0xF0) {
+            unsigned char low = lead == 0xE0 ? 0xA0 : 0x80;
+            unsigned char high = lead == 0xED ? 0x9F : 0xBF;
+            return n >= 3 && s[1] >= low && s[1] <= high && is_continuation(s[2]) ? 3 : 0;
+        }
+        if (lead < 0xF5) {
+            unsigned char low = lead == 0xF0 ? 0x90 : 0x80;
+            unsigned char high = lead == 0xF4 ? 0x8F : 0xBF;
+            return n >= 4 && s[1] >= low && s[1] <= high && is_continuation(s[2]) && is_continuation(s[3]) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    bool utf8_valid_scalar(myString_view str) {
+        auto data = reinterpret_cast<const unsigned char *>(str.data());
+        size_t n = str.size();
+        size_t pos = 0;
+        while (pos < n) {
+            size_t len = sequence_length(data + pos, n - pos);
+            if (len == 0) {
+                return false;
+            }
+            pos += len;
+        }
+        return true;
+    }
+
+    // 一次检查8个字节的最高位
+    static const uint64_t high_bits = 0x8080808080808080ULL;
+
+    static inline uint64_t load_word(const char *data) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+#ifdef MYUTF8_HAS_SSE
+    // SIMD校验采用查表法（Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"）：
+    // 对每个字节，用前一个字节的高4位、低4位和本字节的高4位各查一张16项的表，三者按位与，
+    // 结果非零说明这一对字节构成某种错误；三、四字节序列的后续续字节再单独用饱和减法检查。
+    // 查表需要SSSE3的pshufb，运行时检测CPU支持后才使用。
+    namespace {
+        enum : uint8_t {
+            TOO_SHORT = 1 << 0,         // 首字节后面缺少续字节
+            TOO_LONG = 1 << 1,          // ASCII后面跟着续字节
+            OVERLONG_3 = 1 << 2,        // E0 80~9F
+            TOO_LARGE = 1 << 3,         // F4 90~BF，或F5及以上
+            SURROGATE = 1 << 4,         // ED A0~BF
+            OVERLONG_2 = 1 << 5,        // C0、C1
+            TOO_LARGE_1000 = 1 << 6,    // F5及以上后面跟80~8F
+            OVERLONG_4 = 1 << 6,        // F0 80~8F
+            TWO_CONTS = 1 << 7,         // 两个连续的续字节（第三、四字节的情况会被异或抵消）
+            CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS
+        };
+
+        // 前一个字节的高4位
+        alignas(16) const uint8_t byte_1_high_table[16] = {
+                TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+                TOO_SHORT | OVERLONG_2,
+                TOO_SHORT,
+                TOO_SHORT | OVERLONG_3 | SURROGATE,
+                TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+        };
+
+        // 前一个字节的低4位
+        alignas(16) const uint8_t byte_1_low_table[16] = {
+                CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+                CARRY | OVERLONG_2,
+                CARRY,
+                CARRY,
+                CARRY | TOO_LARGE,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+                CARRY | TOO_LARGE | TOO_LARGE_1000,
+                CARRY | TOO_LARGE | TOO_LARGE_1000
+        };
+
+        // 本字节的高4位
+        alignas(16) const uint8_t byte_2_high_table[16] = {
+                TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+                TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+                TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+        };
+
+        // 块的最后三个字节若是未完成序列的首字节，饱和减法后非零
+        alignas(16) const uint8_t incomplete_table[16] = {
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+        };
+
+        struct utf8_checker {
+            __m128i error;
+            __m128i prev_input;
+            __m128i prev_incomplete;
+        };
+
+        __attribute__((target("ssse3")))
+        inline __m128i high_nibbles(__m128i input) {
+            return _mm_and_si128(_mm_srli_epi16(input, 4), _mm_set1_epi8(0x0F));
+        }
+
+        __attribute__((target("ssse3")))
+        inline void check_block(utf8_checker &checker, __m128i input) {
+            if (_mm_movemask_epi8(input) == 0) {
+                // 纯ASCII块：只需确认上一块没有以未完成的序列结尾
+                checker.error = _mm_or_si128(checker.error, checker.prev_incomplete);
+                checker.prev_incomplete = _mm_setzero_si128();
+                checker.prev_input = input;
+                return;
+            }
+            __m128i prev1 = _mm_alignr_epi8(input, checker.prev_input, 15);
+            __m128i byte_1_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(byte_1_high_table)),
+                                                   high_nibbles(prev1));
+            __m128i byte_1_low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(byte_1_low_table)),
+                                                  _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+            __m128i byte_2_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(byte_2_high_table)),
+                                                   high_nibbles(input));
+            __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+            // 前面第二个字节是三、四字节序列的首字节，或前面第三个字节是四字节序列的首字节时，本字节必须是续字节
+            __m128i prev2 = _mm_alignr_epi8(input, checker.prev_input, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, checker.prev_input, 13);
+            __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            __m128i must_continue = _mm_and_si128(_mm_or_si128(is_third, is_fourth),
+                                                  _mm_set1_epi8(static_cast<char>(0x80)));
+            checker.error = _mm_or_si128(checker.error, _mm_xor_si128(must_continue, special));
+            checker.prev_incomplete = _mm_subs_epu8(input,
+                                                    _mm_load_si128(reinterpret_cast<const __m128i *>(incomplete_table)));
+            checker.prev_input = input;
+        }
+
+        __attribute__((target("ssse3")))
+        bool utf8_valid_ssse3(const char *data, size_t n) {
+            utf8_checker checker{_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+            size_t pos = 0;
+            for (; pos + 16 <= n; pos += 16) {
+                check_block(checker, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos)));
+            }
+            // 剩余部分补'\0'凑成一块；补上的ASCII字节同时会暴露末尾被截断的序列
+            alignas(16) char tail[16] = {0};
+            memcpy(tail, data + pos, n - pos);
+            check_block(checker, _mm_load_si128(reinterpret_cast<const __m128i *>(tail)));
+            checker.error = _mm_or_si128(checker.error, checker.prev_incomplete);
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(checker.error, _mm_setzero_si128())) == 0xFFFF;
+        }
+
+        bool has_ssse3() {
+            static const bool supported = __builtin_cpu_supports("ssse3");
+            return supported;
+        }
+    }
+#endif
+
+    bool utf8_valid(myString_view str) {
+#ifdef MYUTF8_HAS_SSE
+        if (has_ssse3()) {
+            return utf8_valid_ssse3(str.data(), str.size());
+        }
+#endif
+        auto data = reinterpret_cast<const unsigned char *>(str.data());
+        size_t n = str.size();
+        size_t pos = 0;
+        while (pos < n) {
+            // 先按字长跳过ASCII
+            while (pos + 8 <= n && (load_word(str.data() + pos) & high_bits) == 0) {
+                pos += 8;
+            }
+            if (pos == n) {
+                break;
+            }
+            size_t len = sequence_length(data + pos, n - pos);
+            if (len == 0) {
+                return false;
+            }
+            pos += len;
+        }
+        return true;
+    }
+
+    bool is_ascii(myString_view str) {
+        const char *data = str.data();
+        size_t n = str.size();
+        size_t pos = 0;
+#ifdef MYUTF8_HAS_SSE
+        __m128i bits = _mm_setzero_si128();
+        for (; pos + 16 <= n; pos += 16) {
+            bits = _mm_or_si128(bits, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos)));
+        }
+        if (_mm_movemask_epi8(bits) != 0) {
+            return false;
+        }
+#endif
+        uint64_t word = 0;
+        for (; pos + 8 <= n; pos += 8) {
+            word |= load_word(data + pos);
+        }
+        for (; pos < n; pos++) {
+            word |= static_cast<unsigned char>(data[pos]);
+        }
+        return (word & high_bits) == 0;
+    }
+
+    size_t utf8_length(myString_view str) {
+        const char *data = str.data();
+        size_t n = str.size();
+        size_t count = 0;
+        size_t pos = 0;
+#ifdef MYUTF8_HAS_SSE
+        // 有符号比较下续字节为-128~-65，其余字节都大于-65；
+        // 每次比较的结果（0或-1）按字节累减，最多累计255轮后用psadbw横向求和
+        const __m128i threshold = _mm_set1_epi8(-65);
+        while (pos + 16 <= n) {
+            size_t rounds = (n - pos) / 16;
+            if (rounds > 255) {
+                rounds = 255;
+            }
+            __m128i counter = _mm_setzero_si128();
+            for (size_t round = 0; round < rounds; round++, pos += 16) {
+                __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+                counter = _mm_sub_epi8(counter, _mm_cmpgt_epi8(input, threshold));
+            }
+            __m128i sums = _mm_sad_epu8(counter, _mm_setzero_si128());
+            count += static_cast<size_t>(_mm_extract_epi16(sums, 0) + _mm_extract_epi16(sums, 4));
+        }
+#endif
+        for (; pos < n; pos++) {
+            count += !is_continuation(static_cast<unsigned char>(data[pos]));
+        }
+        return count;
+    }
+
+    char32_t utf8_decode(myString_view str, size_t &pos) {
+        assert(pos < str.size());
+        auto s = reinterpret_cast<const unsigned char *>(str.data()) + pos;
+        size_t len = sequence_length(s, str.size() - pos);
+        switch (len) {
+            case 1:
+                pos += 1;
+                return s[0];
+            case 2:
+                pos += 2;
+                return (char32_t(s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+            case 3:
+                pos += 3;
+                return (char32_t(s[0] & 0x0F) << 12) | (char32_t(s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+            case 4:
+                pos += 4;
+                return (char32_t(s[0] & 0x07) << 18) | (char32_t(s[1] & 0x3F) << 12) |
+                       (char32_t(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+            default:
+                pos += 1;
+                return replacement_char;
+        }
+    }
+
+    // 切换[first, last]范围内字母的大小写，其余字节不变
+    static void fold_ascii(char *data, size_t n, char first, char last) {
+        size_t pos = 0;
+#ifdef MYUTF8_HAS_SSE
+        // 非ASCII字节按有符号数是负数，不会落在范围内
+        const __m128i below = _mm_set1_epi8(static_cast<char>(first - 1));
+        const __m128i above = _mm_set1_epi8(static_cast<char>(last + 1));
+        const __m128i delta = _mm_set1_epi8(0x20);
+        for (; pos + 16 <= n; pos += 16) {
+            auto ptr = reinterpret_cast<__m128i *>(data + pos);
+            __m128i input = _mm_loadu_si128(ptr);
+            __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(input, below), _mm_cmplt_epi8(input, above));
+            // 大小写只差0x20这一位，异或即可双向转换
+            _mm_storeu_si128(ptr, _mm_xor_si128(input, _mm_and_si128(in_range, delta)));
+        }
+#endif
+        for (; pos < n; pos++) {
+            if (data[pos] >= first && data[pos] <= last) {
+                data[pos] ^= 0x20;
+            }
+        }
+    }
+
+    void ascii_to_lower(char *data, size_t n) {
+        fold_ascii(data, n, 'A', 'Z');
+    }
+
+    void ascii_to_upper(char *data, size_t n) {
+        fold_ascii(data, n, 'a', 'z');
+    }
+}
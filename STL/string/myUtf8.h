@@ -0,0 +1,55 @@
+// UTF-8 validation, code point counting/iteration and ASCII case folding.
+
+#ifndef STRING_MYUTF8_H
+#define STRING_MYUTF8_H
+
+#include <cstddef>
+#include "myString_view.h"
+
+namespace cocoon {
+    // 解码失败时返回的替换字符U+FFFD
+    const char32_t replacement_char = 0xFFFD;
+
+    // 检查str是否为合法的UTF-8：拒绝过长编码、代理项（U+D800~U+DFFF）、超过U+10FFFF的码点和截断的序列。
+    // x86上按16字节一组用SIMD查表检查，纯ASCII的块只需一次比较；其他平台退化为逐字长跳过ASCII的标量实现。
+    [[nodiscard]] bool utf8_valid(myString_view str);
+
+    // 逐字节的标量实现，作为对照
+    [[nodiscard]] bool utf8_valid_scalar(myString_view str);
+
+    // 是否全为ASCII字符
+    [[nodiscard]] bool is_ascii(myString_view str);
+
+    // 码点个数，即不是续字节（10xxxxxx）的字节数；只对合法的UTF-8有意义
+    [[nodiscard]] size_t utf8_length(myString_view str);
+
+    // 解码从pos开始的一个码点，并把pos移到下一个码点的开头。
+    // 遇到非法或截断的序列时返回replacement_char，pos只前进一个字节
+    char32_t utf8_decode(myString_view str, size_t &pos);
+
+    // 按顺序把每个码点交给f(char32_t)
+    template<class Function>
+    void for_each_code_point(myString_view str, Function f);
+
+    // 原地把ASCII字母转为小写/大写，非ASCII字节（包括多字节序列）保持不变
+    void ascii_to_lower(char *data, size_t n);
+
+    void ascii_to_upper(char *data, size_t n);
+
+    template<class Function>
+    void for_each_code_point(myString_view str, Function f) {
+        size_t pos = 0;
+        while (pos < str.size()) {
+            auto byte = static_cast<unsigned char>(str[pos]);
+            if (byte < 0x80) {
+                // ASCII不走解码
+                f(static_cast<char32_t>(byte));
+                pos++;
+            } else {
+                f(utf8_decode(str, pos));
+            }
+        }
+    }
+}
+
+#endif //STRING_MYUTF8_H
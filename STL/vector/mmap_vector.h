@@ -0,0 +1,434 @@
+/**
+ * @file mmap_vector.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{mmap_vector}
+ */
+#pragma once
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Somn {
+
+	/**
+	 * @brief How an mmap_vector opens its file.
+	 */
+	enum class mmap_mode {
+		create,       /**< Create the file, or truncate an existing one to an empty vector */
+		read_write,   /**< Open an existing vector, or create it when the file is missing */
+		read_only     /**< Map an existing vector read-only; mutating calls throw std::logic_error */
+	};
+
+	/**
+	 * @brief File-backed vector whose elements live in a shared mapping of the file.
+	 *
+	 * Offers the myVector interface for trivially copyable T. The file starts
+	 * with a 64-byte header (magic, element size, element count) followed by
+	 * the elements, so reopening a table is one mmap and no element is read
+	 * until it is touched. Growth doubles the capacity with ftruncate and
+	 * mremap, which may move the mapping and so invalidates iterators, as
+	 * reallocation does in myVector.
+	 *
+	 * Changes reach the file through the page cache; call sync() when they
+	 * must be on disk, e.g. before acknowledging a checkpoint. A moved-from
+	 * vector is empty and holds no file, so it cannot grow.
+	 * @tparam T A trivially copyable element type.
+	 */
+	template<class T>
+	class mmap_vector {
+		static_assert(std::is_trivially_copyable<T>::value, "mmap_vector stores raw bytes of T");
+		static_assert(alignof(T) <= 64, "elements start 64 bytes into the mapping");
+
+	public:
+		typedef T* iterator;           /**< Iterator type for non-constant access */
+		typedef const T* const_iterator; /**< Iterator type for constant access */
+
+		/**
+		 * @brief Open or create the vector stored at path.
+		 * @param path The backing file.
+		 * @param mode Whether to create, update or only read the file.
+		 * @throws std::system_error when the file cannot be opened or mapped.
+		 * @throws std::runtime_error when the file does not hold an mmap_vector of T.
+		 */
+		explicit mmap_vector(const char* path, mmap_mode mode = mmap_mode::read_write);
+
+		mmap_vector(const mmap_vector&) = delete;
+		mmap_vector& operator=(const mmap_vector&) = delete;
+
+		/**
+		 * @brief Take over v's file and mapping, leaving v empty.
+		 */
+		mmap_vector(mmap_vector&& v) noexcept;
+
+		/**
+		 * @brief Unmap and close the file; unsynced changes are left to the page cache.
+		 */
+		~mmap_vector();
+
+		/**
+		 * @brief Append val, growing the file when it is full.
+		 * @throws std::logic_error when the vector is read-only.
+		 */
+		void push_back(const T& val);
+
+		/**
+		 * @brief Grow the file so it holds at least n elements.
+		 * @throws std::logic_error when the vector is read-only and n exceeds the capacity.
+		 */
+		void reserve(size_t n);
+
+		size_t size() const;
+
+		size_t capacity() const;
+
+		iterator begin();
+		const_iterator begin() const;
+		iterator end();
+		const_iterator end() const;
+
+		T& operator[](size_t pos);
+		const T& operator[](size_t pos) const;
+
+		bool empty() const;
+
+		void resize(size_t n, T val = T());
+
+		void pop_back();
+
+		iterator insert(iterator pos, const T& val);
+
+		iterator erase(iterator pos);
+
+		void swap(mmap_vector<T>& v);
+
+		void clear();
+
+		/**
+		 * @brief Flush the header and elements to the file with msync.
+		 * @param wait True to block until written (MS_SYNC), false to only schedule it (MS_ASYNC).
+		 * @throws std::system_error when msync fails.
+		 */
+		void sync(bool wait = true);
+
+		/**
+		 * @brief Check whether the vector was opened read-only.
+		 */
+		bool read_only() const;
+
+	private:
+		// On-disk header, the first 64 bytes of the file
+		struct header {
+			char magic[8];
+			uint64_t element_size;
+			uint64_t size;
+			char reserved[40];
+		};
+		static_assert(sizeof(header) == 64, "header is one cache line");
+
+		static constexpr size_t header_bytes = sizeof(header);
+
+		static size_t bytes_for(size_t capacity) { return header_bytes + capacity * sizeof(T); }
+
+		// Both are null after a move
+		header* head() const { return static_cast<header*>(_map); }
+
+		T* data() const { return _map ? reinterpret_cast<T*>(static_cast<char*>(_map) + header_bytes) : nullptr; }
+
+		// Mutating calls would write to a PROT_READ mapping
+		void check_writable() const;
+
+		// Resize the file and the mapping to hold capacity elements
+		void remap(size_t capacity);
+
+		static void fail(const char* what);
+
+		int _fd;              /**< Backing file, -1 after a move */
+		void* _map;           /**< Mapping of the whole file */
+		size_t _bytes;        /**< Length of the mapping */
+		size_t _capacity;     /**< Elements that fit in the file */
+		bool _read_only;      /**< Opened with mmap_mode::read_only */
+	};
+
+	template<class T>
+	inline void mmap_vector<T>::fail(const char* what)
+	{
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::check_writable() const
+	{
+		if (_read_only) {
+			throw std::logic_error("mmap_vector: vector was opened read-only");
+		}
+	}
+
+	template<class T>
+	inline mmap_vector<T>::mmap_vector(const char* path, mmap_mode mode)
+		: _fd(-1), _map(nullptr), _bytes(0), _capacity(0), _read_only(mode == mmap_mode::read_only)
+	{
+		static const char magic[8] = {'S', 'O', 'M', 'N', 'V', 'E', 'C', '1'};
+		int flags = _read_only ? O_RDONLY : O_RDWR | O_CREAT | (mode == mmap_mode::create ? O_TRUNC : 0);
+		_fd = ::open(path, flags | O_CLOEXEC, 0644);
+		if (_fd < 0) {
+			fail("mmap_vector: open");
+		}
+		struct stat st;
+		if (::fstat(_fd, &st) != 0) {
+			int saved = errno;
+			::close(_fd);
+			errno = saved;
+			fail("mmap_vector: fstat");
+		}
+		size_t file_bytes = static_cast<size_t>(st.st_size);
+		bool fresh = file_bytes == 0 && !_read_only;
+		if (fresh) {
+			if (::ftruncate(_fd, static_cast<off_t>(header_bytes)) != 0) {
+				int saved = errno;
+				::close(_fd);
+				errno = saved;
+				fail("mmap_vector: ftruncate");
+			}
+			file_bytes = header_bytes;
+		}
+		if (file_bytes < header_bytes) {
+			::close(_fd);
+			throw std::runtime_error("mmap_vector: file too short for a header");
+		}
+		_map = ::mmap(nullptr, file_bytes, _read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+		if (_map == MAP_FAILED) {
+			int saved = errno;
+			::close(_fd);
+			errno = saved;
+			fail("mmap_vector: mmap");
+		}
+		_bytes = file_bytes;
+		_capacity = (file_bytes - header_bytes) / sizeof(T);
+		if (fresh) {
+			std::memcpy(head()->magic, magic, sizeof(magic));
+			head()->element_size = sizeof(T);
+			head()->size = 0;
+		}
+		if (std::memcmp(head()->magic, magic, sizeof(magic)) != 0 || head()->element_size != sizeof(T)
+			|| head()->size > _capacity) {
+			::munmap(_map, file_bytes);
+			::close(_fd);
+			throw std::runtime_error("mmap_vector: file does not hold a vector of this element type");
+		}
+	}
+
+	template<class T>
+	inline mmap_vector<T>::mmap_vector(mmap_vector&& v) noexcept
+		: _fd(v._fd), _map(v._map), _bytes(v._bytes), _capacity(v._capacity), _read_only(v._read_only)
+	{
+		v._fd = -1;
+		v._map = nullptr;
+		v._bytes = 0;
+		v._capacity = 0;
+	}
+
+	template<class T>
+	inline mmap_vector<T>::~mmap_vector()
+	{
+		if (_map) {
+			::munmap(_map, _bytes);
+		}
+		if (_fd >= 0) {
+			::close(_fd);
+		}
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::remap(size_t capacity)
+	{
+		assert(!_read_only);
+		size_t old_bytes = _bytes, new_bytes = bytes_for(capacity);
+		if (::ftruncate(_fd, static_cast<off_t>(new_bytes)) != 0) {
+			fail("mmap_vector: ftruncate");
+		}
+#ifdef MREMAP_MAYMOVE
+		void* map = ::mremap(_map, old_bytes, new_bytes, MREMAP_MAYMOVE);
+#else
+		::munmap(_map, old_bytes);
+		void* map = ::mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+#endif
+		if (map == MAP_FAILED) {
+			fail("mmap_vector: mremap");
+		}
+		_map = map;
+		_bytes = new_bytes;
+		_capacity = capacity;
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::push_back(const T& val)
+	{
+		check_writable();
+		size_t n = size();
+		if (n == _capacity) {
+			// At least a page of elements, then doubling
+			size_t first = (4096 - header_bytes) / sizeof(T);
+			reserve(_capacity * 2 > first ? _capacity * 2 : (first ? first : 1));
+		}
+		data()[n] = val;
+		head()->size = n + 1;
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::reserve(size_t n)
+	{
+		if (n > _capacity) {
+			check_writable();
+			remap(n);
+		}
+	}
+
+	template<class T>
+	inline size_t mmap_vector<T>::size() const
+	{
+		return _map ? static_cast<size_t>(head()->size) : 0;
+	}
+
+	template<class T>
+	inline size_t mmap_vector<T>::capacity() const
+	{
+		return _capacity;
+	}
+
+	template<class T>
+	inline typename mmap_vector<T>::iterator mmap_vector<T>::begin()
+	{
+		return data();
+	}
+
+	template<class T>
+	inline typename mmap_vector<T>::const_iterator mmap_vector<T>::begin() const
+	{
+		return data();
+	}
+
+	template<class T>
+	inline typename mmap_vector<T>::iterator mmap_vector<T>::end()
+	{
+		return data() + size();
+	}
+
+	template<class T>
+	inline typename mmap_vector<T>::const_iterator mmap_vector<T>::end() const
+	{
+		return data() + size();
+	}
+
+	template<class T>
+	inline T& mmap_vector<T>::operator[](size_t pos)
+	{
+		assert(pos < size());
+		return data()[pos];
+	}
+
+	template<class T>
+	inline const T& mmap_vector<T>::operator[](size_t pos) const
+	{
+		assert(pos < size());
+		return data()[pos];
+	}
+
+	template<class T>
+	inline bool mmap_vector<T>::empty() const
+	{
+		return size() == 0;
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::resize(size_t n, T val)
+	{
+		check_writable();
+		reserve(n);
+		for (size_t index = size(); index < n; index++) {
+			data()[index] = val;
+		}
+		// Only resize(0) gets here without a mapping
+		if (_map) {
+			head()->size = n;
+		}
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::pop_back()
+	{
+		check_writable();
+		assert(!empty());
+		head()->size = size() - 1;
+	}
+
+	template<class T>
+	inline typename mmap_vector<T>::iterator mmap_vector<T>::insert(iterator pos, const T& val)
+	{
+		check_writable();
+		assert(pos >= begin() && pos <= end());
+		size_t index = pos - begin(), n = size();
+		T copy = val;
+		push_back(copy);
+		// push_back may have moved the mapping; shift by index
+		std::memmove(data() + index + 1, data() + index, (n - index) * sizeof(T));
+		data()[index] = copy;
+		return data() + index;
+	}
+
+	template<class T>
+	inline typename mmap_vector<T>::iterator mmap_vector<T>::erase(iterator pos)
+	{
+		check_writable();
+		assert(pos >= begin() && pos < end());
+		std::memmove(pos, pos + 1, (end() - pos - 1) * sizeof(T));
+		head()->size = size() - 1;
+		return pos;
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::swap(mmap_vector<T>& v)
+	{
+		std::swap(_fd, v._fd);
+		std::swap(_map, v._map);
+		std::swap(_bytes, v._bytes);
+		std::swap(_capacity, v._capacity);
+		std::swap(_read_only, v._read_only);
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::clear()
+	{
+		check_writable();
+		if (_map) {
+			head()->size = 0;
+		}
+	}
+
+	template<class T>
+	inline void mmap_vector<T>::sync(bool wait)
+	{
+		if (_read_only || !_map) {
+			return;
+		}
+		if (::msync(_map, _bytes, wait ? MS_SYNC : MS_ASYNC) != 0) {
+			fail("mmap_vector: msync");
+		}
+	}
+
+	template<class T>
+	inline bool mmap_vector<T>::read_only() const
+	{
+		return _read_only;
+	}
+
+}
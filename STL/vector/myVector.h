@@ -6,6 +6,9 @@
  */
 #pragma once
 #include <cassert>
+#include <cstring>
+#include <type_traits>
+#include "../memory/arena.h"
 
 namespace Somn {
 
@@ -24,6 +27,12 @@ namespace Somn {
 		 */
 		myVector();
 
+		/**
+		 * @brief Constructs an empty myVector that allocates from the given resource.
+		 * @param resource The memory resource used for the element buffer, e.g. an arena.
+		 */
+		explicit myVector(memory_resource* resource);
+
 		/**
 		 * @brief Copy constructor, copies elements from another myVector object.
 		 * @param v The myVector object to copy from.
@@ -62,6 +71,12 @@ namespace Somn {
 		 */
 		size_t capacity() const;
 
+		/**
+		 * @brief Get the memory resource the vector allocates from.
+		 * @return The resource passed at construction, or default_resource().
+		 */
+		memory_resource* resource() const;
+
 		/**
 		 * @brief Get an iterator pointing to the beginning of the vector
 		 * @return An iterator pointing to the first element.
@@ -93,6 +108,13 @@ namespace Somn {
 		 */
 		T& operator[](size_t pos);
 
+		/**
+		 * @brief Access an element in the vector by index (const version)
+		 * @param pos The index of the element to access.
+		 * @return A constant reference to the element at the specified index.
+		 */
+		const T& operator[](size_t pos) const;
+
 		/**
 		 * @brief Check if the vector is empty.
 		 * @return True if the vector is empty, false otherwise.
@@ -137,6 +159,16 @@ namespace Somn {
 		 */
 		void clear();
 
+		/**
+		 * @brief Replace the contents with n elements copied from first.
+		 *
+		 * Reserves once and copies straight into the new storage, with a single
+		 * memcpy for trivially copyable T, so the elements are written only once.
+		 * @param first Start of the source elements; must not point into this vector.
+		 * @param n The number of elements to copy.
+		 */
+		void assign(const T* first, size_t n);
+
 		/**
 		 * @brief Copy assignment operator for myVector.
 		 * @param v The myVector object to copy from.
@@ -161,17 +193,22 @@ namespace Somn {
 		iterator _start;          /**< Pointer to the start of the vector */
 		iterator _finish;         /**< Pointer to the end of the used elements */
 		iterator _end_of_storage; /**< Pointer to the end of the allocated memory */
+		memory_resource* _resource; /**< Source of the element buffer */
 	};
 
 	// Default constructor
 	template<class T>
-	inline myVector<T>::myVector() : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr) {}
+	inline myVector<T>::myVector() : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr), _resource(default_resource()) {}
+
+	template<class T>
+	inline myVector<T>::myVector(memory_resource* resource) : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr), _resource(resource) {}
 
 	template<class T>
 	inline myVector<T>::myVector(const myVector<T>& v)
 		: _start(nullptr),
 		_finish(nullptr),
-		_end_of_storage(nullptr)
+		_end_of_storage(nullptr),
+		_resource(default_resource())
 	{
 		// Create a temporary myVector object 'temp' and initialize it with the elements from 'v'
 		myVector<T> temp(v.begin(), v.end());
@@ -203,7 +240,7 @@ namespace Somn {
 		// This function cannot perform capacity reduction.
 		if (newCapacity > capacity()) {
 			// Allocate temporary space for the new capacity.
-			T* tempSpace = new T[newCapacity];
+			T* tempSpace = new_array<T>(_resource, newCapacity);
 
 			// If the vector is not empty, copy the existing data to the new space.
 			if (_start) {
@@ -211,7 +248,7 @@ namespace Somn {
 				for (size_t index = 0; index < size(); index++) {
 					tempSpace[index] = _start[index];
 				}
-				delete[] _start;
+				delete_array(_resource, _start, capacity());
 			}
 
 			// Preserve the size value to avoid errors in the subsequent size() function.
@@ -246,6 +283,13 @@ namespace Somn {
 		return _end_of_storage - _start;
 	}
 
+	// Get the memory resource the vector allocates from
+	template<class T>
+	inline memory_resource* myVector<T>::resource() const
+	{
+		return _resource;
+	}
+
 	// Get an iterator pointing to the beginning of the vector
 	template<class T>
 	inline typename myVector<T>::iterator myVector<T>::begin()
@@ -287,6 +331,14 @@ namespace Somn {
 		return _start[pos];
 	}
 
+	// Access an element in the vector by index (const version)
+	template<class T>
+	inline const T& myVector<T>::operator[](size_t pos) const
+	{
+		assert(pos < size());
+		return _start[pos];
+	}
+
 	// Check if the vector is empty.
 	template<class T>
 	inline bool myVector<T>::empty() const
@@ -375,6 +427,7 @@ namespace Somn {
 		std::swap(_start, v._start);
 		std::swap(_finish, v._finish);
 		std::swap(_end_of_storage, v._end_of_storage);
+		std::swap(_resource, v._resource);
 	}
 
 	template<class T>
@@ -384,12 +437,31 @@ namespace Somn {
 		_finish = _start;
 	}
 
+	template<class T>
+	inline void myVector<T>::assign(const T* first, size_t n)
+	{
+		clear();
+		reserve(n);
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			if (n > 0) {
+				std::memcpy(_start, first, n * sizeof(T));
+			}
+		}
+		else {
+			for (size_t index = 0; index < n; index++) {
+				_start[index] = first[index];
+			}
+		}
+		_finish = _start + n;
+	}
+
 	template<class T>
 	inline myVector<T>& myVector<T>::operator=(const myVector<T>& v)
 	{
-		if (v._start != _start) {
-			myVector<T> temp(v);
-			swap(v);
+		// Copy into storage from this vector's own resource, as std::pmr does, so an arena-backed
+		// vector stays on its arena
+		if (this != &v) {
+			assign(v.begin(), v.size());
 		}
 		return *this;
 	}
@@ -398,7 +470,8 @@ namespace Somn {
 	inline myVector<T>::myVector(size_t n, const T& val)
 		: _start(nullptr),
 		_finish(nullptr),
-		_end_of_storage(nullptr)
+		_end_of_storage(nullptr),
+		_resource(default_resource())
 	{
 		reserve(n);
 		for (size_t index = 0; index < n; index++) {
@@ -410,7 +483,8 @@ namespace Somn {
 	inline myVector<T>::myVector(int n, const T& val)
 		: _start(nullptr),
 		_finish(nullptr),
-		_end_of_storage(nullptr)
+		_end_of_storage(nullptr),
+		_resource(default_resource())
 	{
 		reserve(n);
 		for (size_t index = 0; index < n; index++) {
@@ -421,8 +495,8 @@ namespace Somn {
 	template<class T>
 	inline myVector<T>::~myVector()
 	{
-		// Deallocate the dynamically allocated memory
-		delete[] _start;
+		// Deallocate the memory obtained from the resource
+		delete_array(_resource, _start, capacity());
 
 		// Set pointers to nullptr to indicate that the object is now empty
 		_start = _finish = _end_of_storage = nullptr;
@@ -433,7 +507,8 @@ namespace Somn {
 	inline myVector<T>::myVector(InputIterator first, InputIterator last)
 		: _start(nullptr),
 		_finish(nullptr),
-		_end_of_storage(nullptr)
+		_end_of_storage(nullptr),
+		_resource(default_resource())
 	{
 		// Iterate through the input range and add elements to the vector using push_back
 		while (first != last) {
@@ -442,4 +517,7 @@ namespace Somn {
 		}
 	}
 
-}
\ No newline at end of file
+}
+
+// Bit-packed specialization for bool
+#include "myVector_bool.h"
@@ -0,0 +1,659 @@
+/**
+ * @file myVector_bool.h
+ * This is an internal header file, included by other library headers.
+ * Do not attempt to use it directly.
+ * @headername{myVector}
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include "../memory/arena.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MYVECTOR_BOOL_HAS_AVX2 1
+#endif
+
+namespace Somn {
+
+	template<class T>
+	class myVector;
+
+	namespace detail {
+		/**
+		 * @brief Word kernels behind myVector<bool>; the AVX2 versions are picked at run time.
+		 */
+		namespace bits {
+			inline size_t count_scalar(const uint64_t* words, size_t n) {
+				size_t total = 0;
+				for (size_t index = 0; index < n; index++) {
+					total += __builtin_popcountll(words[index]);
+				}
+				return total;
+			}
+
+			inline void and_scalar(uint64_t* dst, const uint64_t* src, size_t n) {
+				for (size_t index = 0; index < n; index++) {
+					dst[index] &= src[index];
+				}
+			}
+
+			inline void or_scalar(uint64_t* dst, const uint64_t* src, size_t n) {
+				for (size_t index = 0; index < n; index++) {
+					dst[index] |= src[index];
+				}
+			}
+
+			inline void xor_scalar(uint64_t* dst, const uint64_t* src, size_t n) {
+				for (size_t index = 0; index < n; index++) {
+					dst[index] ^= src[index];
+				}
+			}
+
+			inline void not_scalar(uint64_t* dst, size_t n) {
+				for (size_t index = 0; index < n; index++) {
+					dst[index] = ~dst[index];
+				}
+			}
+
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+			// Without -mpopcnt, __builtin_popcountll is a library call; this version gets the instruction
+			__attribute__((target("popcnt")))
+			inline size_t count_popcnt(const uint64_t* words, size_t n) {
+				size_t total = 0;
+				for (size_t index = 0; index < n; index++) {
+					total += __builtin_popcountll(words[index]);
+				}
+				return total;
+			}
+
+			// Per-nibble counts through a shuffle table, summed per 64-bit lane with psadbw
+			__attribute__((target("avx2")))
+			inline size_t count_avx2(const uint64_t* words, size_t n) {
+				const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+				                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+				const __m256i low_mask = _mm256_set1_epi8(0x0F);
+				__m256i total = _mm256_setzero_si256();
+				size_t index = 0;
+				for (; index + 4 <= n; index += 4) {
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + index));
+					__m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low_mask));
+					__m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+					total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+				}
+				alignas(32) uint64_t lanes[4];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+				return lanes[0] + lanes[1] + lanes[2] + lanes[3] + count_popcnt(words + index, n - index);
+			}
+
+			__attribute__((target("avx2")))
+			inline void and_avx2(uint64_t* dst, const uint64_t* src, size_t n) {
+				size_t index = 0;
+				for (; index + 4 <= n; index += 4) {
+					__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + index));
+					__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), _mm256_and_si256(a, b));
+				}
+				and_scalar(dst + index, src + index, n - index);
+			}
+
+			__attribute__((target("avx2")))
+			inline void or_avx2(uint64_t* dst, const uint64_t* src, size_t n) {
+				size_t index = 0;
+				for (; index + 4 <= n; index += 4) {
+					__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + index));
+					__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), _mm256_or_si256(a, b));
+				}
+				or_scalar(dst + index, src + index, n - index);
+			}
+
+			__attribute__((target("avx2")))
+			inline void xor_avx2(uint64_t* dst, const uint64_t* src, size_t n) {
+				size_t index = 0;
+				for (; index + 4 <= n; index += 4) {
+					__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + index));
+					__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), _mm256_xor_si256(a, b));
+				}
+				xor_scalar(dst + index, src + index, n - index);
+			}
+
+			__attribute__((target("avx2")))
+			inline void not_avx2(uint64_t* dst, size_t n) {
+				const __m256i ones = _mm256_set1_epi64x(-1);
+				size_t index = 0;
+				for (; index + 4 <= n; index += 4) {
+					__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + index));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), _mm256_xor_si256(a, ones));
+				}
+				not_scalar(dst + index, n - index);
+			}
+
+			// First nonzero word at or after index; four words are tested at a time across empty stretches
+			__attribute__((target("avx2")))
+			inline size_t next_nonzero_avx2(const uint64_t* words, size_t index, size_t n) {
+				for (; index + 4 <= n; index += 4) {
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + index));
+					if (!_mm256_testz_si256(v, v)) {
+						break;
+					}
+				}
+				while (index < n && words[index] == 0) {
+					index++;
+				}
+				return index;
+			}
+
+			inline bool has_avx2() {
+				static const bool supported = __builtin_cpu_supports("avx2");
+				return supported;
+			}
+
+			inline bool has_popcnt() {
+				static const bool supported = __builtin_cpu_supports("popcnt");
+				return supported;
+			}
+#endif
+
+			inline size_t count(const uint64_t* words, size_t n) {
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+				if (has_avx2()) {
+					return count_avx2(words, n);
+				}
+				if (has_popcnt()) {
+					return count_popcnt(words, n);
+				}
+#endif
+				return count_scalar(words, n);
+			}
+
+			inline size_t next_nonzero(const uint64_t* words, size_t index, size_t n) {
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+				if (has_avx2()) {
+					return next_nonzero_avx2(words, index, n);
+				}
+#endif
+				while (index < n && words[index] == 0) {
+					index++;
+				}
+				return index;
+			}
+
+			inline void bit_and(uint64_t* dst, const uint64_t* src, size_t n) {
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+				if (has_avx2()) {
+					return and_avx2(dst, src, n);
+				}
+#endif
+				and_scalar(dst, src, n);
+			}
+
+			inline void bit_or(uint64_t* dst, const uint64_t* src, size_t n) {
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+				if (has_avx2()) {
+					return or_avx2(dst, src, n);
+				}
+#endif
+				or_scalar(dst, src, n);
+			}
+
+			inline void bit_xor(uint64_t* dst, const uint64_t* src, size_t n) {
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+				if (has_avx2()) {
+					return xor_avx2(dst, src, n);
+				}
+#endif
+				xor_scalar(dst, src, n);
+			}
+
+			inline void bit_not(uint64_t* dst, size_t n) {
+#ifdef MYVECTOR_BOOL_HAS_AVX2
+				if (has_avx2()) {
+					return not_avx2(dst, n);
+				}
+#endif
+				not_scalar(dst, n);
+			}
+		}
+	}
+
+	/**
+	 * @brief Bit-packed specialization of myVector for bool.
+	 *
+	 * Bits are stored 64 to a word, so a presence bitmap of n ids takes n/8
+	 * bytes. Elements are accessed through a proxy reference, as with
+	 * std::vector<bool>. Counting, searching and the bitwise operations work
+	 * a word at a time, with AVX2 versions chosen at run time when the CPU
+	 * has them. Bits past size() in the last word are always zero.
+	 */
+	template<>
+	class myVector<bool> {
+	public:
+		/**
+		 * @brief Proxy for one bit, returned by the non-const operator[] and iterators.
+		 */
+		class reference {
+		public:
+			reference(uint64_t* word, uint64_t mask) : _word(word), _mask(mask) {}
+
+			operator bool() const { return (*_word & _mask) != 0; }
+
+			reference& operator=(bool val) {
+				if (val) {
+					*_word |= _mask;
+				}
+				else {
+					*_word &= ~_mask;
+				}
+				return *this;
+			}
+
+			reference& operator=(const reference& other) {
+				return *this = static_cast<bool>(other);
+			}
+
+			void flip() { *_word ^= _mask; }
+
+		private:
+			uint64_t* _word;   /**< Word holding the bit */
+			uint64_t _mask;    /**< The bit within the word */
+		};
+
+		/**
+		 * @brief Random-access iterator over the bits; Ref is reference or bool.
+		 */
+		template<class Ref>
+		class bit_iterator {
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef bool value_type;
+			typedef ptrdiff_t difference_type;
+			typedef void pointer;
+			typedef Ref reference;
+
+			bit_iterator() : _words(nullptr), _pos(0) {}
+
+			bit_iterator(uint64_t* words, size_t pos) : _words(words), _pos(pos) {}
+
+			Ref operator*() const { return myVector<bool>::reference(_words + _pos / 64, uint64_t(1) << (_pos % 64)); }
+
+			Ref operator[](difference_type n) const { return *(*this + n); }
+
+			bit_iterator& operator++() { ++_pos; return *this; }
+
+			bit_iterator operator++(int) { bit_iterator temp(*this); ++_pos; return temp; }
+
+			bit_iterator& operator--() { --_pos; return *this; }
+
+			bit_iterator operator--(int) { bit_iterator temp(*this); --_pos; return temp; }
+
+			bit_iterator& operator+=(difference_type n) { _pos += n; return *this; }
+
+			bit_iterator& operator-=(difference_type n) { _pos -= n; return *this; }
+
+			bit_iterator operator+(difference_type n) const { return bit_iterator(_words, _pos + n); }
+
+			bit_iterator operator-(difference_type n) const { return bit_iterator(_words, _pos - n); }
+
+			difference_type operator-(const bit_iterator& it) const { return difference_type(_pos) - difference_type(it._pos); }
+
+			bool operator==(const bit_iterator& it) const { return _pos == it._pos; }
+
+			bool operator!=(const bit_iterator& it) const { return _pos != it._pos; }
+
+			bool operator<(const bit_iterator& it) const { return _pos < it._pos; }
+
+			/** Index of the bit this iterator points at. */
+			size_t index() const { return _pos; }
+
+		private:
+			uint64_t* _words;
+			size_t _pos;
+		};
+
+		typedef bit_iterator<reference> iterator;        /**< Iterator type for non-constant access */
+		typedef bit_iterator<bool> const_iterator;       /**< Iterator type for constant access */
+
+		/** Returned by find_first and find_next when there is no set bit. */
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		/**
+		 * @brief Default constructor
+		 */
+		myVector() : myVector(default_resource()) {}
+
+		/**
+		 * @brief Constructs an empty bit vector that allocates from the given resource.
+		 */
+		explicit myVector(memory_resource* resource) : _words(nullptr), _size(0), _capacity(0), _resource(resource) {}
+
+		/**
+		 * @brief Copy constructor; the copy uses the default resource.
+		 */
+		myVector(const myVector<bool>& v) : myVector() {
+			reserve(v._size);
+			if (v._size) {
+				memcpy(_words, v._words, word_count(v._size) * sizeof(uint64_t));
+			}
+			_size = v._size;
+		}
+
+		/**
+		 * @brief Constructs a bit vector from an iterator range of values convertible to bool.
+		 */
+		template<class InputIterator>
+		myVector(InputIterator first, InputIterator last) : myVector() {
+			for (; first != last; ++first) {
+				push_back(static_cast<bool>(*first));
+			}
+		}
+
+		/**
+		 * @brief Constructs n bits, all set to val.
+		 */
+		explicit myVector(size_t n, bool val = false) : myVector() {
+			resize(n, val);
+		}
+
+		explicit myVector(int n, bool val = false) : myVector(static_cast<size_t>(n), val) {}
+
+		/**
+		 * @brief Copy assignment; keeps this vector's resource, reallocating from it only when v does not fit.
+		 */
+		myVector<bool>& operator=(const myVector<bool>& v) {
+			if (this != &v) {
+				size_t used = word_count(v._size), old = word_count(_size);
+				if (v._size > _capacity) {
+					delete_array(_resource, _words, _capacity / 64);
+					_words = nullptr;
+					_size = _capacity = 0;
+					old = 0;
+					reserve(v._size);
+				}
+				if (used) {
+					memcpy(_words, v._words, used * sizeof(uint64_t));
+				}
+				// Keep the bits past the end zero
+				if (old > used) {
+					memset(_words + used, 0, (old - used) * sizeof(uint64_t));
+				}
+				_size = v._size;
+			}
+			return *this;
+		}
+
+		~myVector() {
+			delete_array(_resource, _words, _capacity / 64);
+			_words = nullptr;
+			_size = _capacity = 0;
+		}
+
+		void push_back(bool val) {
+			if (_size == _capacity) {
+				reserve(_capacity == 0 ? 64 : _capacity * 2);
+			}
+			if (val) {
+				_words[_size / 64] |= uint64_t(1) << (_size % 64);
+			}
+			_size++;
+		}
+
+		/**
+		 * @brief Remove the last bit; it is cleared so the tail stays zero.
+		 */
+		void pop_back() {
+			assert(_size > 0);
+			_size--;
+			_words[_size / 64] &= ~(uint64_t(1) << (_size % 64));
+		}
+
+		/**
+		 * @brief Make room for at least n bits, rounded up to whole words.
+		 */
+		void reserve(size_t n) {
+			if (n <= _capacity) {
+				return;
+			}
+			size_t words = word_count(n);
+			uint64_t* fresh = new_array<uint64_t>(_resource, words);
+			size_t used = word_count(_size);
+			if (used) {
+				memcpy(fresh, _words, used * sizeof(uint64_t));
+			}
+			memset(fresh + used, 0, (words - used) * sizeof(uint64_t));
+			delete_array(_resource, _words, _capacity / 64);
+			_words = fresh;
+			_capacity = words * 64;
+		}
+
+		/**
+		 * @brief Grow with bits equal to val, or shrink, clearing the dropped bits.
+		 */
+		void resize(size_t n, bool val = false) {
+			if (n < _size) {
+				size_t words = word_count(_size);
+				_size = n;
+				clear_tail();
+				memset(_words + word_count(n), 0, (words - word_count(n)) * sizeof(uint64_t));
+				return;
+			}
+			reserve(n);
+			if (val) {
+				// Finish the partial word, then fill whole words
+				size_t pos = _size;
+				for (; pos < n && pos % 64 != 0; pos++) {
+					_words[pos / 64] |= uint64_t(1) << (pos % 64);
+				}
+				if (pos < n) {
+					memset(_words + pos / 64, 0xFF, (word_count(n) - pos / 64) * sizeof(uint64_t));
+				}
+			}
+			_size = n;
+			clear_tail();
+		}
+
+		size_t size() const { return _size; }
+
+		/** Capacity in bits, a multiple of 64. */
+		size_t capacity() const { return _capacity; }
+
+		bool empty() const { return _size == 0; }
+
+		memory_resource* resource() const { return _resource; }
+
+		iterator begin() { return iterator(_words, 0); }
+
+		iterator end() { return iterator(_words, _size); }
+
+		const_iterator begin() const { return const_iterator(_words, 0); }
+
+		const_iterator end() const { return const_iterator(_words, _size); }
+
+		reference operator[](size_t pos) {
+			assert(pos < _size);
+			return reference(_words + pos / 64, uint64_t(1) << (pos % 64));
+		}
+
+		bool operator[](size_t pos) const { return test(pos); }
+
+		bool test(size_t pos) const {
+			assert(pos < _size);
+			return (_words[pos / 64] >> (pos % 64)) & 1;
+		}
+
+		void set(size_t pos) {
+			assert(pos < _size);
+			_words[pos / 64] |= uint64_t(1) << (pos % 64);
+		}
+
+		void reset(size_t pos) {
+			assert(pos < _size);
+			_words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+		}
+
+		void flip(size_t pos) {
+			assert(pos < _size);
+			_words[pos / 64] ^= uint64_t(1) << (pos % 64);
+		}
+
+		/**
+		 * @brief Insert val before pos, shifting the later bits up by one word at a time.
+		 */
+		iterator insert(iterator pos, bool val) {
+			size_t index = pos.index();
+			assert(index <= _size);
+			push_back(false);
+			size_t first = index / 64, last = (_size - 1) / 64;
+			// Carry the top bit of each word into the next one, from the last word down
+			for (size_t word = last; word > first; word--) {
+				_words[word] = (_words[word] << 1) | (_words[word - 1] >> 63);
+			}
+			uint64_t low = (uint64_t(1) << (index % 64)) - 1;
+			uint64_t cur = _words[first];
+			_words[first] = (cur & low) | ((cur & ~low) << 1);
+			clear_tail();
+			(*this)[index] = val;
+			return iterator(_words, index);
+		}
+
+		/**
+		 * @brief Erase the bit at pos, shifting the later bits down.
+		 */
+		iterator erase(iterator pos) {
+			size_t index = pos.index();
+			assert(index < _size);
+			size_t first = index / 64, last = (_size - 1) / 64;
+			uint64_t low = (uint64_t(1) << (index % 64)) - 1;
+			uint64_t cur = _words[first];
+			_words[first] = (cur & low) | ((cur >> 1) & ~low);
+			for (size_t word = first; word < last; word++) {
+				_words[word] |= _words[word + 1] << 63;
+				_words[word + 1] >>= 1;
+			}
+			_size--;
+			clear_tail();
+			return iterator(_words, index);
+		}
+
+		void swap(myVector<bool>& v) {
+			std::swap(_words, v._words);
+			std::swap(_size, v._size);
+			std::swap(_capacity, v._capacity);
+			std::swap(_resource, v._resource);
+		}
+
+		void clear() {
+			if (_words) {
+				memset(_words, 0, word_count(_size) * sizeof(uint64_t));
+			}
+			_size = 0;
+		}
+
+		/**
+		 * @brief Number of set bits.
+		 */
+		size_t count() const {
+			return detail::bits::count(_words, word_count(_size));
+		}
+
+		bool any() const { return find_first() != npos; }
+
+		bool none() const { return !any(); }
+
+		/**
+		 * @brief Index of the first set bit, or npos.
+		 */
+		size_t find_first() const {
+			return find_from(0);
+		}
+
+		/**
+		 * @brief Index of the first set bit after pos, or npos; also npos for pos == npos.
+		 */
+		size_t find_next(size_t pos) const {
+			// Compare before adding, so pos == npos cannot wrap around to 0
+			return pos >= _size || pos == _size - 1 ? npos : find_from(pos + 1);
+		}
+
+		/**
+		 * @brief Bitwise AND with another bit vector of the same size.
+		 */
+		myVector<bool>& operator&=(const myVector<bool>& v) {
+			assert(v._size == _size);
+			detail::bits::bit_and(_words, v._words, word_count(_size));
+			return *this;
+		}
+
+		myVector<bool>& operator|=(const myVector<bool>& v) {
+			assert(v._size == _size);
+			detail::bits::bit_or(_words, v._words, word_count(_size));
+			return *this;
+		}
+
+		myVector<bool>& operator^=(const myVector<bool>& v) {
+			assert(v._size == _size);
+			detail::bits::bit_xor(_words, v._words, word_count(_size));
+			return *this;
+		}
+
+		/**
+		 * @brief Invert every bit (bitwise NOT) in place.
+		 */
+		myVector<bool>& flip() {
+			detail::bits::bit_not(_words, word_count(_size));
+			clear_tail();
+			return *this;
+		}
+
+		myVector<bool> operator~() const {
+			myVector<bool> result(*this);
+			result.flip();
+			return result;
+		}
+
+		/**
+		 * @brief The underlying words, bit i in word i / 64 at position i % 64.
+		 */
+		const uint64_t* data() const { return _words; }
+
+	private:
+		static size_t word_count(size_t bits) {
+			return (bits + 63) / 64;
+		}
+
+		// Keep the bits past _size in the last word zero, so whole-word operations can ignore the size
+		void clear_tail() {
+			if (_size % 64) {
+				_words[_size / 64] &= (uint64_t(1) << (_size % 64)) - 1;
+			}
+		}
+
+		size_t find_from(size_t pos) const {
+			size_t words = word_count(_size);
+			size_t index = pos / 64;
+			if (index >= words) {
+				return npos;
+			}
+			uint64_t word = _words[index] & (~uint64_t(0) << (pos % 64));
+			if (word == 0) {
+				index = detail::bits::next_nonzero(_words, index + 1, words);
+				if (index == words) {
+					return npos;
+				}
+				word = _words[index];
+			}
+			return index * 64 + __builtin_ctzll(word);
+		}
+
+		uint64_t* _words;               /**< Packed bits */
+		size_t _size;                   /**< Number of bits */
+		size_t _capacity;               /**< Allocated bits, a multiple of 64 */
+		memory_resource* _resource;     /**< Source of _words */
+	};
+
+}
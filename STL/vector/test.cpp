@@ -1,5 +1,11 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <random>
+#include <vector>
 #include "myVector.h" // Include your header file based on your filename and path
+#include "mmap_vector.h"
 
 void test_vector1() {
     using namespace Somn;
@@ -96,7 +102,272 @@ void test_vector3() {
     }
 }
 
+void test_bit_vector() {
+    using namespace Somn;
+
+    myVector<bool> bits;
+    for (int i = 0; i < 200; ++i) {
+        bits.push_back(i % 3 == 0);
+    }
+    bits[1] = true;
+    bits[0].flip();
+    std::cout << "bits: size " << bits.size() << ", capacity " << bits.capacity() << ", count " << bits.count()
+              << ", first " << bits.find_first() << ", next after 1 " << bits.find_next(1) << std::endl;
+    const size_t npos = myVector<bool>::npos;
+    std::cout << "find_next at the end: last " << (bits.find_next(bits.size() - 1) == npos) << ", past the end "
+              << (bits.find_next(500) == npos) << ", npos " << (bits.find_next(npos) == npos) << ", empty "
+              << (myVector<bool>().find_next(0) == npos) << std::endl;
+
+    // Assignment keeps the target's arena, growing from it and shrinking with a zeroed tail
+    arena bits_arena;
+    myVector<bool> on_arena(&bits_arena);
+    on_arena = bits;
+    bool grown = on_arena.resource() == &bits_arena && on_arena.size() == bits.size() && on_arena.count() == bits.count();
+    myVector<bool> few;
+    few.push_back(true);
+    on_arena = few;
+    on_arena.resize(200);
+    std::cout << "bit assign on arena: grown " << grown << ", resource kept " << (on_arena.resource() == &bits_arena)
+              << ", count after shrink and regrow " << on_arena.count() << std::endl;
+
+    // Insert and erase shift across word boundaries
+    myVector<bool> shifted(bits);
+    shifted.insert(shifted.begin() + 10, true);
+    shifted.erase(shifted.begin() + 130);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        bool expected = i < 10 ? bits[i] : i == 10 ? true : i < 130 ? bits[i - 1] : bits[i];
+        mismatches += shifted[i] != expected;
+    }
+    std::cout << "insert/erase: size " << shifted.size() << ", mismatches " << mismatches << std::endl;
+
+    // Bulk operations against a bit-by-bit reference
+    std::mt19937_64 gen(4);
+    myVector<bool> a(1000), b(1000);
+    std::vector<bool> ra(1000), rb(1000);
+    for (size_t i = 0; i < 1000; ++i) {
+        ra[i] = a[i] = gen() % 2;
+        rb[i] = b[i] = gen() % 5 == 0;
+    }
+    myVector<bool> x(a), o(a), n(~a);
+    a &= b;
+    x ^= b;
+    o |= b;
+    mismatches = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+        mismatches += a[i] != (ra[i] && rb[i]) || x[i] != (ra[i] != rb[i]) || o[i] != (ra[i] || rb[i]) || n[i] == ra[i];
+    }
+    size_t visited = 0;
+    for (size_t i = b.find_first(); i != myVector<bool>::npos; i = b.find_next(i)) {
+        ++visited;
+        mismatches += !rb[i];
+    }
+    mismatches += visited != b.count();
+    mismatches += n.count() + std::count(ra.begin(), ra.end(), true) != 1000;
+    std::cout << "bulk ops: set in b " << visited << ", ~a count " << n.count() << ", mismatches " << mismatches << std::endl;
+
+    // resize keeps the bits past size() clear
+    myVector<bool> ones(70, true);
+    ones.resize(65);
+    ones.resize(128);
+    std::cout << "resize: count " << ones.count() << ", sorted copy " << std::is_sorted(ones.begin(), ones.end(), [](bool l, bool r) { return l > r; }) << std::endl;
+}
+
+// Presence bitmaps: 1 byte per flag against 1 bit per flag
+void bench_bit_vector() {
+    typedef std::chrono::steady_clock clock;
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    const size_t ids = 200000000;
+    std::mt19937_64 gen(8);
+
+    Somn::myVector<bool> seen(ids), active(ids);
+    std::vector<unsigned char> seen_bytes(ids), active_bytes(ids);
+    for (size_t i = 0; i < ids / 16; ++i) {
+        size_t id = gen() % ids;
+        seen.set(id);
+        seen_bytes[id] = 1;
+        id = gen() % ids;
+        active.set(id);
+        active_bytes[id] = 1;
+    }
+
+    auto start = clock::now();
+    seen &= active;
+    size_t both = seen.count();
+    size_t visited = 0;
+    for (size_t i = seen.find_first(); i != Somn::myVector<bool>::npos; i = seen.find_next(i)) {
+        ++visited;
+    }
+    auto t1 = clock::now();
+    size_t both_bytes = 0, visited_bytes = 0;
+    for (size_t i = 0; i < ids; ++i) {
+        seen_bytes[i] &= active_bytes[i];
+    }
+    for (size_t i = 0; i < ids; ++i) {
+        both_bytes += seen_bytes[i];
+    }
+    for (size_t i = 0; i < ids; ++i) {
+        if (seen_bytes[i]) {
+            ++visited_bytes;
+        }
+    }
+    auto t2 = clock::now();
+    std::cout << ids << " ids: myVector<bool> (" << ids / 8 / 1000000 << " MB) and+count+scan " << ms(start, t1)
+              << " ms, bytes (" << ids / 1000000 << " MB) " << ms(t1, t2) << " ms (" << both << "/" << both_bytes << ", "
+              << visited << "/" << visited_bytes << ")" << std::endl;
+
+    start = clock::now();
+    size_t total = 0;
+    for (int round = 0; round < 10; ++round) {
+        active.flip();
+        total += active.count();
+    }
+    t1 = clock::now();
+    std::cout << "  10 x (not + count): " << ms(start, t1) << " ms (" << total << ")" << std::endl;
+}
+
+struct Row {
+    unsigned long long id;
+    double value;
+};
+
+void test_mmap_vector() {
+    using namespace Somn;
+    const char* path = "/tmp/somn_mmap_vector_test.bin";
+    {
+        mmap_vector<Row> table(path, mmap_mode::create);
+        for (unsigned long long i = 0; i < 10000; ++i) {
+            table.push_back(Row{i, i * 0.5});
+        }
+        table.insert(table.begin(), Row{99999, -1});
+        table.erase(table.begin() + 1);           // Drops id 0
+        table.pop_back();                         // Drops id 9999
+        table.sync();
+    }
+    {
+        // Reopen and keep appending where the last run stopped
+        mmap_vector<Row> table(path);
+        table.push_back(Row{100000, 1});
+        std::cout << "reopened: size " << table.size() << ", capacity >= size " << (table.capacity() >= table.size())
+                  << ", front " << table[0].id << ", [1] " << table[1].id << ", back " << table[table.size() - 1].id << std::endl;
+    }
+    mmap_vector<Row> view(path, mmap_mode::read_only);
+    double sum = 0;
+    for (const Row& row : view) {
+        sum += row.value;
+    }
+    bool wrong_type = false;
+    try {
+        mmap_vector<int> ints(path, mmap_mode::read_only);
+    }
+    catch (const std::runtime_error&) {
+        wrong_type = true;
+    }
+    bool missing = false;
+    try {
+        mmap_vector<Row> none("/tmp/somn_mmap_vector_missing.bin", mmap_mode::read_only);
+    }
+    catch (const std::system_error&) {
+        missing = true;
+    }
+    // Every mutating call on a read-only vector throws instead of writing to a read-only mapping
+    int refused = 0;
+    auto refuse = [&refused](auto mutate) {
+        try {
+            mutate();
+        }
+        catch (const std::logic_error&) {
+            refused++;
+        }
+    };
+    refuse([&] { view.push_back(Row{1, 1}); });
+    refuse([&] { view.resize(1); });
+    refuse([&] { view.insert(view.begin(), Row{1, 1}); });
+    refuse([&] { view.erase(view.begin()); });
+    refuse([&] { view.pop_back(); });
+    refuse([&] { view.clear(); });
+    std::cout << "read-only: size " << view.size() << ", sum " << sum << ", wrong type throws " << wrong_type
+              << ", missing file throws " << missing << ", mutations refused " << refused << std::endl;
+
+    // A moved-from vector is empty
+    mmap_vector<Row> moved(std::move(view));
+    bool moved_empty = view.size() == 0 && view.empty() && view.begin() == view.end();
+    std::cout << "moved: size " << moved.size() << ", source empty " << moved_empty << std::endl;
+    std::remove(path);
+}
+
+// Startup for a 1 GiB table (64M rows): load it back with fread + push_back, or map it.
+// The sandbox has 5 GB of memory, so the 10 GB case is out of reach for the rebuild
+// path; mapping stays constant in the table size, the rebuild grows linearly.
+void bench_mmap_startup() {
+    using namespace Somn;
+    typedef std::chrono::steady_clock clock;
+    const char* path = "/tmp/somn_mmap_vector_bench.bin";
+    const size_t rows = (size_t(1) << 30) / sizeof(Row);
+    {
+        mmap_vector<Row> table(path, mmap_mode::create);
+        table.resize(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            table[i] = Row{i, 1.0};
+        }
+        table.sync();
+    }
+
+    auto start = clock::now();
+    myVector<Row> loaded;
+    {
+        FILE* file = std::fopen(path, "rb");
+        std::fseek(file, 64, SEEK_SET);
+        Row buffer[4096];
+        size_t got;
+        while ((got = std::fread(buffer, sizeof(Row), 4096, file)) > 0) {
+            for (size_t i = 0; i < got; ++i) {
+                loaded.push_back(buffer[i]);
+            }
+        }
+        std::fclose(file);
+    }
+    double rebuild_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    start = clock::now();
+    mmap_vector<Row> mapped(path, mmap_mode::read_only);
+    double open_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    double sum = 0;
+    for (const Row& row : mapped) {
+        sum += row.value;
+    }
+    double scan_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    std::cout << rows << " rows (1 GiB): fread + push_back " << rebuild_ms << " ms (" << loaded.size() << " rows), mmap open "
+              << open_ms << " ms, mmap open + full scan " << scan_ms << " ms (sum " << sum << ")" << std::endl;
+    std::remove(path);
+}
+
+void test_vector_assign() {
+    using namespace Somn;
+
+    // Trivially copyable elements take the memcpy path, others are assigned one by one
+    int values[] = {5, 6, 7, 8, 9};
+    myVector<int> ints(3, 1);
+    ints.assign(values, 5);
+    myVector<myVector<int>> nested;
+    myVector<int> rows[] = {myVector<int>(2, 4), myVector<int>(3, 9)};
+    nested.assign(rows, 2);
+    myVector<int> none(4, 2);
+    none.assign(values, 0);
+    std::cout << "assign: size " << ints.size() << ", capacity " << ints.capacity() << ", [4] " << ints[4]
+              << ", nested " << nested.size() << "/" << nested[1].size() << "/" << nested[1][2] << ", empty " << none.empty()
+              << std::endl;
+}
+
 int main() {
     test_vector3();
+    test_vector_assign();
+    test_bit_vector();
+    test_mmap_vector();
+    bench_bit_vector();
+    bench_mmap_startup();
     return 0;
 }
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <cstddef>
 #include <cassert>
+#include "../memory/arena.h"
 
 namespace Track {
     template<class T>
@@ -15,13 +16,18 @@ namespace Track {
         typedef size_t size_type; // 定义大小类型
 
         // 默认构造函数，创建一个空的vector
-        vector() : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr) {}
+        vector() : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr), _resource(Somn::default_resource()) {}
+
+        // 创建一个空的vector，元素存储从resource（例如arena）分配
+        explicit vector(Somn::memory_resource* resource)
+            : _start(nullptr), _finish(nullptr), _end_of_storage(nullptr), _resource(resource) {}
 
         // 复制构造函数，从另一个vector复制内容
         vector(const vector<value_type>& v)
             : _start(nullptr),
             _finish(nullptr),
-            _end_of_storage(nullptr) {
+            _end_of_storage(nullptr),
+            _resource(Somn::default_resource()) {
             // 创建一个临时vector，将v的元素复制到临时vector，然后交换指针
             vector<value_type> tmp(v.begin(), v.end());
             swap(tmp);
@@ -32,7 +38,8 @@ namespace Track {
         vector(InputIterator first, InputIterator last)
             : _start(nullptr),
             _finish(nullptr),
-            _end_of_storage(nullptr) {
+            _end_of_storage(nullptr),
+            _resource(Somn::default_resource()) {
             while (first != last) {
                 push_back(*first);
                 ++first;
@@ -43,7 +50,8 @@ namespace Track {
         explicit vector(size_type numItems, const value_type& val = value_type())
             : _start(nullptr),
             _finish(nullptr),
-            _end_of_storage(nullptr) {
+            _end_of_storage(nullptr),
+            _resource(Somn::default_resource()) {
             // 预留足够的空间，然后将val添加到vector中
             reserve(numItems);
 
@@ -55,7 +63,8 @@ namespace Track {
         explicit vector(int numItems, const value_type& val = value_type())
             : _start(nullptr),
             _finish(nullptr),
-            _end_of_storage(nullptr) {
+            _end_of_storage(nullptr),
+            _resource(Somn::default_resource()) {
             // 预留足够的空间，然后将val添加到vector中
             reserve(numItems);
 
@@ -153,7 +162,7 @@ namespace Track {
         void reserve(size_t numItems) {
             if (numItems > capacity()) {
                 // 分配新内存
-                auto* tmp = new T[numItems];
+                auto* tmp = Somn::new_array<T>(_resource, numItems);
                 // 复制旧数据到新内存
                 size_t oldSize = size();
                 if (_start) {
@@ -161,7 +170,7 @@ namespace Track {
                         tmp[index] = _start[index];
 
                     // 释放旧内存
-                    delete[] _start;
+                    Somn::delete_array(_resource, _start, capacity());
                 }
 
                 // 更新指针和容量信息
@@ -200,6 +209,11 @@ namespace Track {
             return _end_of_storage - _start;
         }
 
+        // 返回分配内存所用的资源
+        [[nodiscard]] Somn::memory_resource* resource() const {
+            return _resource;
+        }
+
         // 检查vector是否为空
         [[nodiscard]] bool empty() const {
             return _finish == _start;
@@ -210,6 +224,7 @@ namespace Track {
             std::swap(_start, v._start);
             std::swap(_finish, v._finish);
             std::swap(_end_of_storage, v._end_of_storage);
+            std::swap(_resource, v._resource);
         }
 
         // 清空vector，将其大小设置为0
@@ -231,17 +246,20 @@ namespace Track {
 
         // 赋值运算符，复制另一个vector的内容
         vector<value_type>& operator=(const vector<value_type>& v) {
-            // 检查是否自我赋值
-            if (v._start == _start) {
-                vector<value_type> tmp(v);
-                swap(v);
+            // 检查是否自我赋值；元素拷贝到本对象资源分配的空间中，使用arena的vector赋值后仍在arena上
+            if (this != &v) {
+                clear();
+                reserve(v.size());
+                for (size_t index = 0; index < v.size(); index++) {
+                    push_back(v[index]);
+                }
             }
             return *this;
         }
 
         // 析构函数，释放vector占用的内存
         ~vector() {
-            delete[] _start;
+            Somn::delete_array(_resource, _start, capacity());
             _start = _finish = _end_of_storage = nullptr;
         }
 
@@ -249,6 +267,7 @@ namespace Track {
         iterator _start; // 指向vector首元素的指针
         iterator _finish; // 指向vector尾元素的下一个位置的指针
         iterator _end_of_storage; // 指向vector内存末尾的下一个位置的指针
+        Somn::memory_resource* _resource; // 分配内存所用的资源
     };
 }
 
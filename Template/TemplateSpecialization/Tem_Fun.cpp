@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <random>
+#include "../../STL/vector/myVector.h"
 
 // Date class representing a date with year, month, and day.
 class Date
@@ -11,22 +17,41 @@ public:
         , _day(day)
     {}
 
-    // Less than operator for comparing two Date objects.
+    // Packed 32-bit key that sorts like the date: biased year in bits 9-24, month in 5-8, day in 0-4.
+    // Valid for years -32768..32767, months 1..12 and days 1..31; Date itself does not check,
+    // so only radix_sort and PackedDate use the key and the comparisons stay on the fields.
+    uint32_t key() const
+    {
+        assert(_year >= -32768 && _year <= 32767);
+        assert(_month >= 1 && _month <= 12);
+        assert(_day >= 1 && _day <= 31);
+        return (static_cast<uint32_t>(_year + 32768) << 9) | (static_cast<uint32_t>(_month) << 5) | static_cast<uint32_t>(_day);
+    }
+
+    // Rebuild a Date from its packed key.
+    static Date from_key(uint32_t key)
+    {
+        return Date(static_cast<int>(key >> 9) - 32768, (key >> 5) & 0xF, key & 0x1F);
+    }
+
+    int year() const { return _year; }
+    int month() const { return _month; }
+    int day() const { return _day; }
+
+    // Less than operator for comparing two Date objects: year, then month, then day.
     bool operator<(const Date& d) const
     {
-        // Compare year first, then month, and finally day.
-        return (_year < d._year) ||
-            (_year == d._year && _month < d._month) ||
-            (_year == d._year && _month == d._month && _day < d._day);
+        if (_year != d._year)
+            return _year < d._year;
+        if (_month != d._month)
+            return _month < d._month;
+        return _day < d._day;
     }
 
     // Greater than operator for comparing two Date objects.
     bool operator>(const Date& d) const
     {
-        // Compare year first, then month, and finally day.
-        return (_year > d._year) ||
-            (_year == d._year && _month > d._month) ||
-            (_year == d._year && _month == d._month && _day > d._day);
+        return d < *this;
     }
 
     // Friend function for printing Date objects in the format "year-month-day".
@@ -42,6 +67,31 @@ private:
     int _day;
 };
 
+// A date stored only as its packed key: 4 bytes, and comparison is a single integer compare.
+class PackedDate
+{
+public:
+    PackedDate(const Date& d = Date())
+        : _key(d.key())
+    {}
+
+    Date date() const { return Date::from_key(_key); }
+
+    uint32_t key() const { return _key; }
+
+    bool operator<(const PackedDate& d) const { return _key < d._key; }
+
+    bool operator>(const PackedDate& d) const { return _key > d._key; }
+
+    friend std::ostream& operator<<(std::ostream& _cout, const PackedDate& d)
+    {
+        return _cout << d.date();
+    }
+
+private:
+    uint32_t _key;
+};
+
 // Template function to compare two objects of any type using the less than operator.
 template<typename T>
 bool less(T left, T right) {
@@ -56,6 +106,71 @@ bool less<Date*>(Date* left, Date* right)
     return *left < *right;
 }
 
+// Specialization for PackedDate: the key is already packed.
+template<>
+bool less<PackedDate>(PackedDate left, PackedDate right)
+{
+    return left.key() < right.key();
+}
+
+// Key of each element type for radix_sort.
+inline uint32_t sort_key(const Date& d) { return d.key(); }
+inline uint32_t sort_key(const Date* d) { return d->key(); }
+inline uint32_t sort_key(const PackedDate& d) { return d.key(); }
+
+// Stable LSD radix sort of Dates, Date pointers or PackedDates by their packed keys.
+// Each key is computed once, pointers are dereferenced once, and three passes of 11 bits
+// cover the key; a pass is skipped when all keys share that digit (e.g. the upper year bits).
+template<typename T>
+void radix_sort(Somn::myVector<T>& v)
+{
+    struct Item
+    {
+        uint32_t key;
+        T value;
+    };
+    const size_t n = v.size();
+    if (n < 2)
+        return;
+
+    Somn::myVector<Item> items(n), buffer(n);
+    size_t counts[3][2048] = {};
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t key = sort_key(v[i]);
+        items[i].key = key;
+        items[i].value = v[i];
+        ++counts[0][key & 2047];
+        ++counts[1][(key >> 11) & 2047];
+        ++counts[2][key >> 22];
+    }
+
+    Item* from = &items[0];
+    Item* to = &buffer[0];
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        unsigned shift = pass * 11;
+        size_t* count = counts[pass];
+        if (count[(from[0].key >> shift) & 2047] == n)
+            continue;
+
+        // Turn the counts into starting offsets, then scatter
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 2048; ++digit)
+        {
+            size_t c = count[digit];
+            count[digit] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i)
+            to[count[(from[i].key >> shift) & 2047]++] = from[i];
+        std::swap(from, to);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        v[i] = from[i].value;
+}
+
 // Also true
 //bool less(Date* left, Date* right)
 //{
@@ -63,20 +178,80 @@ bool less<Date*>(Date* left, Date* right)
 //}
 
 
-//int main()
-//{
-//    // Compare two integers.
-//    std::cout << less(1, 2) << std::endl;   // Can compare, result is correct
-//
-//    // Create two Date objects and compare them.
-//    Date d1(2022, 7, 7);
-//    Date d2(2022, 7, 8);
-//    std::cout << less(d1, d2) << std::endl;  // Can compare, result is correct
-//
-//    // Create Date pointers and attempt to compare them (requires template specialization).
-//    Date* p1 = &d1;
-//    Date* p2 = &d2;
-//    std::cout << less(p1, p2) << std::endl;  // Can compare, result is incorrect (requires template specialization)
-//
-//    return 0;
-//}
+// The same comparison written over the accessors: year, then month, then day.
+bool less_by_fields(const Date* left, const Date* right)
+{
+    return (left->year() < right->year()) ||
+        (left->year() == right->year() && left->month() < right->month()) ||
+        (left->year() == right->year() && left->month() == right->month() && left->day() < right->day());
+}
+
+// Sort random dated records with each method and check they agree.
+void bench_date_sort()
+{
+    typedef std::chrono::steady_clock clock;
+    auto ms = [](clock::time_point from, clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    const size_t n = 10000000;
+    std::mt19937 gen(12);
+    Somn::myVector<Date> dates(n);
+    for (size_t i = 0; i < n; ++i)
+        dates[i] = Date(1970 + gen() % 60, 1 + gen() % 12, 1 + gen() % 28);
+
+    Somn::myVector<Date*> pointers(n);
+    for (size_t i = 0; i < n; ++i)
+        pointers[i] = &dates[i];
+    Somn::myVector<Date*> by_fields(pointers), by_key(pointers), by_radix(pointers);
+    Somn::myVector<Date> values(dates);
+    Somn::myVector<PackedDate> packed(n);
+    for (size_t i = 0; i < n; ++i)
+        packed[i] = PackedDate(dates[i]);
+
+    auto t0 = clock::now();
+    std::sort(by_fields.begin(), by_fields.end(), less_by_fields);
+    auto t1 = clock::now();
+    std::sort(by_key.begin(), by_key.end(), less<Date*>);
+    auto t2 = clock::now();
+    radix_sort(by_radix);
+    auto t3 = clock::now();
+    radix_sort(values);
+    auto t4 = clock::now();
+    std::sort(packed.begin(), packed.end());
+    auto t5 = clock::now();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t key = by_fields[i]->key();
+        mismatches += by_key[i]->key() != key || by_radix[i]->key() != key || values[i].key() != key || packed[i].key() != key;
+    }
+    std::cout << n << " dates, std::sort(Date*) by fields " << ms(t0, t1) << " ms, by less<Date*> " << ms(t1, t2)
+        << " ms, radix_sort(Date*) " << ms(t2, t3) << " ms, radix_sort(Date) " << ms(t3, t4)
+        << " ms, std::sort(PackedDate) " << ms(t4, t5) << " ms, mismatches " << mismatches << std::endl;
+}
+
+int main()
+{
+    // Compare two integers.
+    std::cout << less(1, 2) << std::endl;   // Can compare, result is correct
+
+    // Create two Date objects and compare them.
+    Date d1(2022, 7, 7);
+    Date d2(2022, 7, 8);
+    std::cout << less(d1, d2) << std::endl;  // Can compare, result is correct
+
+    // Create Date pointers and attempt to compare them (requires template specialization).
+    Date* p1 = &d1;
+    Date* p2 = &d2;
+    std::cout << less(p1, p2) << std::endl;  // Can compare, result is correct thanks to the specialization
+
+    // The packed key round-trips and keeps the order
+    std::cout << Date::from_key(d1.key()) << " " << PackedDate(d2) << " " << less(PackedDate(d2), PackedDate(d1)) << std::endl;
+
+    // Out-of-range fields still compare field by field; they have no packed key
+    std::cout << less(Date(2022, 1, 40), Date(2022, 2, 1)) << std::endl;
+
+    bench_date_sort();
+    return 0;
+}